@@ -41,15 +41,93 @@
 
 #include <QAbstractEventDispatcher>
 #include <QCoreApplication>
+#include <QLoggingCategory>
 #include <QTimerEvent>
+#include <QtGui/qpa/qwindowsysteminterface.h>
 
-QWebEngineMessagePumpScheduler::QWebEngineMessagePumpScheduler(std::function<void()> callback)
-    : m_callback(std::move(callback))
+#if defined(Q_OS_WIN)
+#include <QtCore/qt_windows.h>
+#endif
+
+#include <new>
+#include <type_traits>
+
+Q_LOGGING_CATEGORY(lcMessagePump, "qt.webengine.messagepump")
+
+namespace {
+
+// The event posted in Coalesced mode. Only one is pending per scheduler at a
+// time, and it is deleted right after delivery, so a couple of static slots
+// cover the common case of a single scheduler without touching the heap.
+class WakeUpEvent : public QEvent
+{
+public:
+    WakeUpEvent() : QEvent(type()) { }
+
+    static QEvent::Type type()
+    {
+        static const QEvent::Type eventType = QEvent::Type(QEvent::registerEventType());
+        return eventType;
+    }
+
+    static void *operator new(std::size_t size)
+    {
+        Q_ASSERT(size <= sizeof(Slot));
+        for (int i = 0; i < SlotCount; ++i) {
+            if (s_slotUsed[i].testAndSetAcquire(0, 1))
+                return &s_slots[i];
+        }
+        return ::operator new(size);
+    }
+
+    static void operator delete(void *ptr)
+    {
+        for (int i = 0; i < SlotCount; ++i) {
+            if (ptr == &s_slots[i]) {
+                s_slotUsed[i].storeRelease(0);
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    // The next wake-up can be posted while the previous event is still being
+    // delivered.
+    static constexpr int SlotCount = 2;
+    using Slot = std::aligned_storage_t<sizeof(QEvent), alignof(QEvent)>;
+    static Slot s_slots[SlotCount];
+    static QAtomicInt s_slotUsed[SlotCount];
+};
+
+WakeUpEvent::Slot WakeUpEvent::s_slots[WakeUpEvent::SlotCount];
+QAtomicInt WakeUpEvent::s_slotUsed[WakeUpEvent::SlotCount];
+
+} // namespace
+
+QWebEngineMessagePumpScheduler::QWebEngineMessagePumpScheduler(std::function<void()> callback, Mode mode)
+    : m_mode(mode), m_callback(std::move(callback))
 {}
 
+QWebEngineMessagePumpScheduler::~QWebEngineMessagePumpScheduler()
+{
+    if (m_workRequests.loadRelaxed()) {
+        qCDebug(lcMessagePump).nospace()
+                << "ran " << m_wakeUps.loadRelaxed() << " wake-ups for "
+                << m_workRequests.loadRelaxed() << " work requests";
+    }
+}
+
 void QWebEngineMessagePumpScheduler::scheduleWork()
 {
-    QCoreApplication::postEvent(this, new QTimerEvent(0));
+    m_workRequests.fetchAndAddRelaxed(1);
+    if (m_mode == Mode::EventPerWakeUp) {
+        QCoreApplication::postEvent(this, new QTimerEvent(0));
+        return;
+    }
+    // Work scheduled before the pending wake-up is delivered will be done by it.
+    if (m_wakeUpPending.testAndSetAcquire(0, 1))
+        QCoreApplication::postEvent(this, new WakeUpEvent);
 }
 
 void QWebEngineMessagePumpScheduler::scheduleDelayedWork(int delay)
@@ -63,10 +141,66 @@ void QWebEngineMessagePumpScheduler::scheduleDelayedWork(int delay)
     }
 }
 
+QWebEngineMessagePumpScheduler::Statistics QWebEngineMessagePumpScheduler::statistics() const
+{
+    Statistics statistics;
+    statistics.workRequests = m_workRequests.loadRelaxed();
+    statistics.wakeUps = m_wakeUps.loadRelaxed();
+    return statistics;
+}
+
+bool QWebEngineMessagePumpScheduler::event(QEvent *ev)
+{
+    if (ev->type() == WakeUpEvent::type()) {
+        // Cleared first, so that work scheduled by the callback gets a new wake-up.
+        m_wakeUpPending.storeRelease(0);
+        handleWork();
+        return true;
+    }
+    return QObject::event(ev);
+}
+
 void QWebEngineMessagePumpScheduler::timerEvent(QTimerEvent *ev)
 {
     Q_ASSERT(!ev->timerId() || m_timerId == ev->timerId());
-    killTimer(m_timerId);
-    m_timerId = 0;
+    handleWork();
+}
+
+QWebEngineMessagePumpScheduler::SliceEnd
+QWebEngineMessagePumpScheduler::runWorkSlice(const std::function<bool()> &doWork, QDeadlineTimer deadline,
+                                             const std::function<bool()> &inputPending)
+{
+    for (;;) {
+        if (!doWork())
+            return SliceEnd::NoImmediateWork;
+        if (inputPending())
+            return SliceEnd::InputPending;
+        if (deadline.hasExpired())
+            return SliceEnd::BudgetExhausted;
+    }
+}
+
+// Platform plugins that read native events on another thread, such as
+// Wayland, queue them as window system events right away. Others, such as
+// xcb, only turn them into window system events while the Qt event loop
+// runs, so there only the time budget ends a slice. On Windows, the input
+// waiting in the thread's message queue is checked as well.
+bool QWebEngineMessagePumpScheduler::hasPendingInput()
+{
+#if defined(Q_OS_WIN)
+    // The high word lists the kinds of messages currently in the queue.
+    if (HIWORD(::GetQueueStatus(QS_INPUT)))
+        return true;
+#endif
+    return QWindowSystemInterface::windowSystemEventsQueued() > 0;
+}
+
+void QWebEngineMessagePumpScheduler::handleWork()
+{
+    if (m_timerId) {
+        killTimer(m_timerId);
+        m_timerId = 0;
+    }
+    m_wakeUps.fetchAndAddRelaxed(1);
     m_callback();
 }
@@ -53,6 +53,8 @@
 
 #include "qtwebenginecoreglobal_p.h"
 
+#include <QtCore/qatomic.h>
+#include <QtCore/qdeadlinetimer.h>
 #include <QtCore/qobject.h>
 
 #include <functional>
@@ -63,15 +65,54 @@ class Q_WEBENGINECORE_PRIVATE_EXPORT QWebEngineMessagePumpScheduler : public QOb
 {
     Q_OBJECT
 public:
-    QWebEngineMessagePumpScheduler(std::function<void()> callback);
+    enum class Mode {
+        // Posts an event for every call to scheduleWork().
+        EventPerWakeUp,
+        // Keeps at most one wake-up event pending, and recycles its storage.
+        Coalesced
+    };
+
+    // Why runWorkSlice() returned.
+    enum class SliceEnd {
+        NoImmediateWork,
+        BudgetExhausted,
+        InputPending
+    };
+
+    struct Statistics {
+        quint64 workRequests = 0; // calls to scheduleWork()
+        quint64 wakeUps = 0; // callbacks run, including for delayed work
+    };
+
+    QWebEngineMessagePumpScheduler(std::function<void()> callback, Mode mode = Mode::Coalesced);
+    ~QWebEngineMessagePumpScheduler();
+
+    // May be called from any thread.
     void scheduleWork();
     void scheduleDelayedWork(int delay);
 
+    Mode mode() const { return m_mode; }
+    Statistics statistics() const;
+
+    // Calls doWork, which returns whether more work is due right away, until
+    // there is none, the deadline has passed, or inputPending returns true.
+    // doWork is always called at least once.
+    static SliceEnd runWorkSlice(const std::function<bool()> &doWork, QDeadlineTimer deadline,
+                                 const std::function<bool()> &inputPending = hasPendingInput);
+    static bool hasPendingInput();
+
 protected:
+    bool event(QEvent *ev) override;
     void timerEvent(QTimerEvent *ev) override;
 
 private:
+    void handleWork();
+
+    const Mode m_mode;
     int m_timerId = 0;
+    QAtomicInt m_wakeUpPending;
+    QAtomicInteger<quint64> m_workRequests;
+    QAtomicInteger<quint64> m_wakeUps;
     std::function<void()> m_callback;
 };
 
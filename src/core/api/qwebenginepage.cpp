@@ -72,6 +72,7 @@
 #include <QGuiApplication>
 #include <QAuthenticator>
 #include <QClipboard>
+#include <QIODevice>
 #include <QKeyEvent>
 #include <QIcon>
 #include <QLoggingCategory>
@@ -128,6 +129,70 @@ private:
     QSize m_size;
 };
 
+#if QT_CONFIG(webengine_printing_and_pdf)
+// Writes a PDF print result to a device a chunk at a time from the event loop,
+// straight from the memory the renderer shared it in. Sequential devices get
+// the next chunk once they have written out most of the previous one, so they
+// never buffer a copy of the whole document.
+class PdfDeviceWriter : public QObject
+{
+public:
+    PdfDeviceWriter(QSharedPointer<QByteArray> data, QIODevice *device, std::function<void(bool)> callback)
+        : QObject(device), m_data(std::move(data)), m_device(device), m_callback(std::move(callback))
+    {
+        if (m_device->isSequential())
+            connect(m_device, &QIODevice::bytesWritten, this, &PdfDeviceWriter::writeNext);
+        QTimer::singleShot(0, this, &PdfDeviceWriter::writeNext);
+    }
+
+    // Also when the device is destroyed before all was written.
+    ~PdfDeviceWriter() { finish(false); }
+
+private:
+    static constexpr qint64 ChunkSize = 1024 * 1024;
+
+    void writeNext()
+    {
+        if (!m_callback)
+            return;
+        while (m_offset < m_data->size()) {
+            if (m_device->bytesToWrite() >= ChunkSize)
+                return; // continued on bytesWritten
+            const qint64 written = m_device->write(m_data->constData() + m_offset,
+                                                   qMin(ChunkSize, m_data->size() - m_offset));
+            // A sequential device that takes nothing while it is still writing
+            // out earlier data takes more once it has written some of it. Any
+            // other device that takes nothing has stopped making progress.
+            if (written == 0 && m_device->isSequential() && m_device->bytesToWrite() > 0)
+                return; // continued on bytesWritten
+            if (written <= 0) {
+                finish(false);
+                deleteLater();
+                return;
+            }
+            m_offset += written;
+            if (!m_device->isSequential() && m_offset < m_data->size()) {
+                QTimer::singleShot(0, this, &PdfDeviceWriter::writeNext);
+                return;
+            }
+        }
+        finish(true);
+        deleteLater();
+    }
+
+    void finish(bool success)
+    {
+        if (auto callback = std::exchange(m_callback, nullptr))
+            callback(success);
+    }
+
+    QSharedPointer<QByteArray> m_data;
+    QIODevice *m_device;
+    std::function<void(bool)> m_callback;
+    qint64 m_offset = 0;
+};
+#endif // QT_CONFIG(webengine_printing_and_pdf)
+
 static QWebEnginePage::WebWindowType toWindowType(WebContentsAdapterClient::WindowOpenDisposition disposition)
 {
     switch (disposition) {
@@ -460,10 +525,19 @@ void QWebEnginePagePrivate::didPrintPage(quint64 requestId, QSharedPointer<QByte
 
     // If no currentPrinter is set that means that were printing to PDF only.
     if (!currentPrinter) {
+        const PdfDeviceRequest deviceRequest = m_pdfDeviceRequests.take(requestId);
+        if (deviceRequest.callback) {
+            if (!deviceRequest.device || !result || result->isEmpty())
+                deviceRequest.callback(false);
+            else
+                new PdfDeviceWriter(result, deviceRequest.device, deviceRequest.callback);
+            return;
+        }
         if (!result.data())
             return;
+        // The result maps shared memory that goes away with it.
         if (auto callback = m_pdfResultCallbacks.take(requestId))
-            callback(*(result.data()));
+            callback(QByteArray(result->constData(), result->size()));
         return;
     }
 
@@ -892,8 +966,11 @@ QWebEnginePage::~QWebEnginePage()
             varFun(QVariant());
         for (auto strFun : qAsConst(d_ptr->m_stringCallbacks))
             strFun(QString());
+        for (const auto &deviceRequest : qAsConst(d_ptr->m_pdfDeviceRequests))
+            deviceRequest.callback(false);
         d_ptr->m_variantCallbacks.clear();
         d_ptr->m_stringCallbacks.clear();
+        d_ptr->m_pdfDeviceRequests.clear();
     }
 }
 
@@ -2310,6 +2387,80 @@ void QWebEnginePage::printToPdf(const std::function<void(const QByteArray&)> &re
 #endif
 }
 
+/*!
+    \since 6.3
+
+    Renders the current content of the page into a PDF document and writes it
+    to \a device, which must be open for writing.
+    The page size and orientation of the produced PDF document are taken from the values specified in \a layout,
+    while the range of pages printed is taken from \a ranges with the default being printing all pages.
+
+    Unlike the overload that returns a QByteArray, this one does not copy the
+    document: it is written to \a device straight from the memory that the
+    renderer process produced it in, a chunk at a time from the event loop.
+    Sequential devices, such as sockets, get the next chunk once they have
+    written out most of the previous one. This keeps the memory used for
+    large documents down.
+
+    Once the whole document has been written, or writing failed, \a resultCallback
+    is called with \c true or \c false respectively. It is also called with \c false
+    if \a device is destroyed before that.
+
+    \warning We guarantee that the callback (\a resultCallback) is always called, but it might be done
+    during page destruction. When QWebEnginePage is deleted, the callback is triggered with \c false
+    and it is not safe to use the corresponding QWebEnginePage or QWebEngineView instance inside it.
+
+    \sa QIODevice::isSequential()
+*/
+void QWebEnginePage::printToPdf(QIODevice *device, const std::function<void(bool)> &resultCallback,
+                                const QPageLayout &layout, const QPageRanges &ranges)
+{
+    if (!resultCallback)
+        return;
+#if QT_CONFIG(webengine_printing_and_pdf)
+    Q_D(QWebEnginePage);
+    if (!device || !device->isWritable()) {
+        qWarning("Cannot print to PDF: the device is not open for writing.");
+        resultCallback(false);
+        return;
+    }
+    d->ensureInitialized();
+    quint64 requestId = d->adapter->printToPDFCallbackResult(layout, ranges);
+    d->m_pdfDeviceRequests.insert(requestId, { device, resultCallback });
+#else
+    Q_UNUSED(device);
+    Q_UNUSED(layout);
+    Q_UNUSED(ranges);
+    resultCallback(false);
+#endif
+}
+
+/*!
+    \since 6.3
+
+    Draws one frame of the page and calls \a resultCallback with it.
+
+    This only works with the headless compositor, which is selected by setting
+    the \c QTWEBENGINE_HEADLESS_COMPOSITOR environment variable. Pages are then
+    drawn only when this function is called, and the frame is also shown in
+    the page's view, if it has one. In any other case, or while the page has
+    not been shown and sized by a view yet, \a resultCallback receives a null
+    image.
+
+    The image shares its memory with the compositor, which does not draw into
+    it again while the image or a copy of it is kept.
+
+    \note If the page is deleted before the frame has been drawn,
+    \a resultCallback might not be called.
+*/
+void QWebEnginePage::produceFrame(const std::function<void(const QImage &)> &resultCallback)
+{
+    if (!resultCallback)
+        return;
+    Q_D(QWebEnginePage);
+    d->adapter->produceFrame(resultCallback);
+}
+
 /*!
     \internal
 */
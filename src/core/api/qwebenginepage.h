@@ -58,6 +58,8 @@ QT_BEGIN_NAMESPACE
 
 class QAuthenticator;
 class QContextMenuBuilder;
+class QImage;
+class QIODevice;
 class QWebChannel;
 class QWebEngineCertificateError;
 class QWebEngineClientCertificateSelection;
@@ -310,6 +312,11 @@ public:
     void printToPdf(const std::function<void(const QByteArray&)> &resultCallback,
                     const QPageLayout &layout = QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()),
                     const QPageRanges &ranges = {});
+    void printToPdf(QIODevice *device, const std::function<void(bool)> &resultCallback,
+                    const QPageLayout &layout = QPageLayout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF()),
+                    const QPageRanges &ranges = {});
+
+    void produceFrame(const std::function<void(const QImage &)> &resultCallback);
 
     void setInspectedPage(QWebEnginePage *page);
     QWebEnginePage *inspectedPage() const;
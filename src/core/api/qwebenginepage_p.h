@@ -232,6 +232,11 @@ public:
     mutable QMap<quint64, std::function<void(const QVariant &)>> m_variantCallbacks;
     mutable QMap<quint64, std::function<void(const QString &)>> m_stringCallbacks;
     QMap<quint64, std::function<void(const QByteArray &)>> m_pdfResultCallbacks;
+    struct PdfDeviceRequest {
+        QPointer<QIODevice> device;
+        std::function<void(bool)> callback;
+    };
+    QMap<quint64, PdfDeviceRequest> m_pdfDeviceRequests;
     mutable QAction *actions[QWebEnginePage::WebActionCount];
 };
 
@@ -46,6 +46,7 @@
 #include "qwebenginesettings.h"
 #include "qwebenginescriptcollection.h"
 #include "qwebenginescriptcollection_p.h"
+#include "qwebengineurlrequestrule.h"
 #include "qtwebenginecoreglobal.h"
 #include "profile_adapter.h"
 #include "visited_links_manager_qt.h"
@@ -178,6 +179,7 @@ QWebEngineProfilePrivate::~QWebEngineProfilePrivate()
         // In the case the user sets this profile as the parent of the interceptor
         // it can be deleted before the browser-context still referencing it is.
         m_profileAdapter->setRequestInterceptor(nullptr);
+        m_profileAdapter->setBackgroundRequestInterceptor(nullptr);
         m_profileAdapter->removeClient(this);
     }
 
@@ -596,6 +598,62 @@ void QWebEngineProfile::setUrlRequestInterceptor(QWebEngineUrlRequestInterceptor
     d->profileAdapter()->setRequestInterceptor(interceptor);
 }
 
+/*!
+    Registers a request interceptor singleton \a interceptor that intercepts URL
+    requests outside of the main thread.
+
+    QWebEngineUrlRequestInterceptor::interceptRequest() is called on a
+    dedicated background thread, one request at a time, before the
+    interceptors set with setUrlRequestInterceptor() and
+    QWebEnginePage::setUrlRequestInterceptor() are run. Those only see
+    requests that \a interceptor left unchanged. This keeps filtering and
+    header rewriting from delaying input handling and painting, but the
+    interceptor must not access the page, the profile, or other objects that
+    live in the main thread.
+
+    The profile does not take ownership of the pointer. Unset the interceptor
+    before deleting it. Unsetting or replacing it waits for a running
+    interceptRequest() call to return.
+
+    \since 6.3
+    \sa setUrlRequestInterceptor(), QWebEngineUrlRequestInterceptor
+*/
+void QWebEngineProfile::setBackgroundUrlRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor)
+{
+    Q_D(QWebEngineProfile);
+    d->profileAdapter()->setBackgroundRequestInterceptor(interceptor);
+}
+
+/*!
+    Sets the rules that URL requests of this profile are matched against to
+    \a rules.
+
+    The rules are compiled into an index when they are set, and are applied
+    to every request before any request interceptor sees it. Requests that a
+    rule blocks or redirects are not passed to the interceptors. Setting an
+    empty list removes all rules.
+
+    \since 6.3
+    \sa urlRequestRules(), QWebEngineUrlRequestRule, setUrlRequestInterceptor()
+*/
+void QWebEngineProfile::setUrlRequestRules(const QList<QWebEngineUrlRequestRule> &rules)
+{
+    Q_D(QWebEngineProfile);
+    d->profileAdapter()->setUrlRequestRules(rules);
+}
+
+/*!
+    Returns the rules that URL requests of this profile are matched against.
+
+    \since 6.3
+    \sa setUrlRequestRules()
+*/
+QList<QWebEngineUrlRequestRule> QWebEngineProfile::urlRequestRules() const
+{
+    const Q_D(QWebEngineProfile);
+    return d->profileAdapter()->urlRequestRules();
+}
+
 /*!
     Clears all links from the visited links database.
 
@@ -42,6 +42,7 @@
 
 #include <QtWebEngineCore/qtwebenginecoreglobal.h>
 
+#include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
 #include <QtCore/qstring.h>
@@ -60,6 +61,7 @@ class QWebEngineProfilePrivate;
 class QWebEngineSettings;
 class QWebEngineScriptCollection;
 class QWebEngineUrlRequestInterceptor;
+class QWebEngineUrlRequestRule;
 class QWebEngineUrlSchemeHandler;
 
 class Q_WEBENGINECORE_EXPORT QWebEngineProfile : public QObject
@@ -110,6 +112,9 @@ public:
 
     QWebEngineCookieStore *cookieStore();
     void setUrlRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+    void setBackgroundUrlRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+    void setUrlRequestRules(const QList<QWebEngineUrlRequestRule> &rules);
+    QList<QWebEngineUrlRequestRule> urlRequestRules() const;
 
     void clearAllVisitedLinks();
     void clearVisitedLinks(const QList<QUrl> &urls);
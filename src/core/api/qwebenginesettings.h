@@ -95,6 +95,7 @@ public:
         JavascriptCanPaste,
         DnsPrefetchEnabled,
         PdfViewerEnabled,
+        BinaryWebChannelTransportEnabled,
     };
 
     enum FontSize {
@@ -78,7 +78,9 @@ ASSERT_ENUMS_MATCH(QtWebEngineCore::WebContentsAdapterClient::RedirectNavigation
     before they reach the networking stack of Chromium.
 
     You can install the interceptor on a profile via QWebEngineProfile::setUrlRequestInterceptor()
-    or QQuickWebEngineProfile::setUrlRequestInterceptor().
+    or QQuickWebEngineProfile::setUrlRequestInterceptor(). Interceptors that do not need the
+    main thread can be installed with QWebEngineProfile::setBackgroundUrlRequestInterceptor()
+    instead, so that they run on a background thread.
 
     When using the \l{Qt WebEngine Widgets Module}, \l{QWebEnginePage::acceptNavigationRequest()}
     offers further options to accept or block requests.
@@ -164,12 +164,32 @@ QMap<QByteArray, QByteArray> QWebEngineUrlRequestJob::requestHeaders() const
     \code
     connect(job, &QObject::destroyed, device, &QObject::deleteLater);
     \endcode
+
+    If \a device is a QFile, including files in the Qt resource system, the
+    file is memory-mapped if possible, and written to the renderer straight
+    from the mapping on a background thread. \a device itself is then not
+    read from, and is closed right away.
  */
 void QWebEngineUrlRequestJob::reply(const QByteArray &contentType, QIODevice *device)
 {
     d_ptr->reply(contentType, device);
 }
 
+/*!
+    \since 6.3
+    Replies to the request with \a data and the MIME type \a contentType.
+
+    Unlike replying with a QIODevice, the data is handed over once and then
+    written to the renderer on a background thread, without any further
+    round trips to the thread of the scheme handler. This is the preferred
+    way of replying with content that is already in memory, in particular
+    with large content.
+ */
+void QWebEngineUrlRequestJob::reply(const QByteArray &contentType, const QByteArray &data)
+{
+    d_ptr->reply(contentType, data);
+}
+
 /*!
     Fails the request with the error \a r.
 
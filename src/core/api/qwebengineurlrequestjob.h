@@ -77,6 +77,7 @@ public:
     QMap<QByteArray, QByteArray> requestHeaders() const;
 
     void reply(const QByteArray &contentType, QIODevice *device);
+    void reply(const QByteArray &contentType, const QByteArray &data);
     void fail(Error error);
     void redirect(const QUrl &url);
 
@@ -0,0 +1,581 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qwebengineurlrequestrule.h"
+#include "qwebengineurlrequestrule_p.h"
+
+#include <QUrl>
+#include <QVarLengthArray>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWebEngineUrlRequestRule
+    \since 6.3
+    \inmodule QtWebEngineCore
+
+    \brief The QWebEngineUrlRequestRule class describes how to treat URL requests matching a pattern.
+
+    A list of rules set with QWebEngineProfile::setUrlRequestRules() is compiled
+    into an index once, and every URL request of the profile is then matched
+    against it before it reaches any QWebEngineUrlRequestInterceptor. Unlike an
+    interceptor, this does not call into application code for each request,
+    which keeps large block lists cheap.
+
+    The pattern uses the filter syntax common to content blockers, and is
+    matched case-insensitively against the whole URL:
+
+    \list
+        \li \c * matches any sequence of characters.
+        \li \c ^ matches a separator, which is any character other than a letter,
+            a digit, or one of \c {_-.%}, or the end of the URL.
+        \li \c || at the start anchors the pattern to the beginning of the host
+            name or of one of its subdomains, for example \c {||example.com^}.
+        \li \c | at the start or end anchors the pattern to the beginning or end
+            of the URL.
+    \endlist
+
+    The URL is matched in its encoded form. Internationalized host names in
+    patterns and first-party domains are converted to punycode, and other
+    non-ASCII characters match their percent-encoded UTF-8 form.
+
+    Patterns containing a run of letters and digits that is not next to a
+    \c * are indexed by that run. Other patterns are tested against every
+    request.
+
+    If several rules of the Block or Redirect actions match a request, the
+    first one in the list applies. All matching SetHttpHeader rules apply.
+    Interceptors are not called for blocked or redirected requests.
+
+    \sa QWebEngineProfile::setUrlRequestRules()
+*/
+
+/*!
+    \enum QWebEngineUrlRequestRule::Action
+
+    This enum describes what happens to a request matching the rule:
+
+    \value Block The request is blocked.
+    \value Redirect The request is redirected to redirectUrl().
+    \value SetHttpHeader The HTTP header set with setHttpHeader() is added to the request.
+*/
+
+class QWebEngineUrlRequestRulePrivate : public QSharedData
+{
+public:
+    QString pattern;
+    QWebEngineUrlRequestRule::Action action = QWebEngineUrlRequestRule::Block;
+    QUrl redirectUrl;
+    QByteArray headerName;
+    QByteArray headerValue;
+    QList<QWebEngineUrlRequestInfo::ResourceType> resourceTypes;
+    QStringList firstPartyDomains;
+
+    bool operator==(const QWebEngineUrlRequestRulePrivate &other) const
+    {
+        return pattern == other.pattern && action == other.action
+                && redirectUrl == other.redirectUrl && headerName == other.headerName
+                && headerValue == other.headerValue && resourceTypes == other.resourceTypes
+                && firstPartyDomains == other.firstPartyDomains;
+    }
+};
+
+/*!
+    Constructs a rule applying \a action to the requests matching \a pattern.
+*/
+QWebEngineUrlRequestRule::QWebEngineUrlRequestRule(const QString &pattern, Action action)
+    : d(new QWebEngineUrlRequestRulePrivate)
+{
+    d->pattern = pattern;
+    d->action = action;
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QWebEngineUrlRequestRule::QWebEngineUrlRequestRule(const QWebEngineUrlRequestRule &other) = default;
+
+/*!
+    Destroys the rule.
+*/
+QWebEngineUrlRequestRule::~QWebEngineUrlRequestRule() = default;
+
+/*!
+    Assigns \a other to this rule.
+*/
+QWebEngineUrlRequestRule &QWebEngineUrlRequestRule::operator=(const QWebEngineUrlRequestRule &other) = default;
+
+/*!
+    \fn QWebEngineUrlRequestRule &QWebEngineUrlRequestRule::operator=(QWebEngineUrlRequestRule &&other)
+
+    Move-assigns \a other to this rule.
+*/
+
+/*!
+    \fn void QWebEngineUrlRequestRule::swap(QWebEngineUrlRequestRule &other)
+
+    Swaps this rule with \a other.
+*/
+
+/*!
+    Returns \c true if this rule is equal to \a other.
+*/
+bool QWebEngineUrlRequestRule::operator==(const QWebEngineUrlRequestRule &other) const
+{
+    return d == other.d || *d == *other.d;
+}
+
+/*!
+    \fn bool QWebEngineUrlRequestRule::operator!=(const QWebEngineUrlRequestRule &other) const
+
+    Returns \c true if this rule is not equal to \a other.
+*/
+
+/*!
+    Returns the URL pattern of the rule.
+*/
+QString QWebEngineUrlRequestRule::pattern() const
+{
+    return d->pattern;
+}
+
+/*!
+    Sets the URL pattern of the rule to \a pattern.
+*/
+void QWebEngineUrlRequestRule::setPattern(const QString &pattern)
+{
+    d->pattern = pattern;
+}
+
+/*!
+    Returns the action of the rule.
+*/
+QWebEngineUrlRequestRule::Action QWebEngineUrlRequestRule::action() const
+{
+    return d->action;
+}
+
+/*!
+    Sets the action of the rule to \a action.
+*/
+void QWebEngineUrlRequestRule::setAction(Action action)
+{
+    d->action = action;
+}
+
+/*!
+    Returns the URL that requests are redirected to by a Redirect rule.
+*/
+QUrl QWebEngineUrlRequestRule::redirectUrl() const
+{
+    return d->redirectUrl;
+}
+
+/*!
+    Sets the URL that requests are redirected to by a Redirect rule to \a url.
+*/
+void QWebEngineUrlRequestRule::setRedirectUrl(const QUrl &url)
+{
+    d->redirectUrl = url;
+}
+
+/*!
+    Returns the name of the HTTP header added by a SetHttpHeader rule.
+*/
+QByteArray QWebEngineUrlRequestRule::httpHeaderName() const
+{
+    return d->headerName;
+}
+
+/*!
+    Returns the value of the HTTP header added by a SetHttpHeader rule.
+*/
+QByteArray QWebEngineUrlRequestRule::httpHeaderValue() const
+{
+    return d->headerValue;
+}
+
+/*!
+    Sets the HTTP header added by a SetHttpHeader rule to \a name with \a value.
+*/
+void QWebEngineUrlRequestRule::setHttpHeader(const QByteArray &name, const QByteArray &value)
+{
+    d->headerName = name;
+    d->headerValue = value;
+}
+
+/*!
+    Returns the resource types the rule is limited to. An empty list means
+    that the rule applies to all resource types.
+*/
+QList<QWebEngineUrlRequestInfo::ResourceType> QWebEngineUrlRequestRule::resourceTypes() const
+{
+    return d->resourceTypes;
+}
+
+/*!
+    Limits the rule to requests for resources of \a types.
+*/
+void QWebEngineUrlRequestRule::setResourceTypes(const QList<QWebEngineUrlRequestInfo::ResourceType> &types)
+{
+    d->resourceTypes = types;
+}
+
+/*!
+    Returns the domains of the first-party URL the rule is limited to. An
+    empty list means that the rule applies to requests of any page.
+*/
+QStringList QWebEngineUrlRequestRule::firstPartyDomains() const
+{
+    return d->firstPartyDomains;
+}
+
+/*!
+    Limits the rule to requests made by pages in one of \a domains or one of
+    their subdomains.
+*/
+void QWebEngineUrlRequestRule::setFirstPartyDomains(const QStringList &domains)
+{
+    d->firstPartyDomains = domains;
+}
+
+static inline char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+static inline bool isTokenChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '%';
+}
+
+static inline bool isSeparator(char c)
+{
+    c = toLowerAscii(c);
+    return !((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.'
+             || c == '%');
+}
+
+static inline quint64 hashToken(QByteArrayView token)
+{
+    // FNV-1a
+    quint64 hash = 14695981039346656037ULL;
+    for (char c : token) {
+        hash ^= uchar(toLowerAscii(c));
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// URLs are matched in canonical form, where the host is in punycode and the
+// rest is percent-encoded UTF-8, so patterns are brought into the same form.
+static QByteArray toPercentEncodedUtf8(QStringView text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const QByteArray utf8 = text.toUtf8();
+    QByteArray encoded;
+    encoded.reserve(utf8.size());
+    for (char c : utf8) {
+        if (uchar(c) < 0x80) {
+            encoded.append(c);
+        } else {
+            encoded.append('%');
+            encoded.append(hexDigits[uchar(c) >> 4]);
+            encoded.append(hexDigits[uchar(c) & 0xf]);
+        }
+    }
+    return encoded;
+}
+
+static QByteArray toAceHost(QStringView host)
+{
+    const QByteArray ace = QUrl::toAce(host.toString());
+    return ace.isEmpty() && !host.isEmpty() ? toPercentEncodedUtf8(host) : ace;
+}
+
+// The host part of a pattern, if it has one, starts right after a domain
+// anchor or a scheme separator, and ends at the first character that can't
+// be part of a host name.
+static QByteArray canonicalPattern(QStringView pattern, bool domainAnchored)
+{
+    qsizetype hostBegin = 0;
+    if (!domainAnchored) {
+        hostBegin = pattern.indexOf(u"://");
+        if (hostBegin < 0)
+            return toPercentEncodedUtf8(pattern).toLower();
+        hostBegin += 3;
+    }
+    qsizetype hostEnd = hostBegin;
+    while (hostEnd < pattern.size() && !QStringView(u"/?#:^*|").contains(pattern.at(hostEnd)))
+        ++hostEnd;
+    return (toPercentEncodedUtf8(pattern.first(hostBegin))
+            + toAceHost(pattern.sliced(hostBegin, hostEnd - hostBegin))
+            + toPercentEncodedUtf8(pattern.sliced(hostEnd))).toLower();
+}
+
+static inline quint64 resourceTypeBit(QWebEngineUrlRequestInfo::ResourceType type)
+{
+    return quint64(1) << qMin(int(type), 63);
+}
+
+// Tokens occurring in nearly every URL make for useless index keys.
+static bool isCommonToken(QByteArrayView token)
+{
+    static const char *const commonTokens[] = { "http", "https", "www", "com", "js", "html" };
+    for (const char *common : commonTokens) {
+        if (token == QByteArrayView(common))
+            return true;
+    }
+    return false;
+}
+
+static bool matchesAt(QByteArrayView pattern, QByteArrayView url, qsizetype u, bool endAnchor)
+{
+    qsizetype p = 0;
+    qsizetype starP = -1;
+    qsizetype starU = 0;
+    for (;;) {
+        if (p == pattern.size()) {
+            if (!endAnchor || u == url.size())
+                return true;
+        } else if (pattern[p] == '*') {
+            starP = p++;
+            starU = u;
+            continue;
+        } else if (u < url.size()) {
+            if (pattern[p] == '^' ? isSeparator(url[u]) : pattern[p] == toLowerAscii(url[u])) {
+                ++p;
+                ++u;
+                continue;
+            }
+        } else if (pattern[p] == '^') {
+            // The separator placeholder also matches the end of the URL.
+            ++p;
+            continue;
+        }
+        if (starP < 0 || starU >= url.size())
+            return false;
+        p = starP + 1;
+        u = ++starU;
+    }
+}
+
+bool QWebEngineUrlRequestRuleMatcher::CompiledRule::matches(QByteArrayView url, qsizetype hostBegin,
+                                                            qsizetype hostEnd) const
+{
+    switch (anchor) {
+    case StartAnchor:
+        return matchesAt(pattern, url, 0, endAnchor);
+    case DomainAnchor:
+        for (qsizetype i = hostBegin; i < hostEnd; ++i) {
+            if ((i == hostBegin || url[i - 1] == '.') && matchesAt(pattern, url, i, endAnchor))
+                return true;
+        }
+        return false;
+    case NoAnchor: {
+        const char first = pattern.isEmpty() ? '*' : pattern.at(0);
+        const bool literalFirst = first != '*' && first != '^';
+        for (qsizetype i = 0; i <= url.size(); ++i) {
+            if (literalFirst && (i == url.size() || toLowerAscii(url[i]) != first))
+                continue;
+            if (matchesAt(pattern, url, i, endAnchor))
+                return true;
+        }
+        return false;
+    }
+    }
+    return false;
+}
+
+bool QWebEngineUrlRequestRuleMatcher::CompiledRule::matchesFirstParty(QByteArrayView host) const
+{
+    if (firstPartyDomains.isEmpty())
+        return true;
+    for (const QByteArray &domain : firstPartyDomains) {
+        if (host.size() < domain.size())
+            continue;
+        const QByteArrayView suffix = host.last(domain.size());
+        if (suffix.compare(domain, Qt::CaseInsensitive) != 0)
+            continue;
+        if (host.size() == domain.size() || host[host.size() - domain.size() - 1] == '.')
+            return true;
+    }
+    return false;
+}
+
+QWebEngineUrlRequestRuleMatcher::QWebEngineUrlRequestRuleMatcher(const QList<QWebEngineUrlRequestRule> &rules)
+{
+    m_rules.reserve(rules.size());
+    for (const QWebEngineUrlRequestRule &rule : rules) {
+        CompiledRule compiled;
+        const QString fullPattern = rule.pattern();
+        QStringView rulePattern = fullPattern;
+        if (rulePattern.startsWith(u"||")) {
+            compiled.anchor = DomainAnchor;
+            rulePattern = rulePattern.sliced(2);
+        } else if (rulePattern.startsWith(u'|')) {
+            compiled.anchor = StartAnchor;
+            rulePattern = rulePattern.sliced(1);
+        }
+        QByteArray pattern = canonicalPattern(rulePattern, compiled.anchor == DomainAnchor);
+        if (pattern.endsWith('|')) {
+            compiled.endAnchor = true;
+            pattern.chop(1);
+        }
+        compiled.pattern = pattern;
+        if (!rule.resourceTypes().isEmpty()) {
+            compiled.resourceTypes = 0;
+            for (QWebEngineUrlRequestInfo::ResourceType type : rule.resourceTypes())
+                compiled.resourceTypes |= resourceTypeBit(type);
+        }
+        for (const QString &domain : rule.firstPartyDomains())
+            compiled.firstPartyDomains.append(toAceHost(domain).toLower());
+        compiled.action = rule.action();
+        compiled.redirectUrl = rule.redirectUrl();
+        compiled.headerName = rule.httpHeaderName();
+        compiled.headerValue = rule.httpHeaderValue();
+
+        // File the rule under the literal token that the fewest rules share so
+        // far. A token is only usable if it can't be extended by a wildcard,
+        // since the URL is split into maximal tokens.
+        const qsizetype index = m_rules.size();
+        quint64 bestToken = 0;
+        qsizetype bestCount = -1;
+        qsizetype bestLength = 0;
+        for (qsizetype i = 0; i < pattern.size();) {
+            if (!isTokenChar(pattern.at(i))) {
+                ++i;
+                continue;
+            }
+            const qsizetype begin = i;
+            while (i < pattern.size() && isTokenChar(pattern.at(i)))
+                ++i;
+            const bool boundedBefore = begin > 0 ? pattern.at(begin - 1) != '*' : compiled.anchor != NoAnchor;
+            const bool boundedAfter = i < pattern.size() ? pattern.at(i) != '*' : compiled.endAnchor;
+            const QByteArrayView token(pattern.constData() + begin, i - begin);
+            if (!boundedBefore || !boundedAfter || isCommonToken(token))
+                continue;
+            const quint64 hash = hashToken(token);
+            const qsizetype count = m_tokenIndex.value(hash).size();
+            if (bestCount < 0 || count < bestCount || (count == bestCount && token.size() > bestLength)) {
+                bestToken = hash;
+                bestCount = count;
+                bestLength = token.size();
+            }
+        }
+        if (bestCount >= 0)
+            m_tokenIndex[bestToken].append(index);
+        else
+            m_untokenizedRules.append(index);
+        m_rules.append(std::move(compiled));
+    }
+}
+
+QWebEngineUrlRequestRuleMatcher::Result
+QWebEngineUrlRequestRuleMatcher::match(QByteArrayView url, QByteArrayView firstPartyHost,
+                                       QWebEngineUrlRequestInfo::ResourceType resourceType) const
+{
+    Result result;
+    if (m_rules.isEmpty())
+        return result;
+
+    // Collect the candidate rules from the index, in rule order.
+    QVarLengthArray<qsizetype, 64> candidates;
+    for (qsizetype i = 0; i < url.size();) {
+        if (!isTokenChar(toLowerAscii(url[i]))) {
+            ++i;
+            continue;
+        }
+        const qsizetype begin = i;
+        while (i < url.size() && isTokenChar(toLowerAscii(url[i])))
+            ++i;
+        const auto it = m_tokenIndex.constFind(hashToken(url.sliced(begin, i - begin)));
+        if (it != m_tokenIndex.constEnd())
+            candidates.append(it->constData(), it->size());
+    }
+    candidates.append(m_untokenizedRules.constData(), m_untokenizedRules.size());
+    if (candidates.isEmpty())
+        return result;
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    qsizetype hostBegin = url.indexOf("://");
+    hostBegin = hostBegin < 0 ? 0 : hostBegin + 3;
+    qsizetype hostEnd = hostBegin;
+    while (hostEnd < url.size() && url[hostEnd] != '/' && url[hostEnd] != '?' && url[hostEnd] != '#') {
+        if (url[hostEnd] == '@')
+            hostBegin = hostEnd + 1;
+        ++hostEnd;
+    }
+    for (qsizetype i = hostBegin; i < hostEnd; ++i) {
+        if (url[i] == ':') {
+            hostEnd = i;
+            break;
+        }
+    }
+
+    bool decided = false;
+    const quint64 typeBit = resourceTypeBit(resourceType);
+    for (qsizetype index : candidates) {
+        const CompiledRule &rule = m_rules.at(index);
+        if (decided && rule.action != QWebEngineUrlRequestRule::SetHttpHeader)
+            continue;
+        if (!(rule.resourceTypes & typeBit) || !rule.matchesFirstParty(firstPartyHost)
+                || !rule.matches(url, hostBegin, hostEnd))
+            continue;
+        switch (rule.action) {
+        case QWebEngineUrlRequestRule::Block:
+            result.block = true;
+            decided = true;
+            break;
+        case QWebEngineUrlRequestRule::Redirect:
+            result.redirectUrl = rule.redirectUrl;
+            decided = true;
+            break;
+        case QWebEngineUrlRequestRule::SetHttpHeader:
+            result.httpHeaders.append(qMakePair(rule.headerName, rule.headerValue));
+            break;
+        }
+    }
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,106 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWEBENGINEURLREQUESTRULE_H
+#define QWEBENGINEURLREQUESTRULE_H
+
+#include <QtWebEngineCore/qtwebenginecoreglobal.h>
+#include <QtWebEngineCore/qwebengineurlrequestinfo.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qurl.h>
+
+QT_BEGIN_NAMESPACE
+
+class QWebEngineUrlRequestRulePrivate;
+
+class Q_WEBENGINECORE_EXPORT QWebEngineUrlRequestRule
+{
+public:
+    enum Action {
+        Block,
+        Redirect,
+        SetHttpHeader
+    };
+
+    explicit QWebEngineUrlRequestRule(const QString &pattern = QString(), Action action = Block);
+    QWebEngineUrlRequestRule(const QWebEngineUrlRequestRule &other);
+    ~QWebEngineUrlRequestRule();
+    QWebEngineUrlRequestRule &operator=(QWebEngineUrlRequestRule &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+    QWebEngineUrlRequestRule &operator=(const QWebEngineUrlRequestRule &other);
+    void swap(QWebEngineUrlRequestRule &other) noexcept { qSwap(d, other.d); }
+
+    bool operator==(const QWebEngineUrlRequestRule &other) const;
+    inline bool operator!=(const QWebEngineUrlRequestRule &other) const { return !operator==(other); }
+
+    QString pattern() const;
+    void setPattern(const QString &pattern);
+
+    Action action() const;
+    void setAction(Action action);
+
+    QUrl redirectUrl() const;
+    void setRedirectUrl(const QUrl &url);
+
+    QByteArray httpHeaderName() const;
+    QByteArray httpHeaderValue() const;
+    void setHttpHeader(const QByteArray &name, const QByteArray &value);
+
+    QList<QWebEngineUrlRequestInfo::ResourceType> resourceTypes() const;
+    void setResourceTypes(const QList<QWebEngineUrlRequestInfo::ResourceType> &types);
+
+    QStringList firstPartyDomains() const;
+    void setFirstPartyDomains(const QStringList &domains);
+
+private:
+    QSharedDataPointer<QWebEngineUrlRequestRulePrivate> d;
+};
+
+Q_DECLARE_SHARED(QWebEngineUrlRequestRule)
+
+QT_END_NAMESPACE
+
+#endif // QWEBENGINEURLREQUESTRULE_H
@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QWEBENGINEURLREQUESTRULE_P_H
+#define QWEBENGINEURLREQUESTRULE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtwebenginecoreglobal_p.h"
+
+#include "qwebengineurlrequestrule.h"
+
+#include <QByteArrayView>
+#include <QHash>
+#include <QPair>
+
+QT_BEGIN_NAMESPACE
+
+// An immutable, indexed form of a list of QWebEngineUrlRequestRule. Every rule
+// with a literal token in its pattern is filed under that token's hash, so a
+// URL only has to be tested against the rules sharing one of its tokens.
+// Safe to use from any thread.
+class Q_WEBENGINECORE_PRIVATE_EXPORT QWebEngineUrlRequestRuleMatcher
+{
+public:
+    struct Result
+    {
+        bool block = false;
+        QUrl redirectUrl;
+        QList<QPair<QByteArray, QByteArray>> httpHeaders;
+    };
+
+    explicit QWebEngineUrlRequestRuleMatcher(const QList<QWebEngineUrlRequestRule> &rules);
+
+    // The url must be in canonical form, such as the spec of a GURL.
+    Result match(QByteArrayView url, QByteArrayView firstPartyHost,
+                 QWebEngineUrlRequestInfo::ResourceType resourceType) const;
+
+    qsizetype size() const { return m_rules.size(); }
+
+private:
+    enum Anchor : quint8 {
+        NoAnchor,
+        StartAnchor,
+        DomainAnchor
+    };
+
+    struct CompiledRule
+    {
+        QByteArray pattern;
+        Anchor anchor = NoAnchor;
+        bool endAnchor = false;
+        quint64 resourceTypes = ~quint64(0);
+        QList<QByteArray> firstPartyDomains;
+        QWebEngineUrlRequestRule::Action action = QWebEngineUrlRequestRule::Block;
+        QUrl redirectUrl;
+        QByteArray headerName;
+        QByteArray headerValue;
+
+        bool matches(QByteArrayView url, qsizetype hostBegin, qsizetype hostEnd) const;
+        bool matchesFirstParty(QByteArrayView host) const;
+    };
+
+    QList<CompiledRule> m_rules;
+    QHash<quint64, QList<qsizetype>> m_tokenIndex;
+    QList<qsizetype> m_untokenizedRules;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWEBENGINEURLREQUESTRULE_P_H
@@ -42,6 +42,7 @@
 #include "api/qwebenginemessagepumpscheduler_p.h"
 
 #include "base/message_loop/message_pump_for_ui.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/process/process.h"
 #include "base/task/current_thread.h"
 #include "base/task/sequence_manager/sequence_manager_impl.h"
@@ -49,6 +50,7 @@
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/trace_event/trace_event.h"
 #include "chrome/browser/tab_contents/form_interaction_tab_helper.h"
 #include "components/device_event_log/device_event_log.h"
 #include "components/performance_manager/embedder/performance_manager_lifetime.h"
@@ -117,6 +119,18 @@ int GetTimeIntervalMilliseconds(const base::TimeTicks &from)
     return delay < 0 ? 0 : delay;
 }
 
+const static char kUITimeSliceEnv[] = "QTWEBENGINE_UI_TIME_SLICE";
+
+// How long the UI message pump may keep running Chromium tasks before it
+// returns to the Qt event loop. Zero runs a single batch of tasks per event
+// loop iteration.
+base::TimeDelta uiTimeSlice()
+{
+    static const base::TimeDelta slice = base::TimeDelta::FromMilliseconds(
+            qEnvironmentVariableIsSet(kUITimeSliceEnv) ? qMax(0, qEnvironmentVariableIntValue(kUITimeSliceEnv)) : 4);
+    return slice;
+}
+
 }  // anonymous namespace
 
 class MessagePumpForUIQt : public base::MessagePump
@@ -206,11 +220,29 @@ private:
     };
 
 
+    // Runs Chromium tasks for up to uiTimeSlice(), but gives Qt a turn as soon
+    // as input is waiting, so that input handling and animations don't have
+    // to wait for a burst of page loading tasks.
     void handleScheduledWork()
     {
+        using SliceEnd = QWebEngineMessagePumpScheduler::SliceEnd;
         ScopedGLContextChecker glContextChecker;
-
-        base::MessagePump::Delegate::NextWorkInfo more_work_info = m_delegate->DoWork();
+        TRACE_EVENT_BEGIN0("toplevel", "MessagePumpForUIQt::WorkSlice");
+
+        const base::TimeTicks sliceStart = base::TimeTicks::Now();
+        base::MessagePump::Delegate::NextWorkInfo more_work_info;
+        const SliceEnd end = QWebEngineMessagePumpScheduler::runWorkSlice([&]() {
+            more_work_info = m_delegate->DoWork();
+            return more_work_info.is_immediate();
+        }, QDeadlineTimer(std::chrono::microseconds(uiTimeSlice().InMicroseconds()), Qt::PreciseTimer));
+
+        UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES("QtWebEngine.UIThread.WorkSliceDuration",
+                                                base::TimeTicks::Now() - sliceStart,
+                                                base::TimeDelta::FromMicroseconds(1),
+                                                base::TimeDelta::FromMilliseconds(100), 50);
+        UMA_HISTOGRAM_ENUMERATION("QtWebEngine.UIThread.WorkSliceEnd", static_cast<int>(end),
+                                  static_cast<int>(SliceEnd::InputPending) + 1);
+        TRACE_EVENT_END1("toplevel", "MessagePumpForUIQt::WorkSlice", "end", static_cast<int>(end));
 
         if (more_work_info.is_immediate())
             return ScheduleWork();
@@ -45,6 +45,7 @@
 #include <QHash>
 #include <QImage>
 #include <QMutex>
+#include <QRect>
 
 namespace QtWebEngineCore {
 
@@ -92,6 +93,8 @@ public:
         return *it;
     }
 
+    Binding *find(Id id) const { return m_map.value(id); }
+
     void remove(Id id) { m_map.remove(id); }
 
 private:
@@ -172,6 +175,16 @@ Compositor::Handle<Compositor::Observer> Compositor::observer()
     return nullptr;
 }
 
+Compositor::Handle<Compositor> Compositor::find(Id id)
+{
+    g_bindings.lock();
+    Binding *binding = g_bindings.find(id);
+    if (binding && binding->compositor)
+        return binding->compositor; // delay unlock
+    g_bindings.unlock();
+    return nullptr;
+}
+
 QImage Compositor::image()
 {
     Q_UNREACHABLE();
@@ -183,6 +196,23 @@ void Compositor::waitForTexture()
     Q_UNREACHABLE();
 }
 
+QImage Compositor::acquireImage()
+{
+    Q_UNREACHABLE();
+    return {};
+}
+
+void Compositor::releaseImage(const QImage &)
+{
+    Q_UNREACHABLE();
+}
+
+QRect Compositor::damageRect()
+{
+    Q_UNREACHABLE();
+    return {};
+}
+
 int Compositor::textureId()
 {
     Q_UNREACHABLE();
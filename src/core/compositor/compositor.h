@@ -44,6 +44,7 @@
 
 QT_BEGIN_NAMESPACE
 class QImage;
+class QRect;
 class QSize;
 QT_END_NAMESPACE
 
@@ -67,6 +68,11 @@ public:
     enum class Type {
         Software,
         OpenGL,
+        // Software frames, but only produced on request (see
+        // RenderWidgetHostViewQt::produceFrame), not paced by vsync.
+        // Each frame is swapped in as soon as it is drawn; swapFrame()
+        // only reports the damage since the last call.
+        Headless,
     };
 
     // Identifies a compositor.
@@ -141,6 +147,9 @@ public:
     // Observer if bound.
     Handle<Observer> observer();
 
+    // Compositor for the given id, if it exists.
+    static Handle<Compositor> find(Id id);
+
     // Update to next frame if possible.
     virtual void swapFrame() = 0;
 
@@ -161,14 +170,29 @@ public:
     // In OpenGL mode, the texture format is either GL_RGBA or GL_RGB.
     virtual bool hasAlphaChannel() = 0;
 
-    // (Software) QImage of the frame.
+    // (Software, Headless) QImage of the frame.
     //
     // This is a big image so we should try not to make copies of it.
-    // In particular, the client should drop its QImage reference
-    // before calling swapFrame(), otherwise each swap will cause a
-    // detach.
+    // The frame buffers form a small ring: swapFrame() never writes into
+    // a buffer that is still referenced, but if the client keeps
+    // references to all of them, new frames are dropped until one is
+    // released.
     virtual QImage image();
 
+    // (Software, Headless) Like image(), but explicitly reserves the frame buffer.
+    //
+    // The buffer is not reused by swapFrame() until the image is handed
+    // back with releaseImage(), even if the client's QImage reference
+    // is passed on to another thread in the meantime.
+    virtual QImage acquireImage();
+    virtual void releaseImage(const QImage &image);
+
+    // (Software, Headless) Region of image() updated by the last swapFrame().
+    //
+    // Covers the whole image if the size changed and is empty if
+    // swapFrame() had no new frame to take.
+    virtual QRect damageRect();
+
     // (OpenGL) Wait on texture fence in Qt's current OpenGL context.
     virtual void waitForTexture();
 
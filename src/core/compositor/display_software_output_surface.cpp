@@ -42,6 +42,7 @@
 #include "compositor.h"
 #include "render_widget_host_view_qt_delegate.h"
 #include "type_conversion.h"
+#include "web_engine_context.h"
 
 #include "base/threading/thread_task_runner_handle.h"
 #include "components/viz/service/display/display.h"
@@ -66,21 +67,44 @@ public:
     // Overridden from Compositor.
     void swapFrame() override;
     QImage image() override;
+    QImage acquireImage() override;
+    void releaseImage(const QImage &image) override;
+    QRect damageRect() override;
     float devicePixelRatio() override;
     QSize size() override;
     bool hasAlphaChannel() override;
 
 private:
+    // One frame buffer of the ring.
+    //
+    // staleRect is the region where the buffer differs from the last
+    // frame drawn by viz, i.e. the damage of all frames it missed.
+    struct Buffer
+    {
+        QImage image;
+        QRect staleRect;
+        int acquireCount = 0;
+    };
+    static constexpr int kBufferCount = 3;
+
+    Buffer *findWritableBuffer();
+    QRect takeFrame();
+
     mutable QMutex m_mutex;
     float m_devicePixelRatio = 1.0;
     scoped_refptr<base::SingleThreadTaskRunner> m_taskRunner;
     SwapBuffersCallback m_swapCompletionCallback;
-    QImage m_image;
+    QRect m_pendingDamageRect;
+    Buffer m_buffers[kBufferCount];
+    Buffer *m_frontBuffer = nullptr;
+    QRect m_undeliveredDamageRect;
+    QRect m_imageDamageRect;
+    QRect m_headlessDamageRect;
     float m_imageDevicePixelRatio = 1.0;
 };
 
 DisplaySoftwareOutputSurface::Device::Device()
-    : Compositor(Type::Software)
+    : Compositor(WebEngineContext::isHeadlessCompositing() ? Type::Headless : Type::Software)
 {}
 
 DisplaySoftwareOutputSurface::Device::~Device()
@@ -103,6 +127,11 @@ void DisplaySoftwareOutputSurface::Device::OnSwapBuffers(SwapBuffersCallback swa
         QMutexLocker locker(&m_mutex);
         m_taskRunner = base::ThreadTaskRunnerHandle::Get();
         m_swapCompletionCallback = std::move(swap_ack_callback);
+        m_pendingDamageRect = toQt(damage_rect_);
+        // Headless frames are taken as soon as they are drawn, so that they
+        // are in image() by the time produceFrame() reports them.
+        if (type() == Type::Headless)
+            m_headlessDamageRect |= takeFrame();
     }
 
     if (auto obs = observer())
@@ -122,36 +151,112 @@ inline QImage::Format imageFormat(SkColorType colorType)
     }
 }
 
+// A buffer can be written only if nobody else can see it: not the front
+// buffer, not acquired, and not shared with a QImage copy held by a
+// client (painting into it would detach, which is a full deep copy).
+DisplaySoftwareOutputSurface::Device::Buffer *DisplaySoftwareOutputSurface::Device::findWritableBuffer()
+{
+    for (Buffer &buffer : m_buffers) {
+        if (&buffer != m_frontBuffer && buffer.acquireCount == 0
+            && (buffer.image.isNull() || buffer.image.isDetached()))
+            return &buffer;
+    }
+    return nullptr;
+}
+
 void DisplaySoftwareOutputSurface::Device::swapFrame()
 {
     QMutexLocker locker(&m_mutex);
 
+    // Only report what changed in headless frames taken since the last call.
+    if (type() == Type::Headless)
+        m_imageDamageRect = std::exchange(m_headlessDamageRect, QRect());
+    else
+        m_imageDamageRect = takeFrame();
+}
+
+// Copies the frame drawn by viz into the buffer ring and acknowledges the
+// swap. Returns the region of the new front buffer that changed, which is
+// empty if there was no new frame or it had to be dropped.
+//
+// Called with m_mutex locked.
+QRect DisplaySoftwareOutputSurface::Device::takeFrame()
+{
+    QRect damageRect;
     if (!m_swapCompletionCallback)
-        return;
+        return damageRect;
 
     SkPixmap skPixmap;
     surface_->peekPixels(&skPixmap);
     QImage image(reinterpret_cast<const uchar *>(skPixmap.addr()), viewport_pixel_size_.width(),
                  viewport_pixel_size_.height(), skPixmap.rowBytes(),
                  imageFormat(skPixmap.colorType()));
-    if (m_image.size() == image.size()) {
-        QRect damageRect = toQt(damage_rect_);
-        QPainter painter(&m_image);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-        painter.drawImage(damageRect, image, damageRect);
-    } else {
-        m_image = image;
-        m_image.detach();
+
+    for (Buffer &buffer : m_buffers)
+        buffer.staleRect |= m_pendingDamageRect;
+    m_undeliveredDamageRect |= m_pendingDamageRect;
+    m_pendingDamageRect = QRect();
+
+    // If the client holds on to every other buffer, the frame is dropped
+    // instead of waiting; its damage is carried over to the next swap.
+    if (Buffer *buffer = findWritableBuffer()) {
+        if (buffer->image.size() != image.size() || buffer->image.format() != image.format()) {
+            buffer->image = QImage(image.size(), image.format());
+            buffer->staleRect = buffer->image.rect();
+        }
+        {
+            QRect staleRect = buffer->staleRect & buffer->image.rect();
+            QPainter painter(&buffer->image);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawImage(staleRect, image, staleRect);
+        }
+        buffer->staleRect = QRect();
+
+        if (!m_frontBuffer || m_frontBuffer->image.size() != buffer->image.size())
+            damageRect = buffer->image.rect();
+        else
+            damageRect = m_undeliveredDamageRect & buffer->image.rect();
+        m_undeliveredDamageRect = QRect();
+        m_frontBuffer = buffer;
+        m_imageDevicePixelRatio = m_devicePixelRatio;
     }
-    m_imageDevicePixelRatio = m_devicePixelRatio;
+
     m_taskRunner->PostTask(
-            FROM_HERE, base::BindOnce(std::move(m_swapCompletionCallback), toGfx(m_image.size())));
+            FROM_HERE, base::BindOnce(std::move(m_swapCompletionCallback), toGfx(image.size())));
     m_taskRunner.reset();
+    return damageRect;
 }
 
 QImage DisplaySoftwareOutputSurface::Device::image()
 {
-    return m_image;
+    QMutexLocker locker(&m_mutex);
+    return m_frontBuffer ? m_frontBuffer->image : QImage();
+}
+
+QImage DisplaySoftwareOutputSurface::Device::acquireImage()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_frontBuffer)
+        return QImage();
+    m_frontBuffer->acquireCount++;
+    return m_frontBuffer->image;
+}
+
+void DisplaySoftwareOutputSurface::Device::releaseImage(const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Buffer &buffer : m_buffers) {
+        if (buffer.acquireCount > 0 && buffer.image.constBits() == image.constBits()) {
+            buffer.acquireCount--;
+            return;
+        }
+    }
+}
+
+QRect DisplaySoftwareOutputSurface::Device::damageRect()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_imageDamageRect;
 }
 
 float DisplaySoftwareOutputSurface::Device::devicePixelRatio()
@@ -161,12 +266,14 @@ float DisplaySoftwareOutputSurface::Device::devicePixelRatio()
 
 QSize DisplaySoftwareOutputSurface::Device::size()
 {
-    return m_image.size();
+    QMutexLocker locker(&m_mutex);
+    return m_frontBuffer ? m_frontBuffer->image.size() : QSize();
 }
 
 bool DisplaySoftwareOutputSurface::Device::hasAlphaChannel()
 {
-    return m_image.format() == QImage::Format_ARGB32_Premultiplied;
+    QMutexLocker locker(&m_mutex);
+    return m_frontBuffer && m_frontBuffer->image.format() == QImage::Format_ARGB32_Premultiplied;
 }
 
 DisplaySoftwareOutputSurface::DisplaySoftwareOutputSurface()
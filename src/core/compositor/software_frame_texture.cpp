@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "software_frame_texture.h"
+
+#include <QLoggingCategory>
+#include <QtGui/private/qrhi_p.h>
+
+namespace QtWebEngineCore {
+
+Q_LOGGING_CATEGORY(lcUpload, "qt.webengine.compositor.upload")
+
+SoftwareFrameTexture::~SoftwareFrameTexture()
+{
+    delete m_texture;
+}
+
+void SoftwareFrameTexture::setFrame(const QImage &image, const QRect &damageRect)
+{
+    if (image.size() != m_size) {
+        m_size = image.size();
+        m_dirtyRect = image.rect();
+    } else {
+        m_dirtyRect |= damageRect & image.rect();
+    }
+    m_hasAlphaChannel = image.hasAlphaChannel();
+    m_image = image;
+}
+
+qint64 SoftwareFrameTexture::comparisonKey() const
+{
+    return m_texture ? qint64(qintptr(m_texture)) : qint64(qintptr(this));
+}
+
+QRhiTexture *SoftwareFrameTexture::rhiTexture() const
+{
+    return m_texture;
+}
+
+QSize SoftwareFrameTexture::textureSize() const
+{
+    return m_size;
+}
+
+bool SoftwareFrameTexture::hasAlphaChannel() const
+{
+    return m_hasAlphaChannel;
+}
+
+bool SoftwareFrameTexture::hasMipmaps() const
+{
+    return false;
+}
+
+void SoftwareFrameTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates)
+{
+    m_uploadedBytes = 0;
+    if (m_image.isNull())
+        return;
+
+    const bool bgra = m_image.format() == QImage::Format_ARGB32_Premultiplied
+            && rhi->isTextureFormatSupported(QRhiTexture::BGRA8);
+    const QRhiTexture::Format format = bgra ? QRhiTexture::BGRA8 : QRhiTexture::RGBA8;
+
+    if (!m_texture || m_texture->pixelSize() != m_size || m_texture->format() != format) {
+        delete m_texture;
+        m_texture = rhi->newTexture(format, m_size);
+        if (!m_texture->create()) {
+            qWarning("Failed to create texture for software compositor frame");
+            delete m_texture;
+            m_texture = nullptr;
+            m_image = QImage();
+            return;
+        }
+        m_dirtyRect = m_image.rect();
+    }
+
+    if (!m_dirtyRect.isEmpty()) {
+        QRhiTextureSubresourceUploadDescription subresource;
+        if (bgra || m_image.format() == QImage::Format_RGBA8888_Premultiplied) {
+            // Upload straight from the frame, no intermediate copy.
+            subresource = QRhiTextureSubresourceUploadDescription(m_image);
+            subresource.setSourceTopLeft(m_dirtyRect.topLeft());
+            subresource.setSourceSize(m_dirtyRect.size());
+        } else {
+            subresource = QRhiTextureSubresourceUploadDescription(
+                    m_image.copy(m_dirtyRect).convertToFormat(QImage::Format_RGBA8888_Premultiplied));
+        }
+        subresource.setDestinationTopLeft(m_dirtyRect.topLeft());
+        resourceUpdates->uploadTexture(m_texture,
+                                       QRhiTextureUploadDescription(QRhiTextureUploadEntry(0, 0, subresource)));
+        m_uploadedBytes = qint64(m_dirtyRect.width()) * m_dirtyRect.height() * 4;
+        qCDebug(lcUpload) << "uploaded" << m_dirtyRect << m_uploadedBytes << "bytes";
+    }
+
+    m_dirtyRect = QRect();
+    m_image = QImage();
+}
+
+} // namespace QtWebEngineCore
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SOFTWARE_FRAME_TEXTURE_H
+#define SOFTWARE_FRAME_TEXTURE_H
+
+#include <QtWebEngineCore/private/qtwebenginecoreglobal_p.h>
+
+#include <QImage>
+#include <QRect>
+#include <QSGTexture>
+
+namespace QtWebEngineCore {
+
+// Persistent scene graph texture for software compositor frames.
+//
+// Instead of creating a new texture from the whole frame on every
+// swap, the delegates keep one instance of this texture per view and
+// feed it the damage rect reported by Compositor::damageRect(). Only
+// that part of the frame is uploaded to the RHI texture, unless the
+// texture has to be (re)created.
+//
+// The frame reference is dropped after the upload, so that the
+// compositor can reuse the buffer for one of the next frames.
+class Q_WEBENGINECORE_PRIVATE_EXPORT SoftwareFrameTexture final : public QSGTexture
+{
+public:
+    SoftwareFrameTexture() = default;
+    ~SoftwareFrameTexture() override;
+
+    // Queues the damaged part of image for upload. Damage of frames
+    // which were not committed yet is accumulated.
+    void setFrame(const QImage &image, const QRect &damageRect);
+
+    // Number of bytes uploaded by the last commitTextureOperations().
+    qint64 uploadedBytes() const { return m_uploadedBytes; }
+
+    // Overridden from QSGTexture.
+    qint64 comparisonKey() const override;
+    QRhiTexture *rhiTexture() const override;
+    QSize textureSize() const override;
+    bool hasAlphaChannel() const override;
+    bool hasMipmaps() const override;
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override;
+
+private:
+    QImage m_image;
+    QRect m_dirtyRect;
+    QSize m_size;
+    bool m_hasAlphaChannel = true;
+    QRhiTexture *m_texture = nullptr;
+    qint64 m_uploadedBytes = 0;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // !SOFTWARE_FRAME_TEXTURE_H
@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef BACKGROUND_URL_REQUEST_INTERCEPTOR_H
+#define BACKGROUND_URL_REQUEST_INTERCEPTOR_H
+
+#include "base/memory/scoped_refptr.h"
+
+#include <QMutex>
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+QT_BEGIN_NAMESPACE
+class QWebEngineUrlRequestInfo;
+class QWebEngineUrlRequestInterceptor;
+QT_END_NAMESPACE
+
+namespace QtWebEngineCore {
+
+// Runs a profile's background QWebEngineUrlRequestInterceptor on its own thread
+// pool sequence. Shared between the profile and the requests being intercepted,
+// so that interceptions already posted can outlive the profile.
+class BackgroundUrlRequestInterceptor
+{
+public:
+    explicit BackgroundUrlRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+    ~BackgroundUrlRequestInterceptor();
+
+    // Detaches the interceptor, waiting for a running interception to finish.
+    void reset();
+
+    // Called on taskRunner() only.
+    void interceptRequest(QWebEngineUrlRequestInfo &info);
+
+    base::SequencedTaskRunner *taskRunner() const { return m_taskRunner.get(); }
+
+private:
+    QMutex m_mutex;
+    QWebEngineUrlRequestInterceptor *m_interceptor;
+    scoped_refptr<base::SequencedTaskRunner> m_taskRunner;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // BACKGROUND_URL_REQUEST_INTERCEPTOR_H
@@ -46,11 +46,13 @@
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/receiver_set.h"
 #include "mojo/public/cpp/system/data_pipe.h"
+#include "mojo/public/cpp/system/data_pipe_producer.h"
 #include "mojo/public/cpp/system/simple_watcher.h"
 #include "net/base/net_errors.h"
 #include "net/http/http_status_code.h"
 #include "net/http/http_util.h"
 #include "services/network/public/cpp/cors/cors.h"
+#include "services/network/public/cpp/features.h"
 #include "services/network/public/mojom/url_loader.mojom.h"
 #include "services/network/public/mojom/url_loader_factory.mojom.h"
 #include "services/network/public/mojom/url_response_head.mojom.h"
@@ -72,6 +74,39 @@ namespace QtWebEngineCore {
 
 namespace {
 
+// Serves a QByteArray reply to mojo::DataPipeProducer, which reads it on
+// a background sequence. Holds its own reference to the data (and to the
+// file mapping the data may point into), so that it stays valid even if
+// the loader goes away first.
+class ByteArrayDataSource : public mojo::DataPipeProducer::DataSource
+{
+public:
+    ByteArrayDataSource(const QByteArray &data, std::shared_ptr<QFile> mappedFile,
+                        qint64 offset, qint64 length)
+        : m_data(data), m_mappedFile(std::move(mappedFile)), m_offset(offset), m_length(length)
+    {}
+
+    // mojo::DataPipeProducer::DataSource:
+    uint64_t GetLength() const override { return m_length; }
+    ReadResult Read(uint64_t offset, base::span<char> buffer) override
+    {
+        ReadResult result;
+        if (offset <= m_length) {
+            result.bytes_read = std::min<uint64_t>(m_length - offset, buffer.size());
+            memcpy(buffer.data(), m_data.constData() + m_offset + offset, result.bytes_read);
+        } else {
+            result.result = MOJO_RESULT_OUT_OF_RANGE;
+        }
+        return result;
+    }
+
+private:
+    const QByteArray m_data;
+    const std::shared_ptr<QFile> m_mappedFile;
+    const qint64 m_offset;
+    const qint64 m_length;
+};
+
 class CustomURLLoader : public network::mojom::URLLoader
                       , private URLRequestCustomJobProxy::Client
 {
@@ -151,7 +186,14 @@ private:
             if (!m_corsEnabled && !m_request.request_initiator->IsSameOriginWith(url::Origin::Create(m_request.url)))
                 return CompleteWithFailure(network::CorsErrorStatus(network::mojom::CorsError::kCorsDisabledScheme));
         }
-        if (mojo::CreateDataPipe(nullptr, m_pipeProducerHandle, m_pipeConsumerHandle) != MOJO_RESULT_OK)
+        // Use the same pipe capacity as the network service, so that large
+        // replies are written in as few chunks as possible.
+        MojoCreateDataPipeOptions options;
+        options.struct_size = sizeof(MojoCreateDataPipeOptions);
+        options.flags = MOJO_CREATE_DATA_PIPE_FLAG_NONE;
+        options.element_num_bytes = 1;
+        options.capacity_num_bytes = network::features::GetDataPipeDefaultAllocationSize();
+        if (mojo::CreateDataPipe(&options, m_pipeProducerHandle, m_pipeConsumerHandle) != MOJO_RESULT_OK)
             return CompleteWithFailure(net::ERR_FAILED);
 
         m_head = network::mojom::URLResponseHead::New();
@@ -303,7 +345,7 @@ private:
             // ### should m_request be updated with RedirectInfo? (see FollowRedirect)
             return;
         }
-        DCHECK(m_device);
+        DCHECK(m_device || m_hasData);
         m_head->mime_type = m_mimeType;
         m_head->charset = m_charset;
         m_headerBytesRead = m_head->headers->raw_headers().length();
@@ -311,6 +353,11 @@ private:
         m_client->OnStartLoadingResponseBody(std::move(m_pipeConsumerHandle));
         m_head = nullptr;
 
+        if (m_hasData) {
+            writeData();
+            return;
+        }
+
         if (readAvailableData()) // May delete this
             return;
 
@@ -365,6 +412,8 @@ private:
     void notifyReadyRead() override
     {
         DCHECK(m_taskRunner->RunsTasksInCurrentSequence());
+        if (m_hasData)
+            return; // Not reading from the device
         readAvailableData();
     }
     void notifyReadyWrite(MojoResult result, const mojo::HandleSignalsState &state)
@@ -414,6 +463,32 @@ private:
         CompleteWithFailure(m_error ? net::Error(m_error) : net::ERR_FAILED);
         return true; // Done with reading
     }
+    void writeData()
+    {
+        DCHECK(m_taskRunner->RunsTasksInCurrentSequence());
+        qint64 offset = 0;
+        qint64 length = m_data.size();
+        if (m_byteRange.IsValid() && m_totalSize > 0) {
+            offset = m_byteRange.first_byte_position();
+            length = m_maxBytesToRead;
+        }
+        m_producer = std::make_unique<mojo::DataPipeProducer>(std::move(m_pipeProducerHandle));
+        m_producer->Write(std::make_unique<ByteArrayDataSource>(m_data, std::move(m_mappedFile), offset, length),
+                          base::BindOnce(&CustomURLLoader::notifyDataWritten,
+                                         m_weakPtrFactory.GetWeakPtr(), length));
+        // The data source holds its own reference now.
+        m_data = QByteArray();
+    }
+    void notifyDataWritten(qint64 length, MojoResult result)
+    {
+        DCHECK(m_taskRunner->RunsTasksInCurrentSequence());
+        m_producer.reset();
+        if (result == MOJO_RESULT_OK) {
+            m_totalBytesRead = length;
+            m_client->OnTransferSizeUpdated(m_totalBytesRead);
+        }
+        OnTransferComplete(result);
+    }
     bool ParseRange(const net::HttpRequestHeaders &headers)
     {
         std::string range_header;
@@ -443,6 +518,7 @@ private:
     mojo::ScopedDataPipeProducerHandle m_pipeProducerHandle;
     mojo::ScopedDataPipeConsumerHandle m_pipeConsumerHandle;
     std::unique_ptr<mojo::SimpleWatcher> m_watcher;
+    std::unique_ptr<mojo::DataPipeProducer> m_producer;
 
     net::HttpByteRange m_byteRange;
     int64_t m_totalSize = 0;
@@ -43,6 +43,7 @@
 
 #include "base/bind.h"
 #include "base/task/post_task.h"
+#include "base/task_runner_util.h"
 #include "content/browser/web_contents/web_contents_impl.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
@@ -54,6 +55,8 @@
 #include "url/url_util.h"
 
 #include "api/qwebengineurlrequestinfo_p.h"
+#include "api/qwebengineurlrequestrule_p.h"
+#include "net/background_url_request_interceptor.h"
 #include "type_conversion.h"
 #include "web_contents_adapter.h"
 #include "web_contents_adapter_client.h"
@@ -140,10 +143,19 @@ public:
     void ResumeReadingBodyFromNet() override;
 
     static inline void cleanup(QWebEngineUrlRequestInfo *info) { delete info; }
+    struct RequestInfoDeleter {
+        void operator()(QWebEngineUrlRequestInfo *info) const { cleanup(info); }
+    };
+    typedef std::unique_ptr<QWebEngineUrlRequestInfo, RequestInfoDeleter> RequestInfoPtr;
 
 private:
+    static RequestInfoPtr InterceptInBackground(QSharedPointer<BackgroundUrlRequestInterceptor> interceptor,
+                                                RequestInfoPtr info);
+    void ContinueAfterBackgroundIntercept(RequestInfoPtr info);
     void InterceptOnUIThread();
     void ContinueAfterIntercept();
+    bool ApplyUrlRequestRules(const QWebEngineUrlRequestRuleMatcher &matcher);
+    void RedirectTo(const GURL &url);
 
     // This is called when the original URLLoaderClient has a connection error.
     void OnURLLoaderClientError();
@@ -159,6 +171,7 @@ private:
     void SendErrorAndCompleteImmediately(int error_code);
 
     content::WebContents* webContents();
+    GURL firstPartyUrl();
     QWebEngineUrlRequestInterceptor* getProfileInterceptor();
     QWebEngineUrlRequestInterceptor* getPageInterceptor();
 
@@ -257,6 +270,15 @@ content::WebContents* InterceptedRequest::webContents()
     return content::WebContents::FromFrameTreeNodeId(request_.render_frame_id);
 }
 
+GURL InterceptedRequest::firstPartyUrl()
+{
+    auto wc = webContents();
+    GURL top_document_url = wc ? wc->GetVisibleURL() : GURL();
+    if (!top_document_url.is_empty())
+        return top_document_url;
+    return request_.site_for_cookies.first_party_url(); // m_topDocumentUrl can be empty for the main-frame.
+}
+
 QWebEngineUrlRequestInterceptor* InterceptedRequest::getProfileInterceptor()
 {
     return profile_adapter_ ? profile_adapter_->requestInterceptor() : nullptr;
@@ -284,11 +306,19 @@ void InterceptedRequest::Restart()
         return;
     }
 
+    // The declarative rules are matched before any interceptor, and requests
+    // they block or redirect never reach application code.
+    if (auto matcher = profile_adapter_ ? profile_adapter_->urlRequestRuleMatcher() : nullptr) {
+        if (ApplyUrlRequestRules(*matcher))
+            return;
+    }
+
     // MEMO since all codepatch leading to Restart scheduled and executed as asynchronous tasks in main thread,
     //      interceptors may change in meantime and also during intercept call, so they should be resolved anew.
     //      Set here only profile's interceptor since it runs first without going to user code.
+    auto backgroundInterceptor = profile_adapter_ ? profile_adapter_->backgroundRequestInterceptor() : nullptr;
     auto profileInterceptor = getProfileInterceptor();
-    if (!profileInterceptor && !getPageInterceptor()) {
+    if (!backgroundInterceptor && !profileInterceptor && !getPageInterceptor()) {
         ContinueAfterIntercept();
         return;
     }
@@ -298,23 +328,51 @@ void InterceptedRequest::Restart()
     const QUrl originalUrl = toQt(request_.url);
     const QUrl initiator = request_.request_initiator.has_value() ? toQt(request_.request_initiator->GetURL()) : QUrl();
 
-    auto wc = webContents();
-    GURL top_document_url = wc ? wc->GetVisibleURL() : GURL();
-    QUrl firstPartyUrl;
-    if (!top_document_url.is_empty())
-        firstPartyUrl = toQt(top_document_url);
-    else
-        firstPartyUrl = toQt(request_.site_for_cookies.first_party_url()); // m_topDocumentUrl can be empty for the main-frame.
+    const QUrl firstPartyUrl = toQt(this->firstPartyUrl());
 
     auto info = new QWebEngineUrlRequestInfoPrivate(resourceType, navigationType, originalUrl, firstPartyUrl,
                                                     initiator, QByteArray::fromStdString(request_.method));
     Q_ASSERT(!request_info_);
     request_info_.reset(new QWebEngineUrlRequestInfo(info));
 
+    if (backgroundInterceptor) {
+        // The request info is a self-contained snapshot, its ownership moves
+        // to the interceptor's sequence and back.
+        auto taskRunner = backgroundInterceptor->taskRunner();
+        base::PostTaskAndReplyWithResult(
+                taskRunner, FROM_HERE,
+                base::BindOnce(&InterceptedRequest::InterceptInBackground, std::move(backgroundInterceptor),
+                               RequestInfoPtr(request_info_.take())),
+                base::BindOnce(&InterceptedRequest::ContinueAfterBackgroundIntercept, weak_factory_.GetWeakPtr()));
+        return;
+    }
+
     InterceptOnUIThread();
     ContinueAfterIntercept();
 }
 
+// static
+InterceptedRequest::RequestInfoPtr
+InterceptedRequest::InterceptInBackground(QSharedPointer<BackgroundUrlRequestInterceptor> interceptor,
+                                          RequestInfoPtr info)
+{
+    interceptor->interceptRequest(*info);
+    return info;
+}
+
+void InterceptedRequest::ContinueAfterBackgroundIntercept(RequestInfoPtr info)
+{
+    DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+    Q_ASSERT(!request_info_);
+    request_info_.reset(info.release());
+
+    // Like the page interceptor after the profile one, the UI thread
+    // interceptors only see requests left unchanged in the background.
+    if (!request_info_->changed())
+        InterceptOnUIThread();
+    ContinueAfterIntercept();
+}
+
 void InterceptedRequest::InterceptOnUIThread()
 {
     DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
@@ -349,28 +407,8 @@ void InterceptedRequest::ContinueAfterIntercept()
                 }
             }
 
-            if (info.shouldRedirectRequest) {
-                net::RedirectInfo::FirstPartyURLPolicy first_party_url_policy =
-                        request_.update_first_party_url_on_redirect ? net::RedirectInfo::FirstPartyURLPolicy::UPDATE_URL_ON_REDIRECT
-                                                                    : net::RedirectInfo::FirstPartyURLPolicy::NEVER_CHANGE_URL;
-                net::RedirectInfo redirectInfo = net::RedirectInfo::ComputeRedirectInfo(
-                        request_.method, request_.url, request_.site_for_cookies,
-                        first_party_url_policy, request_.referrer_policy, request_.referrer.spec(),
-                        net::HTTP_TEMPORARY_REDIRECT, toGurl(info.url), base::nullopt,
-                        false /*insecure_scheme_was_upgraded*/);
-
-                // FIXME: Should probably create a new header.
-                current_response_->encoded_data_length = 0;
-                request_.method = redirectInfo.new_method;
-                request_.url = redirectInfo.new_url;
-                request_.site_for_cookies = redirectInfo.new_site_for_cookies;
-                request_.referrer = GURL(redirectInfo.new_referrer);
-                request_.referrer_policy = redirectInfo.new_referrer_policy;
-                if (request_.method == net::HttpRequestHeaders::kGetMethod)
-                    request_.request_body = nullptr;
-                target_client_->OnReceiveRedirect(redirectInfo, std::move(current_response_));
-                return;
-            }
+            if (info.shouldRedirectRequest)
+                return RedirectTo(toGurl(info.url));
         }
     }
 
@@ -381,6 +419,63 @@ void InterceptedRequest::ContinueAfterIntercept()
     }
 }
 
+// Returns true if the request was blocked or redirected.
+bool InterceptedRequest::ApplyUrlRequestRules(const QWebEngineUrlRequestRuleMatcher &matcher)
+{
+    const std::string &spec = request_.url.possibly_invalid_spec();
+    const GURL first_party_url = firstPartyUrl();
+    const base::StringPiece first_party_host = first_party_url.host_piece();
+    const QWebEngineUrlRequestRuleMatcher::Result result =
+            matcher.match(QByteArrayView(spec.data(), qsizetype(spec.size())),
+                          QByteArrayView(first_party_host.data(), qsizetype(first_party_host.size())),
+                          toQt(blink::mojom::ResourceType(request_.resource_type)));
+
+    if (result.block) {
+        SendErrorAndCompleteImmediately(net::ERR_BLOCKED_BY_CLIENT);
+        return true;
+    }
+
+    for (const auto &header : result.httpHeaders) {
+        if (base::LowerCaseEqualsASCII(header.first.toStdString(), "referer"))
+            request_.referrer = GURL(header.second.toStdString());
+        else
+            request_.headers.SetHeader(header.first.toStdString(), header.second.toStdString());
+    }
+
+    if (result.redirectUrl.isValid()) {
+        const GURL redirect_url = toGurl(result.redirectUrl);
+        // Redirecting to the same URL would only loop through the rules again.
+        if (redirect_url != request_.url) {
+            RedirectTo(redirect_url);
+            return true;
+        }
+    }
+    return false;
+}
+
+void InterceptedRequest::RedirectTo(const GURL &url)
+{
+    net::RedirectInfo::FirstPartyURLPolicy first_party_url_policy =
+            request_.update_first_party_url_on_redirect ? net::RedirectInfo::FirstPartyURLPolicy::UPDATE_URL_ON_REDIRECT
+                                                        : net::RedirectInfo::FirstPartyURLPolicy::NEVER_CHANGE_URL;
+    net::RedirectInfo redirectInfo = net::RedirectInfo::ComputeRedirectInfo(
+            request_.method, request_.url, request_.site_for_cookies,
+            first_party_url_policy, request_.referrer_policy, request_.referrer.spec(),
+            net::HTTP_TEMPORARY_REDIRECT, url, base::nullopt,
+            false /*insecure_scheme_was_upgraded*/);
+
+    // FIXME: Should probably create a new header.
+    current_response_->encoded_data_length = 0;
+    request_.method = redirectInfo.new_method;
+    request_.url = redirectInfo.new_url;
+    request_.site_for_cookies = redirectInfo.new_site_for_cookies;
+    request_.referrer = GURL(redirectInfo.new_referrer);
+    request_.referrer_policy = redirectInfo.new_referrer_policy;
+    if (request_.method == net::HttpRequestHeaders::kGetMethod)
+        request_.request_body = nullptr;
+    target_client_->OnReceiveRedirect(redirectInfo, std::move(current_response_));
+}
+
 // URLLoaderClient methods.
 
 void InterceptedRequest::OnReceiveResponse(network::mojom::URLResponseHeadPtr head)
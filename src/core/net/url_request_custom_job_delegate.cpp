@@ -97,6 +97,13 @@ void URLRequestCustomJobDelegate::reply(const QByteArray &contentType, QIODevice
                                                      m_proxy, contentType.toStdString(),device));
 }
 
+void URLRequestCustomJobDelegate::reply(const QByteArray &contentType, const QByteArray &data)
+{
+    m_proxy->m_ioTaskRunner->PostTask(FROM_HERE,
+                                      base::BindOnce(&URLRequestCustomJobProxy::replyData,
+                                                     m_proxy, contentType.toStdString(), data));
+}
+
 void URLRequestCustomJobDelegate::slotReadyRead()
 {
     m_proxy->m_ioTaskRunner->PostTask(FROM_HERE,
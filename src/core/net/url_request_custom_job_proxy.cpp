@@ -48,6 +48,8 @@
 #include "type_conversion.h"
 #include "web_engine_context.h"
 
+#include <QtCore/QFile>
+
 namespace QtWebEngineCore {
 
 URLRequestCustomJobProxy::URLRequestCustomJobProxy(URLRequestCustomJobProxy::Client *client,
@@ -86,11 +88,51 @@ void URLRequestCustomJobProxy::setReplyCharset(const std::string &charset)
     m_job->m_charset = charset;
 }
 */
+// Maps the file behind device, if any, so it can be written to the data pipe
+// straight from memory. The file is opened again: the mapping must not
+// depend on the lifetime of the device, which belongs to the application.
+// Like reading the device would, the data starts at its current position.
+static std::shared_ptr<QFile> mapFile(QIODevice *device, QByteArray *data)
+{
+    QFile *file = qobject_cast<QFile *>(device);
+    if (!file || file->fileName().isEmpty())
+        return nullptr;
+    // Text mode translates line endings on read, which a mapping cannot do.
+    if (file->openMode() & QIODevice::Text)
+        return nullptr;
+    auto mappedFile = std::make_shared<QFile>(file->fileName());
+    if (!mappedFile->open(QIODevice::ReadOnly) || mappedFile->size() <= 0)
+        return nullptr;
+    if (file->isOpen() && file->size() != mappedFile->size())
+        return nullptr;
+    const qint64 offset = file->isOpen() ? file->pos() : 0;
+    if (offset < 0 || offset >= mappedFile->size())
+        return nullptr;
+    const qint64 size = mappedFile->size() - offset;
+    const uchar *map = mappedFile->map(offset, size);
+    if (!map)
+        return nullptr;
+    *data = QByteArray::fromRawData(reinterpret_cast<const char *>(map), size);
+    return mappedFile;
+}
+
 void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
 {
     if (!m_client)
         return;
     DCHECK (!m_ioTaskRunner || m_ioTaskRunner->RunsTasksInCurrentSequence());
+
+    QByteArray mappedData;
+    if (std::shared_ptr<QFile> mappedFile = mapFile(device, &mappedData)) {
+        // The device is not read from, so release its file handle now rather
+        // than when the request completes, like the streaming path does.
+        if (device->isOpen())
+            device->close();
+        m_client->m_mappedFile = std::move(mappedFile);
+        replyData(std::move(mimeType), std::move(mappedData));
+        return;
+    }
+
     m_client->m_mimeType = mimeType;
     m_client->m_device = device;
     if (m_client->m_device && !m_client->m_device->isReadable())
@@ -102,6 +144,9 @@ void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
     qint64 deviceSize = m_client->m_device ? m_client->m_device->size() : -1;
     if (deviceSize > 0)
         m_client->notifyExpectedContentSize(deviceSize);
+    // An unsatisfiable range fails the request, which drops the client.
+    if (!m_client)
+        return;
 
     if (m_client->m_device && m_client->m_device->isReadable()) {
         m_started = true;
@@ -111,12 +156,31 @@ void URLRequestCustomJobProxy::reply(std::string mimeType, QIODevice *device)
     }
 }
 
+void URLRequestCustomJobProxy::replyData(std::string mimeType, QByteArray data)
+{
+    if (!m_client)
+        return;
+    DCHECK (!m_ioTaskRunner || m_ioTaskRunner->RunsTasksInCurrentSequence());
+    m_client->m_mimeType = mimeType;
+    m_client->m_data = std::move(data);
+    m_client->m_hasData = true;
+
+    if (m_client->m_data.size() > 0)
+        m_client->notifyExpectedContentSize(m_client->m_data.size());
+    // An unsatisfiable range fails the request, which drops the client.
+    if (!m_client)
+        return;
+
+    m_started = true;
+    m_client->notifyHeadersComplete();
+}
+
 void URLRequestCustomJobProxy::redirect(GURL url)
 {
     if (!m_client)
         return;
     DCHECK (!m_ioTaskRunner || m_ioTaskRunner->RunsTasksInCurrentSequence());
-    if (m_client->m_device || m_client->m_error)
+    if (m_client->m_device || m_client->m_hasData || m_client->m_error)
         return;
     m_client->m_redirect = url;
     m_started = true;
@@ -45,8 +45,12 @@
 #include "base/sequenced_task_runner.h"
 #include "url/gurl.h"
 #include "url/origin.h"
+#include <QtCore/QByteArray>
 #include <QtCore/QPointer>
 
+#include <memory>
+
+QT_FORWARD_DECLARE_CLASS(QFile)
 QT_FORWARD_DECLARE_CLASS(QIODevice)
 
 namespace QtWebEngineCore {
@@ -67,6 +71,12 @@ public:
         std::string m_charset;
         GURL m_redirect;
         QIODevice *m_device;
+        // Used instead of m_device for replies that don't need the UI
+        // thread anymore; streamed from a background sequence.
+        QByteArray m_data;
+        bool m_hasData = false;
+        // Owns the mapping m_data points into when replying with a file.
+        std::shared_ptr<QFile> m_mappedFile;
         int64_t m_firstBytePosition;
         int m_error;
         virtual void notifyExpectedContentSize(qint64 size) = 0;
@@ -86,6 +96,7 @@ public:
     // Called from URLRequestCustomJobDelegate via post:
     //void setReplyCharset(const std::string &);
     void reply(std::string mimeType, QIODevice *device);
+    void replyData(std::string mimeType, QByteArray data);
     void redirect(GURL url);
     void abort();
     void fail(int error);
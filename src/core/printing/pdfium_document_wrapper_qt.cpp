@@ -73,12 +73,14 @@ QImage PdfiumDocumentWrapperQt::pageAsQImage(size_t pageIndex,int width , int he
     }
 
     FPDF_PAGE pageData(FPDF_LoadPage((FPDF_DOCUMENT)m_documentHandle, pageIndex));
-    QImage image(width, height, QImage::Format_ARGB32);
+    // Pages are printed on white, an opaque image saves the paint devices
+    // from scanning for and encoding an alpha channel.
+    QImage image(width, height, QImage::Format_RGB32);
     Q_ASSERT(!image.isNull());
     image.fill(0xFFFFFFFF);
 
     FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(width, height,
-                                             FPDFBitmap_BGRA,
+                                             FPDFBitmap_BGRx,
                                              image.scanLine(0), image.bytesPerLine());
     Q_ASSERT(bitmap);
     FPDF_RenderPageBitmap(bitmap, pageData,
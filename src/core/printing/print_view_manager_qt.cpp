@@ -53,8 +53,11 @@
 #include <QtGui/qpageranges.h>
 #include <QtGui/qpagesize.h>
 
+#include <limits>
+
 #include "base/values.h"
-#include "base/memory/ref_counted_memory.h"
+#include "base/files/file.h"
+#include "base/memory/read_only_shared_memory_region.h"
 #include "base/task/post_task.h"
 #include "chrome/browser/printing/print_job_manager.h"
 #include "chrome/browser/printing/printer_query.h"
@@ -64,7 +67,6 @@
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_frame_host.h"
-#include "printing/metafile_skia.h"
 #include "printing/print_job_constants.h"
 #include "printing/units.h"
 #include "third_party/blink/public/common/associated_interfaces/associated_interface_provider.h"
@@ -73,41 +75,34 @@ namespace {
 
 static const qreal kMicronsToMillimeter = 1000.0f;
 
-static QSharedPointer<QByteArray> GetStdVectorFromHandle(const base::ReadOnlySharedMemoryRegion &handle)
+// Wraps the mapped PDF data without copying it. The mapping lives as long as
+// the returned pointer, so the byte array itself must not be copied beyond
+// that: it doesn't own its data.
+static QSharedPointer<QByteArray> GetMappedDataFromHandle(const base::ReadOnlySharedMemoryRegion &handle)
 {
-    base::ReadOnlySharedMemoryMapping map = handle.Map();
-    if (!map.IsValid())
+    auto mapping = std::make_unique<base::ReadOnlySharedMemoryMapping>(handle.Map());
+    if (!mapping->IsValid())
         return QSharedPointer<QByteArray>(new QByteArray);
 
-    const char* data = static_cast<const char*>(map.memory());
-    return QSharedPointer<QByteArray>(new QByteArray(data, map.size()));
-}
-
-static scoped_refptr<base::RefCountedBytes>
-GetBytesFromHandle(const base::ReadOnlySharedMemoryRegion &handle)
-{
-    base::ReadOnlySharedMemoryMapping map = handle.Map();
-    if (!map.IsValid())
-        return nullptr;
-
-    const unsigned char* data = static_cast<const unsigned char*>(map.memory());
-    std::vector<unsigned char> dataVector(data, data + map.size());
-    return base::RefCountedBytes::TakeVector(&dataVector);
+    QByteArray *data = new QByteArray(QByteArray::fromRawData(static_cast<const char *>(mapping->memory()),
+                                                              mapping->size()));
+    return QSharedPointer<QByteArray>(data, [mapping = mapping.release()](QByteArray *data) {
+        delete data;
+        delete mapping;
+    });
 }
 
 // Write the PDF file to disk.
-static void SavePdfFile(scoped_refptr<base::RefCountedBytes> data,
+static void SavePdfFile(QSharedPointer<QByteArray> data,
                         const base::FilePath &path,
                         const QtWebEngineCore::PrintViewManagerQt::PrintToPDFFileCallback &saveCallback)
 {
-    DCHECK_GT(data->size(), 0U);
-
-    printing::MetafileSkia metafile;
-    metafile.InitFromData(base::as_bytes(base::make_span(data->front(), data->size())));
+    DCHECK_GT(data->size(), 0);
 
     base::File file(path,
                     base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
-    bool success = file.IsValid() && metafile.SaveTo(&file);
+    bool success = file.IsValid() && data->size() <= std::numeric_limits<int>::max()
+            && file.WriteAtCurrentPos(data->constData(), int(data->size())) == data->size();
     base::PostTask(FROM_HERE, {content::BrowserThread::UI},
                    base::BindOnce(saveCallback, success));
 }
@@ -388,14 +383,13 @@ void PrintViewManagerQt::MetafileReadyForPrinting(printing::mojom::DidPreviewDoc
 
     resetPdfState();
 
+    QSharedPointer<QByteArray> data = GetMappedDataFromHandle(params->content->metafile_data_region);
     if (!pdf_print_callback.is_null()) {
-        QSharedPointer<QByteArray> data_array = GetStdVectorFromHandle(params->content->metafile_data_region);
         base::PostTask(FROM_HERE, {content::BrowserThread::UI},
-                       base::BindOnce(pdf_print_callback, data_array));
+                       base::BindOnce(pdf_print_callback, data));
     } else {
-        scoped_refptr<base::RefCountedBytes> data_bytes = GetBytesFromHandle(params->content->metafile_data_region);
         base::PostTask(FROM_HERE, {base::ThreadPool(), base::MayBlock()},
-                       base::BindOnce(&SavePdfFile, data_bytes, pdfOutputPath, pdf_save_callback));
+                       base::BindOnce(&SavePdfFile, data, pdfOutputPath, pdf_save_callback));
     }
 }
 
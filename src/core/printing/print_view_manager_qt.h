@@ -70,6 +70,8 @@ class PrintViewManagerQt
 {
 public:
     ~PrintViewManagerQt() override;
+    // The result maps the renderer's shared memory: it is only valid as long
+    // as the pointer, and must be deep-copied to be handed out as a QByteArray.
     typedef base::Callback<void(QSharedPointer<QByteArray> result)> PrintToPDFCallback;
     typedef base::Callback<void(bool success)> PrintToPDFFileCallback;
 
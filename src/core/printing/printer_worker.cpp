@@ -41,11 +41,99 @@
 
 #include "printing/pdfium_document_wrapper_qt.h"
 
+#include <QFile>
+#include <QMutex>
 #include <QPainter>
 #include <QPagedPaintDevice>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <algorithm>
+#include <deque>
 
 namespace QtWebEngineCore {
 
+namespace {
+
+struct PrintedPage
+{
+    int index;
+    QSize size;
+    bool landscape;
+};
+
+// Rasterizes the printed pages on its own thread, so that the next page is
+// being rendered while the previous one is painted, which for printers and
+// PDF files means compressed. PDFium must only be used from one thread, so
+// this is the only one using the document once it has started.
+class PageRasterizer
+{
+public:
+    PageRasterizer(PdfiumDocumentWrapperQt *document, QList<PrintedPage> pages, int passes)
+        : m_document(document), m_pages(std::move(pages)), m_passes(passes)
+    {
+        m_thread.reset(QThread::create([this]() { run(); }));
+        m_thread->start();
+    }
+
+    ~PageRasterizer()
+    {
+        {
+            const QMutexLocker locker(&m_mutex);
+            m_cancelled = true;
+            m_condition.wakeAll();
+        }
+        m_thread->wait();
+    }
+
+    // Returns the next page, in the order given and repeated for every pass.
+    QImage takeNext()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_ready.empty())
+            m_condition.wait(&m_mutex);
+        QImage image = std::move(m_ready.front());
+        m_ready.pop_front();
+        m_condition.wakeAll();
+        return image;
+    }
+
+private:
+    // At most this many pages wait to be painted, each of them can take
+    // hundreds of megabytes at printer resolution.
+    static constexpr size_t MaxReadyPages = 1;
+
+    void run()
+    {
+        for (int pass = 0; pass < m_passes; ++pass) {
+            for (const PrintedPage &page : qAsConst(m_pages)) {
+                {
+                    QMutexLocker locker(&m_mutex);
+                    while (!m_cancelled && m_ready.size() >= MaxReadyPages)
+                        m_condition.wait(&m_mutex);
+                    if (m_cancelled)
+                        return;
+                }
+                QImage image = m_document->pageAsQImage(page.index, page.size.width(), page.size.height());
+                const QMutexLocker locker(&m_mutex);
+                m_ready.push_back(std::move(image));
+                m_condition.wakeAll();
+            }
+        }
+    }
+
+    PdfiumDocumentWrapperQt *m_document;
+    const QList<PrintedPage> m_pages;
+    const int m_passes;
+    QScopedPointer<QThread> m_thread;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::deque<QImage> m_ready;
+    bool m_cancelled = false;
+};
+
+} // namespace
+
 PrinterWorker::PrinterWorker(QSharedPointer<QByteArray> data, QPagedPaintDevice *device)
     : m_data(data), m_device(device)
 {
@@ -62,23 +150,19 @@ void PrinterWorker::print()
     }
 
     PdfiumDocumentWrapperQt pdfiumWrapper(m_data->constData(), m_data->size());
-
-    const QPageRanges ranges = m_device->pageRanges();
-    int toPage = ranges.firstPage();
-    int fromPage = ranges.lastPage();
-    bool ascendingOrder = true;
-
-    if (fromPage == 0 && toPage == 0) {
-        fromPage = 1;
-        toPage = pdfiumWrapper.pageCount();
-    }
-    fromPage = qMax(1, fromPage);
-    toPage = qMin(pdfiumWrapper.pageCount(), toPage);
-
-    if (!m_firstPageFirst) {
-        qSwap(fromPage, toPage);
-        ascendingOrder = false;
+    const int pageCount = pdfiumWrapper.pageCount();
+
+    // Chromium has already left out the pages outside of the device's page ranges.
+    QList<int> pageNumbers;
+    for (int page = 1; page <= pageCount; ++page)
+        pageNumbers.append(page);
+    if (pageNumbers.isEmpty()) {
+        qWarning("Failed to print: Print result has no pages.");
+        Q_EMIT resultReady(false);
+        return;
     }
+    if (!m_firstPageFirst)
+        std::reverse(pageNumbers.begin(), pageNumbers.end());
 
     int pageCopies = 1;
     if (m_collateCopies) {
@@ -86,23 +170,40 @@ void PrinterWorker::print()
         m_documentCopies = 1;
     }
 
+    // Chromium generated the document for this page layout already, so a PDF
+    // file can get it without painting it again.
+    if (!m_pdfFileName.isEmpty() && m_firstPageFirst && pageCopies == 1 && m_documentCopies == 1) {
+        QFile file(m_pdfFileName);
+        const bool written = file.open(QIODevice::WriteOnly)
+                && file.write(*m_data) == m_data->size();
+        if (!written)
+            qWarning("Failure to print to %s: %s", qPrintable(m_pdfFileName), qPrintable(file.errorString()));
+        Q_EMIT resultReady(written);
+        return;
+    }
+
     qreal resolution = m_deviceResolution / 72.0; // pdfium uses points so 1/72 inch
+    // The page size doesn't depend on the orientation.
+    const QRectF pageRect = m_device->pageLayout().pageSize().rectPixels(m_deviceResolution);
+
+    QList<PrintedPage> pages;
+    for (int pageNumber : qAsConst(pageNumbers)) {
+        QSizeF documentSize = (pdfiumWrapper.pageSize(pageNumber - 1) * resolution);
+        const bool isLandscape = documentSize.width() > documentSize.height();
+        documentSize = documentSize.scaled(pageRect.size(), Qt::KeepAspectRatio);
+        pages.append({ pageNumber - 1, documentSize.toSize(), isLandscape });
+    }
 
+    PageRasterizer rasterizer(&pdfiumWrapper, pages, m_documentCopies);
     QPainter painter;
 
     for (int printedDocuments = 0; printedDocuments < m_documentCopies; printedDocuments++) {
         if (printedDocuments > 0)
             m_device->newPage();
 
-        int currentPageIndex = fromPage;
-
-        for (int i = 0; true; i++) {
-            QSizeF documentSize = (pdfiumWrapper.pageSize(currentPageIndex - 1) * resolution);
-            bool isLandscape = documentSize.width() > documentSize.height();
-            m_device->setPageOrientation(isLandscape ? QPageLayout::Landscape
-                                                      : QPageLayout::Portrait);
-            QRectF pageRect = m_device->pageLayout().pageSize().rectPixels(m_deviceResolution);
-            documentSize = documentSize.scaled(pageRect.size(), Qt::KeepAspectRatio);
+        for (int i = 0; i < pages.count(); i++) {
+            m_device->setPageOrientation(pages.at(i).landscape ? QPageLayout::Landscape
+                                                               : QPageLayout::Portrait);
 
             // setPageOrientation has to be called before qpainter.begin() or before
             // qprinter.newPage() so correct metrics is used, therefore call begin now for only
@@ -116,26 +217,17 @@ void PrinterWorker::print()
             if (i > 0)
                 m_device->newPage();
 
+            // Collated copies of a page are painted from the same image.
+            const QImage currentImage = rasterizer.takeNext();
+            if (currentImage.isNull()) {
+                Q_EMIT resultReady(false);
+                return;
+            }
             for (int printedPages = 0; printedPages < pageCopies; printedPages++) {
                 if (printedPages > 0)
                     m_device->newPage();
-
-                QImage currentImage = pdfiumWrapper.pageAsQImage(
-                        currentPageIndex - 1, documentSize.width(), documentSize.height());
-                if (currentImage.isNull()) {
-                    Q_EMIT resultReady(false);
-                    return;
-                }
                 painter.drawImage(0, 0, currentImage);
             }
-
-            if (currentPageIndex == toPage)
-                break;
-
-            if (ascendingOrder)
-                currentPageIndex++;
-            else
-                currentPageIndex--;
         }
     }
     painter.end();
@@ -72,6 +72,9 @@ public:
     bool m_firstPageFirst;
     int m_documentCopies;
     bool m_collateCopies;
+    // Set when the device writes a plain PDF file, which then gets the
+    // document as it is, if the whole of it is printed once.
+    QString m_pdfFileName;
 
 public Q_SLOTS:
     void print();
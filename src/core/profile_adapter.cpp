@@ -53,10 +53,12 @@
 #include "services/network/public/cpp/cors/origin_access_list.h"
 #include "url/url_util.h"
 
+#include "api/qwebengineurlrequestrule_p.h"
 #include "api/qwebengineurlscheme.h"
 #include "content_browser_client_qt.h"
 #include "download_manager_delegate_qt.h"
 #include "favicon_service_factory_qt.h"
+#include "net/background_url_request_interceptor.h"
 #include "permission_manager_qt.h"
 #include "profile_adapter_client.h"
 #include "profile_io_data_qt.h"
@@ -118,6 +120,7 @@ ProfileAdapter::ProfileAdapter(const QString &storageName):
 ProfileAdapter::~ProfileAdapter()
 {
     m_cancelableTaskTracker->TryCancelAll();
+    setBackgroundRequestInterceptor(nullptr);
     content::BrowserContext::NotifyWillBeDestroyed(m_profile.data());
     while (!m_webContentsAdapterClients.isEmpty()) {
        m_webContentsAdapterClients.first()->releaseProfile();
@@ -206,6 +209,32 @@ void ProfileAdapter::setRequestInterceptor(QWebEngineUrlRequestInterceptor *inte
     m_requestInterceptor = interceptor;
 }
 
+QSharedPointer<BackgroundUrlRequestInterceptor> ProfileAdapter::backgroundRequestInterceptor() const
+{
+    return m_backgroundRequestInterceptor;
+}
+
+void ProfileAdapter::setBackgroundRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor)
+{
+    // Requests already posted to the old interceptor's sequence keep its
+    // runner alive, but no longer reach the interceptor.
+    if (m_backgroundRequestInterceptor)
+        m_backgroundRequestInterceptor->reset();
+    m_backgroundRequestInterceptor.reset(interceptor ? new BackgroundUrlRequestInterceptor(interceptor) : nullptr);
+}
+
+void ProfileAdapter::setUrlRequestRules(const QList<QWebEngineUrlRequestRule> &rules)
+{
+    m_urlRequestRules = rules;
+    // Requests in flight keep matching against the matcher they started with.
+    m_urlRequestRuleMatcher.reset(rules.isEmpty() ? nullptr : new QWebEngineUrlRequestRuleMatcher(rules));
+}
+
+QSharedPointer<const QWebEngineUrlRequestRuleMatcher> ProfileAdapter::urlRequestRuleMatcher() const
+{
+    return m_urlRequestRuleMatcher;
+}
+
 void ProfileAdapter::addClient(ProfileAdapterClient *adapterClient)
 {
     m_clients.append(adapterClient);
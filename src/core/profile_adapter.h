@@ -62,10 +62,12 @@
 #include <QtWebEngineCore/qwebengineclientcertificatestore.h>
 #include <QtWebEngineCore/qwebenginecookiestore.h>
 #include <QtWebEngineCore/qwebengineurlrequestinterceptor.h>
+#include <QtWebEngineCore/qwebengineurlrequestrule.h>
 #include <QtWebEngineCore/qwebengineurlschemehandler.h>
 #include "net/qrc_url_scheme_handler.h"
 
 QT_FORWARD_DECLARE_CLASS(QObject)
+QT_FORWARD_DECLARE_CLASS(QWebEngineUrlRequestRuleMatcher)
 
 namespace base {
 class CancelableTaskTracker;
@@ -73,6 +75,7 @@ class CancelableTaskTracker;
 
 namespace QtWebEngineCore {
 
+class BackgroundUrlRequestInterceptor;
 class UserNotificationController;
 class DownloadManagerDelegateQt;
 class ProfileAdapterClient;
@@ -98,6 +101,11 @@ public:
 
     QWebEngineUrlRequestInterceptor* requestInterceptor();
     void setRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+    QSharedPointer<BackgroundUrlRequestInterceptor> backgroundRequestInterceptor() const;
+    void setBackgroundRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor);
+    QList<QWebEngineUrlRequestRule> urlRequestRules() const { return m_urlRequestRules; }
+    void setUrlRequestRules(const QList<QWebEngineUrlRequestRule> &rules);
+    QSharedPointer<const QWebEngineUrlRequestRuleMatcher> urlRequestRuleMatcher() const;
 
     QList<ProfileAdapterClient*> clients() { return m_clients; }
     void addClient(ProfileAdapterClient *adapterClient);
@@ -239,6 +247,9 @@ private:
     QWebEngineClientCertificateStore *m_clientCertificateStore = nullptr;
 #endif
     QPointer<QWebEngineUrlRequestInterceptor> m_requestInterceptor;
+    QSharedPointer<BackgroundUrlRequestInterceptor> m_backgroundRequestInterceptor;
+    QList<QWebEngineUrlRequestRule> m_urlRequestRules;
+    QSharedPointer<const QWebEngineUrlRequestRuleMatcher> m_urlRequestRuleMatcher;
 
     QString m_dataPath;
     QString m_downloadPath;
@@ -48,8 +48,10 @@
 #include "type_conversion.h"
 #include "web_contents_adapter.h"
 #include "web_contents_adapter_client.h"
+#include "web_engine_context.h"
 #include "web_event_factory.h"
 
+#include "base/callback_helpers.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "components/viz/common/features.h"
 #include "components/viz/common/frame_sinks/begin_frame_source.h"
@@ -216,7 +218,9 @@ RenderWidgetHostViewQt::RenderWidgetHostViewQt(content::RenderWidgetHost *widget
                                  contextFactory->AllocateFrameSinkId(),
                                  contextFactory,
                                  m_taskRunner,
-                                 false /* enable_pixel_canvas */));
+                                 false /* enable_pixel_canvas */,
+                                 WebEngineContext::isHeadlessCompositing() /* use_external_begin_frame_control */,
+                                 WebEngineContext::isHeadlessCompositing() /* force_software_compositor */));
     m_uiCompositor->SetAcceleratedWidget(gfx::kNullAcceleratedWidget); // null means offscreen
     m_uiCompositor->SetRootLayer(m_rootLayer.get());
 
@@ -824,6 +828,40 @@ Compositor::Id RenderWidgetHostViewQt::compositorId()
     return m_uiCompositor->frame_sink_id();
 }
 
+// Draws exactly one frame in headless mode and passes it to the callback.
+// The frame is also announced to the compositor's observer, if any, with
+// readyToSwap().
+void RenderWidgetHostViewQt::produceFrame(std::function<void(const QImage &)> callback)
+{
+    Q_ASSERT(WebEngineContext::isHeadlessCompositing());
+    const base::TimeTicks now = base::TimeTicks::Now();
+    const base::TimeDelta interval = viz::BeginFrameArgs::DefaultInterval();
+    viz::BeginFrameArgs args = viz::BeginFrameArgs::Create(
+            BEGINFRAME_FROM_HERE, viz::BeginFrameArgs::kManualSourceId, m_beginFrameSequenceNumber++,
+            now, now + interval, interval, viz::BeginFrameArgs::NORMAL);
+    m_uiCompositor->IssueExternalBeginFrame(
+            args, true /* force */,
+            base::BindOnce([](base::WeakPtr<RenderWidgetHostViewQt> rwhv,
+                              std::function<void(const QImage &)> callback,
+                              const viz::BeginFrameAck &) {
+                               if (rwhv)
+                                   rwhv->frameProduced(std::move(callback));
+                               else
+                                   callback(QImage());
+                           },
+                           m_weakPtrFactory.GetWeakPtr(), std::move(callback)));
+}
+
+// The display has finished the frame. If it drew anything, the headless
+// compositor has already swapped it in.
+void RenderWidgetHostViewQt::frameProduced(std::function<void(const QImage &)> callback)
+{
+    QImage image;
+    if (auto comp = Compositor::find(compositorId()))
+        image = comp->image();
+    callback(image);
+}
+
 void RenderWidgetHostViewQt::notifyShown()
 {
     // Handle possible frame eviction:
@@ -45,6 +45,7 @@
 #include "render_widget_host_view_qt_delegate.h"
 
 #include "base/memory/weak_ptr.h"
+#include "components/viz/common/frame_sinks/begin_frame_args.h"
 #include "components/viz/common/resources/transferable_resource.h"
 #include "components/viz/common/surfaces/parent_local_surface_id_allocator.h"
 #include "components/viz/host/host_frame_sink_client.h"
@@ -189,6 +190,7 @@ public:
     void resetInputManagerState() { m_imState = 0; }
 
     // Called from WebContentsAdapter.
+    void produceFrame(std::function<void(const QImage &)> callback);
     gfx::SizeF lastContentsSize() const { return m_lastContentsSize; }
     gfx::Vector2dF lastScrollOffset() const { return m_lastScrollOffset; }
 
@@ -207,6 +209,7 @@ private:
     bool isPopup() const;
 
     bool updateCursorFromResource(ui::mojom::CursorType type);
+    void frameProduced(std::function<void(const QImage &)> callback);
 
     scoped_refptr<base::SingleThreadTaskRunner> m_taskRunner;
 
@@ -236,6 +239,7 @@ private:
     std::unique_ptr<ui::Compositor> m_uiCompositor;
     viz::ParentLocalSurfaceIdAllocator m_dfhLocalSurfaceIdAllocator;
     viz::ParentLocalSurfaceIdAllocator m_uiCompositorLocalSurfaceIdAllocator;
+    uint64_t m_beginFrameSequenceNumber = viz::BeginFrameArgs::kStartingFrameNumber;
 
     // IME
     uint m_imState = 0;
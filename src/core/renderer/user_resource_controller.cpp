@@ -61,7 +61,9 @@
 
 #include <QRegularExpression>
 
+#include <algorithm>
 #include <bitset>
+#include <vector>
 
 namespace QtWebEngineCore {
 
@@ -75,62 +77,169 @@ static int validUserScriptSchemes()
     return URLPattern::SCHEME_HTTP | URLPattern::SCHEME_HTTPS | URLPattern::SCHEME_FILE | URLPattern::SCHEME_QRC;
 }
 
-static bool regexMatchesURL(const std::string &pat, const GURL &url)
+namespace {
+// A greasemonkey @include or @exclude rule, which is either a string with
+// wildcards or a regular expression between slashes.
+class IncludeRule
 {
-    QRegularExpression qre(QtWebEngineCore::toQt(pat));
-    qre.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
-    if (!qre.isValid())
-        return false;
-    return qre.match(QtWebEngineCore::toQt(url.spec())).hasMatch();
-}
+public:
+    explicit IncludeRule(const std::string &pattern)
+    {
+        if (pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/') {
+            m_regex.setPattern(QString::fromStdString(pattern.substr(1, pattern.size() - 2)));
+            m_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+            m_isRegex = true;
+            if (m_regex.isValid())
+                m_regex.optimize();
+        } else {
+            m_glob = pattern;
+        }
+    }
 
-static bool includeRuleMatchesURL(const std::string &pat, const GURL &url)
-{
-    // Match patterns for greasemonkey's @include and @exclude rules which can
-    // be either strings with wildcards or regular expressions.
-    if (pat.front() == '/' && pat.back() == '/') {
-        std::string re(++pat.cbegin(), --pat.cend());
-        if (regexMatchesURL(re, url))
-            return true;
-    } else if (base::MatchPattern(url.spec(), pat)) {
-        return true;
+    bool matches(const GURL &url, QString *qtSpec) const
+    {
+        if (!m_isRegex)
+            return base::MatchPattern(url.spec(), m_glob);
+        if (!m_regex.isValid())
+            return false;
+        if (qtSpec->isNull())
+            *qtSpec = QtWebEngineCore::toQt(url.spec());
+        return m_regex.match(*qtSpec).hasMatch();
     }
-    return false;
-}
 
-static bool scriptMatchesURL(const QtWebEngineCore::UserScriptData &scriptData, const GURL &url)
+private:
+    std::string m_glob;
+    QRegularExpression m_regex;
+    bool m_isRegex = false;
+};
+} // namespace
+
+// A user script with its URL patterns and globs parsed once, when it is added.
+class UserResourceController::CompiledUserScript
 {
-    // Logic taken from Chromium (extensions/common/user_script.cc)
-    bool matchFound;
-    if (!scriptData.urlPatterns.empty()) {
-        matchFound = false;
-        for (auto it = scriptData.urlPatterns.begin(), end = scriptData.urlPatterns.end(); it != end; ++it) {
+public:
+    CompiledUserScript(const QtWebEngineCore::UserScriptData &data, quint64 sequenceNumber)
+        : data(data), sequenceNumber(sequenceNumber)
+    {
+        matchesAnyHost = data.urlPatterns.empty();
+        for (const std::string &pattern : data.urlPatterns) {
             URLPattern urlPattern(validUserScriptSchemes());
-            if (urlPattern.Parse(*it) == URLPattern::ParseResult::kSuccess && urlPattern.MatchesURL(url))
-                matchFound = true;
+            if (urlPattern.Parse(pattern) != URLPattern::ParseResult::kSuccess)
+                continue;
+            // Patterns for subdomains are filed under the domain, and found
+            // by looking up every suffix of the frame's host.
+            if (urlPattern.match_all_urls() || (urlPattern.match_subdomains() && urlPattern.host().empty()))
+                matchesAnyHost = true;
+            else if (!hosts.contains(QByteArray::fromStdString(urlPattern.host())))
+                hosts.append(QByteArray::fromStdString(urlPattern.host()));
+            urlPatterns.push_back(std::move(urlPattern));
         }
-        if (!matchFound)
-            return false;
+        if (matchesAnyHost)
+            hosts.clear();
+        // A script whose patterns all failed to parse never runs.
+        neverMatches = !data.urlPatterns.empty() && urlPatterns.empty();
+
+        for (const std::string &glob : data.globs)
+            globs.emplace_back(glob);
+        for (const std::string &glob : data.excludeGlobs)
+            excludeGlobs.emplace_back(glob);
     }
 
-    if (!scriptData.globs.empty()) {
-        matchFound = false;
-        for (auto it = scriptData.globs.begin(), end = scriptData.globs.end(); it != end; ++it) {
-            if (includeRuleMatchesURL(*it, url))
-                matchFound = true;
+    bool matchesURL(const GURL &url) const
+    {
+        // Logic taken from Chromium (extensions/common/user_script.cc)
+        if (!urlPatterns.empty()) {
+            const bool matchFound = std::any_of(urlPatterns.cbegin(), urlPatterns.cend(),
+                                                [&url] (const URLPattern &pattern) { return pattern.MatchesURL(url); });
+            if (!matchFound)
+                return false;
+        }
+
+        QString qtSpec;
+        if (!globs.empty()) {
+            const bool matchFound = std::any_of(globs.cbegin(), globs.cend(),
+                                                [&] (const IncludeRule &glob) { return glob.matches(url, &qtSpec); });
+            if (!matchFound)
+                return false;
         }
-        if (!matchFound)
-            return false;
-    }
 
-    if (!scriptData.excludeGlobs.empty()) {
-        for (auto it = scriptData.excludeGlobs.begin(), end = scriptData.excludeGlobs.end(); it != end; ++it) {
-            if (includeRuleMatchesURL(*it, url))
+        for (const IncludeRule &glob : excludeGlobs) {
+            if (glob.matches(url, &qtSpec))
                 return false;
         }
+
+        return true;
+    }
+
+    const QtWebEngineCore::UserScriptData data;
+    const quint64 sequenceNumber;
+    std::vector<URLPattern> urlPatterns;
+    std::vector<IncludeRule> globs;
+    std::vector<IncludeRule> excludeGlobs;
+    QList<QByteArray> hosts;
+    bool matchesAnyHost = false;
+    bool neverMatches = false;
+};
+
+void UserResourceController::UserScriptSet::insert(const CompiledUserScriptPtr &script)
+{
+    if (script->neverMatches)
+        return;
+    const int p = script->data.injectionPoint;
+    DCHECK_LT(p, InjectionPointCount);
+    if (script->matchesAnyHost) {
+        anyHost[p].append(script);
+        return;
+    }
+    for (const QByteArray &host : script->hosts)
+        byHost[p][host].append(script);
+}
+
+void UserResourceController::UserScriptSet::remove(const CompiledUserScriptPtr &script)
+{
+    const int p = script->data.injectionPoint;
+    DCHECK_LT(p, InjectionPointCount);
+    anyHost[p].removeOne(script);
+    for (const QByteArray &host : script->hosts) {
+        auto it = byHost[p].find(host);
+        if (it == byHost[p].end())
+            continue;
+        it->removeOne(script);
+        if (it->isEmpty())
+            byHost[p].erase(it);
+    }
+}
+
+void UserResourceController::UserScriptSet::collect(QtWebEngineCore::UserScriptData::InjectionPoint p,
+                                                    const std::string &host, CandidateList *candidates) const
+{
+    DCHECK_LT(int(p), InjectionPointCount);
+    const qsizetype first = candidates->size();
+    for (const CompiledUserScriptPtr &script : anyHost[p])
+        candidates->append(script.data());
+
+    if (!byHost[p].isEmpty()) {
+        // Look up the host and each of its parent domains.
+        for (size_t offset = 0;;) {
+            const auto it = byHost[p].constFind(
+                    QByteArray::fromRawData(host.data() + offset, int(host.size() - offset)));
+            if (it != byHost[p].constEnd()) {
+                for (const CompiledUserScriptPtr &script : *it)
+                    candidates->append(script.data());
+            }
+            offset = host.find('.', offset);
+            if (offset == std::string::npos)
+                break;
+            ++offset;
+        }
     }
 
-    return true;
+    // Run in the order the scripts were added, once each.
+    auto begin = candidates->begin() + first;
+    std::sort(begin, candidates->end(), [] (const CompiledUserScript *a, const CompiledUserScript *b) {
+        return a->sequenceNumber < b->sequenceNumber;
+    });
+    candidates->erase(std::unique(begin, candidates->end()), candidates->end());
 }
 
 // using UserScriptDataPtr = mojo::StructPtr<qtwebengine::mojom::UserScriptData>;
@@ -195,15 +304,21 @@ void UserResourceController::runScripts(QtWebEngineCore::UserScriptData::Injecti
     if (!renderFrame)
         return;
     const bool isMainFrame = renderFrame->IsMainFrame();
-
-    QList<uint64_t> scriptsToRun = m_frameUserScriptMap.value(globalScriptsIndex);
-    scriptsToRun.append(m_frameUserScriptMap.value(renderFrame));
-
-    for (uint64_t id : qAsConst(scriptsToRun)) {
-        const QtWebEngineCore::UserScriptData &script = m_scripts.value(id);
-        if (script.injectionPoint != p || (!script.injectForSubframes && !isMainFrame))
+    const GURL url = frame->GetDocument().Url();
+
+    CandidateList candidates;
+    const auto global = m_frameUserScriptMap.constFind(globalScriptsIndex);
+    if (global != m_frameUserScriptMap.constEnd())
+        global->collect(p, url.host(), &candidates);
+    const auto local = m_frameUserScriptMap.constFind(renderFrame);
+    if (local != m_frameUserScriptMap.constEnd())
+        local->collect(p, url.host(), &candidates);
+
+    for (const CompiledUserScript *compiled : qAsConst(candidates)) {
+        const QtWebEngineCore::UserScriptData &script = compiled->data;
+        if (!script.injectForSubframes && !isMainFrame)
             continue;
-        if (!scriptMatchesURL(script, frame->GetDocument().Url()))
+        if (!compiled->matchesURL(url))
             continue;
         blink::WebScriptSource source(blink::WebString::FromUTF8(script.source), script.url);
         if (script.worldId)
@@ -331,10 +446,10 @@ void UserResourceController::renderFrameDestroyed(content::RenderFrame *renderFr
     FrameUserScriptMap::iterator it = m_frameUserScriptMap.find(renderFrame);
     if (it == m_frameUserScriptMap.end()) // ASSERT maybe?
         return;
-    for (uint64_t id : qAsConst(it.value())) {
-        m_scripts.remove(id);
+    for (uint64_t id : qAsConst(it->ids)) {
+        m_scripts.remove(ScriptKey(renderFrame, id));
     }
-    m_frameUserScriptMap.remove(renderFrame);
+    m_frameUserScriptMap.erase(it);
 }
 
 void UserResourceController::addScriptForFrame(const QtWebEngineCore::UserScriptData &script,
@@ -344,9 +459,20 @@ void UserResourceController::addScriptForFrame(const QtWebEngineCore::UserScript
     if (it == m_frameUserScriptMap.end())
         it = m_frameUserScriptMap.insert(frame, UserScriptSet());
 
-    if (!(*it).contains(script.scriptId))
-        (*it).append(script.scriptId);
-    m_scripts.insert(script.scriptId, script);
+    // Adding a script again replaces it, but keeps its place in the order.
+    const ScriptKey key(frame, script.scriptId);
+    quint64 sequenceNumber;
+    if (CompiledUserScriptPtr old = m_scripts.value(key)) {
+        sequenceNumber = old->sequenceNumber;
+        it->remove(old);
+    } else {
+        sequenceNumber = m_nextSequenceNumber++;
+        it->ids.append(script.scriptId);
+    }
+
+    CompiledUserScriptPtr compiled(new CompiledUserScript(script, sequenceNumber));
+    it->insert(compiled);
+    m_scripts.insert(key, compiled);
 }
 
 void UserResourceController::removeScriptForFrame(const QtWebEngineCore::UserScriptData &script,
@@ -356,8 +482,10 @@ void UserResourceController::removeScriptForFrame(const QtWebEngineCore::UserScr
     if (it == m_frameUserScriptMap.end())
         return;
 
-    (*it).removeOne(script.scriptId);
-    m_scripts.remove(script.scriptId);
+    if (CompiledUserScriptPtr compiled = m_scripts.take(ScriptKey(frame, script.scriptId))) {
+        it->remove(compiled);
+        it->ids.removeOne(script.scriptId);
+    }
 }
 
 void UserResourceController::clearScriptsForFrame(content::RenderFrame *frame)
@@ -365,10 +493,10 @@ void UserResourceController::clearScriptsForFrame(content::RenderFrame *frame)
     FrameUserScriptMap::iterator it = m_frameUserScriptMap.find(frame);
     if (it == m_frameUserScriptMap.end())
         return;
-    for (uint64_t id : qAsConst(it.value()))
-        m_scripts.remove(id);
+    for (uint64_t id : qAsConst(it->ids))
+        m_scripts.remove(ScriptKey(frame, id));
 
-    m_frameUserScriptMap.remove(frame);
+    m_frameUserScriptMap.erase(it);
 }
 
 void UserResourceController::AddScript(const QtWebEngineCore::UserScriptData &script)
@@ -46,7 +46,10 @@
 #include "mojo/public/cpp/bindings/associated_receiver.h"
 
 #include <QtCore/QHash>
+#include <QtCore/QPair>
 #include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVarLengthArray>
 
 namespace blink {
 class WebLocalFrame;
@@ -91,10 +94,33 @@ private:
 
     void runScripts(QtWebEngineCore::UserScriptData::InjectionPoint, blink::WebLocalFrame *);
 
-    typedef QList<uint64_t> UserScriptSet;
+    class CompiledUserScript;
+    typedef QSharedPointer<const CompiledUserScript> CompiledUserScriptPtr;
+    typedef QVarLengthArray<const CompiledUserScript *, 32> CandidateList;
+
+    // The scripts added for one frame, or globally, bucketed by injection
+    // point and by the hosts their URL patterns can match.
+    struct UserScriptSet
+    {
+        enum { InjectionPointCount = 3 };
+
+        QList<uint64_t> ids;
+        QHash<QByteArray, QList<CompiledUserScriptPtr>> byHost[InjectionPointCount];
+        QList<CompiledUserScriptPtr> anyHost[InjectionPointCount];
+
+        void insert(const CompiledUserScriptPtr &script);
+        void remove(const CompiledUserScriptPtr &script);
+        void collect(QtWebEngineCore::UserScriptData::InjectionPoint, const std::string &host,
+                     CandidateList *candidates) const;
+    };
+
     typedef QHash<const content::RenderFrame *, UserScriptSet> FrameUserScriptMap;
     FrameUserScriptMap m_frameUserScriptMap;
-    QHash<uint64_t, QtWebEngineCore::UserScriptData> m_scripts;
+    // Script ids are only unique per frame; the global scripts and those of
+    // each frame are assigned independently.
+    typedef QPair<const content::RenderFrame *, uint64_t> ScriptKey;
+    QHash<ScriptKey, CompiledUserScriptPtr> m_scripts;
+    quint64 m_nextSequenceNumber = 0;
     mojo::AssociatedReceiver<qtwebengine::mojom::UserResourceController> m_binding;
     friend class RenderFrameObserverHelper;
 };
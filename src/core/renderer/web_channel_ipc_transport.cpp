@@ -55,10 +55,262 @@
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "qtwebengine/browser/qtwebchannel.mojom.h"
 
-#include <QJsonDocument>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QtNumeric>
 
 namespace QtWebEngineCore {
 
+// Guards the recursive conversions against overly deep or cyclic structures.
+static const int kMaxNestingDepth = 256;
+
+// Messages are JSON or CBOR encoded objects, or arrays of them when the host
+// batches messages. CBOR maps and arrays never start with '{' or '['.
+static inline bool isCbor(const std::vector<uint8_t> &message)
+{
+    return !message.empty() && (message[0] & 0xc0) == 0x80;
+}
+
+static inline bool isJsonBatch(const std::vector<uint8_t> &message)
+{
+    return !message.empty() && message[0] == '[';
+}
+
+static bool readStringData(QCborStreamReader &reader, QByteArray *data)
+{
+    for (;;) {
+        qsizetype offset = data->size();
+        qsizetype chunkSize = reader.currentStringChunkSize();
+        if (chunkSize < 0)
+            return false;
+        data->resize(offset + chunkSize);
+        auto result = reader.readStringChunk(data->data() + offset, chunkSize);
+        if (result.status == QCborStreamReader::Error)
+            return false;
+        if (result.status == QCborStreamReader::EndOfString) {
+            data->resize(offset);
+            return true;
+        }
+        data->resize(offset + result.data);
+    }
+}
+
+// Decodes CBOR straight into V8 values, byte strings become ArrayBuffers.
+static v8::MaybeLocal<v8::Value> cborToV8(QCborStreamReader &reader, v8::Local<v8::Context> context, int depth = 0)
+{
+    v8::Isolate *isolate = context->GetIsolate();
+    if (depth > kMaxNestingDepth)
+        return v8::MaybeLocal<v8::Value>();
+
+    v8::Local<v8::Value> result;
+    switch (reader.type()) {
+    case QCborStreamReader::UnsignedInteger:
+        result = v8::Number::New(isolate, double(reader.toUnsignedInteger()));
+        break;
+    case QCborStreamReader::NegativeInteger:
+        result = v8::Number::New(isolate, -double(quint64(reader.toNegativeInteger())));
+        break;
+    case QCborStreamReader::Float16:
+        result = v8::Number::New(isolate, double(reader.toFloat16()));
+        break;
+    case QCborStreamReader::Float:
+        result = v8::Number::New(isolate, double(reader.toFloat()));
+        break;
+    case QCborStreamReader::Double:
+        result = v8::Number::New(isolate, reader.toDouble());
+        break;
+    case QCborStreamReader::SimpleType:
+        switch (reader.toSimpleType()) {
+        case QCborSimpleType::False:
+            result = v8::False(isolate);
+            break;
+        case QCborSimpleType::True:
+            result = v8::True(isolate);
+            break;
+        case QCborSimpleType::Undefined:
+            result = v8::Undefined(isolate);
+            break;
+        default:
+            result = v8::Null(isolate);
+            break;
+        }
+        break;
+    case QCborStreamReader::Tag:
+        // Tags carry no meaning for the page, decode the tagged item as is.
+        reader.next();
+        return cborToV8(reader, context, depth + 1);
+    case QCborStreamReader::ByteArray: {
+        QByteArray data;
+        if (!readStringData(reader, &data))
+            return v8::MaybeLocal<v8::Value>();
+        v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, data.size());
+        memcpy(buffer->GetBackingStore()->Data(), data.constData(), data.size());
+        return buffer;
+    }
+    case QCborStreamReader::String: {
+        QByteArray data;
+        if (!readStringData(reader, &data))
+            return v8::MaybeLocal<v8::Value>();
+        return v8::String::NewFromUtf8(isolate, data.constData(), v8::NewStringType::kNormal,
+                                       data.size());
+    }
+    case QCborStreamReader::Array: {
+        v8::Local<v8::Array> array = v8::Array::New(isolate, reader.isLengthKnown() ? int(reader.length()) : 0);
+        if (!reader.enterContainer())
+            return v8::MaybeLocal<v8::Value>();
+        for (uint32_t index = 0; reader.lastError() == QCborError::NoError && reader.hasNext(); ++index) {
+            v8::Local<v8::Value> value;
+            if (!cborToV8(reader, context, depth + 1).ToLocal(&value)
+                    || array->Set(context, index, value).IsNothing())
+                return v8::MaybeLocal<v8::Value>();
+        }
+        if (!reader.leaveContainer())
+            return v8::MaybeLocal<v8::Value>();
+        return array;
+    }
+    case QCborStreamReader::Map: {
+        v8::Local<v8::Object> object = v8::Object::New(isolate);
+        if (!reader.enterContainer())
+            return v8::MaybeLocal<v8::Value>();
+        while (reader.lastError() == QCborError::NoError && reader.hasNext()) {
+            v8::Local<v8::Value> key;
+            v8::Local<v8::Value> value;
+            if (!cborToV8(reader, context, depth + 1).ToLocal(&key)
+                    || !cborToV8(reader, context, depth + 1).ToLocal(&value)
+                    || object->Set(context, key, value).IsNothing())
+                return v8::MaybeLocal<v8::Value>();
+        }
+        if (!reader.leaveContainer())
+            return v8::MaybeLocal<v8::Value>();
+        return object;
+    }
+    case QCborStreamReader::Invalid:
+        return v8::MaybeLocal<v8::Value>();
+    }
+
+    if (!reader.next())
+        return v8::MaybeLocal<v8::Value>();
+    return result;
+}
+
+static void appendString(QCborStreamWriter &writer, v8::Isolate *isolate, v8::Local<v8::String> string)
+{
+    QByteArray utf8(string->Utf8Length(isolate), Qt::Uninitialized);
+    string->WriteUtf8(isolate, utf8.data(), utf8.size(), nullptr, v8::String::REPLACE_INVALID_UTF8);
+    writer.appendTextString(utf8.constData(), utf8.size());
+}
+
+// Does what JSON.stringify() does to a value before serializing it: calls
+// its toJSON() method, if any, and unwraps Number, String and Boolean objects.
+static v8::MaybeLocal<v8::Value> toJsonValue(v8::Local<v8::Context> context, v8::Local<v8::Value> key,
+                                             v8::Local<v8::Value> value)
+{
+    if (!value->IsObject())
+        return value;
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    v8::Local<v8::Value> toJson;
+    if (!object->Get(context, gin::StringToV8(context->GetIsolate(), "toJSON")).ToLocal(&toJson))
+        return v8::MaybeLocal<v8::Value>();
+    if (toJson->IsFunction()) {
+        v8::Local<v8::Value> keyString;
+        if (!key->ToString(context).ToLocal(&keyString)
+                || !toJson.As<v8::Function>()->Call(context, object, 1, &keyString).ToLocal(&value))
+            return v8::MaybeLocal<v8::Value>();
+    }
+    if (value->IsNumberObject())
+        return v8::Number::New(context->GetIsolate(), value.As<v8::NumberObject>()->ValueOf());
+    if (value->IsStringObject())
+        return value.As<v8::StringObject>()->ValueOf();
+    if (value->IsBooleanObject())
+        return v8::Boolean::New(context->GetIsolate(), value.As<v8::BooleanObject>()->ValueOf());
+    return value;
+}
+
+static bool v8ToCbor(QCborStreamWriter &writer, v8::Local<v8::Context> context, v8::Local<v8::Value> key,
+                     v8::Local<v8::Value> value, int depth = 0);
+
+// Encodes a value that toJsonValue() has already been applied to.
+static bool jsonValueToCbor(QCborStreamWriter &writer, v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                            int depth)
+{
+    v8::Isolate *isolate = context->GetIsolate();
+    if (depth > kMaxNestingDepth)
+        return false;
+
+    if (value->IsNull() || value->IsUndefined() || value->IsFunction() || value->IsSymbol()) {
+        writer.append(nullptr);
+    } else if (value->IsBoolean()) {
+        writer.append(value->IsTrue());
+    } else if (value->IsInt32()) {
+        writer.append(qint64(value.As<v8::Int32>()->Value()));
+    } else if (value->IsNumber()) {
+        const double number = value.As<v8::Number>()->Value();
+        if (qIsFinite(number))
+            writer.append(number);
+        else
+            writer.append(nullptr);
+    } else if (value->IsString()) {
+        appendString(writer, isolate, value.As<v8::String>());
+    } else if (value->IsArrayBuffer()) {
+        v8::Local<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+        writer.appendByteString(static_cast<const char *>(buffer->GetBackingStore()->Data()),
+                                buffer->ByteLength());
+    } else if (value->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+        writer.appendByteString(static_cast<const char *>(view->Buffer()->GetBackingStore()->Data())
+                                        + view->ByteOffset(),
+                                view->ByteLength());
+    } else if (value->IsArray()) {
+        v8::Local<v8::Array> array = value.As<v8::Array>();
+        writer.startArray(array->Length());
+        for (uint32_t i = 0; i < array->Length(); ++i) {
+            v8::Local<v8::Value> element;
+            if (!array->Get(context, i).ToLocal(&element)
+                    || !v8ToCbor(writer, context, v8::Integer::NewFromUnsigned(isolate, i), element, depth + 1))
+                return false;
+        }
+        writer.endArray();
+    } else if (value->IsObject()) {
+        v8::Local<v8::Object> object = value.As<v8::Object>();
+        v8::Local<v8::Array> keys;
+        if (!object->GetOwnPropertyNames(context).ToLocal(&keys))
+            return false;
+        writer.startMap();
+        for (uint32_t i = 0; i < keys->Length(); ++i) {
+            v8::Local<v8::Value> key;
+            v8::Local<v8::Value> property;
+            if (!keys->Get(context, i).ToLocal(&key) || !object->Get(context, key).ToLocal(&property))
+                return false;
+            // toJSON() may turn the property into something that is skipped.
+            if (!toJsonValue(context, key, property).ToLocal(&property))
+                return false;
+            if (property->IsUndefined() || property->IsFunction() || property->IsSymbol())
+                continue;
+            v8::Local<v8::String> keyString;
+            if (!key->ToString(context).ToLocal(&keyString))
+                return false;
+            appendString(writer, isolate, keyString);
+            if (!jsonValueToCbor(writer, context, property, depth + 1))
+                return false;
+        }
+        writer.endMap();
+    } else {
+        writer.append(nullptr);
+    }
+    return true;
+}
+
+// Encodes V8 values with JSON.stringify() semantics, except that ArrayBuffers
+// and their views are written as CBOR byte strings. key is the name or index
+// value is stored under, which JSON.stringify() passes to toJSON().
+static bool v8ToCbor(QCborStreamWriter &writer, v8::Local<v8::Context> context, v8::Local<v8::Value> key,
+                     v8::Local<v8::Value> value, int depth)
+{
+    if (!toJsonValue(context, key, value).ToLocal(&value))
+        return false;
+    return jsonValueToCbor(writer, context, value, depth);
+}
+
 class WebChannelTransport : public gin::Wrappable<WebChannelTransport>
 {
 public:
@@ -133,22 +385,38 @@ void WebChannelTransport::NativeQtSendMessage(gin::Arguments *args)
     if (!renderFrame)
         return;
 
-    v8::Local<v8::Value> jsonValue;
-    if (!args->GetNext(&jsonValue)) {
+    v8::Local<v8::Value> messageValue;
+    if (!args->GetNext(&messageValue)) {
         args->ThrowTypeError("Missing argument");
         return;
     }
     v8::Isolate *isolate = blink::MainThreadIsolate();
     v8::HandleScope handleScope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
 
-    if (!jsonValue->IsString()) {
-        args->ThrowTypeError("Expected string");
+    if (!messageValue->IsString() && !messageValue->IsObject()) {
+        args->ThrowTypeError("Expected string or object");
         return;
     }
-    v8::Local<v8::String> jsonString = v8::Local<v8::String>::Cast(jsonValue);
-    std::vector<uint8_t> json(jsonString->Utf8Length(isolate), 0);
-    jsonString->WriteUtf8(isolate, reinterpret_cast<char *>(json.data()), json.size(), nullptr,
-                          v8::String::REPLACE_INVALID_UTF8);
+
+    // Strings, which is what qwebchannel.js sends, are passed on as JSON text
+    // as they are. Parsing them here only to encode them again would cost
+    // more than the host parsing them once.
+    std::vector<uint8_t> message;
+    if (messageValue->IsString()) {
+        v8::Local<v8::String> jsonString = messageValue.As<v8::String>();
+        message.resize(jsonString->Utf8Length(isolate));
+        jsonString->WriteUtf8(isolate, reinterpret_cast<char *>(message.data()), message.size(),
+                              nullptr, v8::String::REPLACE_INVALID_UTF8);
+    } else {
+        QByteArray cbor;
+        QCborStreamWriter writer(&cbor);
+        if (!v8ToCbor(writer, context, v8::String::Empty(isolate), messageValue)) {
+            args->ThrowTypeError("Message cannot be serialized");
+            return;
+        }
+        message.assign(cbor.constBegin(), cbor.constEnd());
+    }
 
     if (!m_remote) {
         renderFrame->GetRemoteAssociatedInterfaces()->GetInterface(&m_remote);
@@ -156,7 +424,7 @@ void WebChannelTransport::NativeQtSendMessage(gin::Arguments *args)
     }
     DCHECK(renderFrame == m_renderFrame);
 
-    m_remote->DispatchWebChannelMessage(json);
+    m_remote->DispatchWebChannelMessage(message);
 }
 
 gin::ObjectTemplateBuilder WebChannelTransport::GetObjectTemplateBuilder(v8::Isolate *isolate)
@@ -205,7 +473,7 @@ void WebChannelIPCTransport::ResetWorldId()
     m_worldId = 0;
 }
 
-void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t> &json,
+void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t> &message,
                                                        uint32_t worldId)
 {
     DCHECK(m_worldId == worldId);
@@ -240,16 +508,59 @@ void WebChannelIPCTransport::DispatchWebChannelMessage(const std::vector<uint8_t
         return;
     }
 
+    // Binary messages and batches are handed to the page as already decoded
+    // objects, qwebchannel.js only JSON.parse()s string data.
+    const bool binary = isCbor(message);
+    v8::Local<v8::Value> data;
+    if (binary) {
+        QCborStreamReader reader(reinterpret_cast<const char *>(message.data()), message.size());
+        if (!cborToV8(reader, context).ToLocal(&data)) {
+            LOG(WARNING) << "Received invalid binary webchannel message: "
+                         << qPrintable(reader.lastError().toString());
+            return;
+        }
+    } else {
+        data = v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(message.data()),
+                                       v8::NewStringType::kNormal, message.size())
+                       .ToLocalChecked();
+        if (isJsonBatch(message)
+                && !v8::JSON::Parse(context, data.As<v8::String>()).ToLocal(&data)) {
+            LOG(WARNING) << "Received invalid webchannel message batch.";
+            return;
+        }
+    }
+
+    v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(callbackValue.ToLocalChecked());
+    if (!data->IsArray()) {
+        deliverMessage(frame, callback, webChannelObject, data);
+        return;
+    }
+
+    // Deliver the whole batch within this task, unless a handler tears down
+    // the frame or its script context.
+    base::WeakPtr<WebChannelIPCTransport> self = m_weakFactory.GetWeakPtr();
+    v8::Local<v8::Array> batch = data.As<v8::Array>();
+    for (uint32_t i = 0; i < batch->Length(); ++i) {
+        v8::Local<v8::Value> element;
+        if (!batch->Get(context, i).ToLocal(&element))
+            return;
+        deliverMessage(frame, callback, webChannelObject, element);
+        if (!self || !m_canUseContext)
+            return;
+    }
+}
+
+void WebChannelIPCTransport::deliverMessage(blink::WebLocalFrame *frame, v8::Local<v8::Function> callback,
+                                            v8::Local<v8::Object> webChannelObject, v8::Local<v8::Value> data)
+{
+    v8::Isolate *isolate = blink::MainThreadIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
     v8::Local<v8::Object> messageObject(v8::Object::New(isolate));
     v8::Maybe<bool> wasSet = messageObject->DefineOwnProperty(
-            context, v8::String::NewFromUtf8(isolate, "data").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(json.data()),
-                                    v8::NewStringType::kNormal, json.size())
-                    .ToLocalChecked(),
+            context, v8::String::NewFromUtf8(isolate, "data").ToLocalChecked(), data,
             v8::PropertyAttribute(v8::ReadOnly | v8::DontDelete));
     DCHECK(!wasSet.IsNothing() && wasSet.FromJust());
 
-    v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(callbackValue.ToLocalChecked());
     v8::Local<v8::Value> argv[] = { messageObject };
     frame->CallFunctionEvenIfScriptDisabled(callback, webChannelObject, 1, argv);
 }
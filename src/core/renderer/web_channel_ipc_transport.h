@@ -40,6 +40,7 @@
 #ifndef WEB_CHANNEL_IPC_TRANSPORT_H
 #define WEB_CHANNEL_IPC_TRANSPORT_H
 
+#include "base/memory/weak_ptr.h"
 #include "content/public/renderer/render_frame_observer.h"
 #include "services/service_manager/public/cpp/binder_registry.h"
 #include "mojo/public/cpp/bindings/associated_receiver_set.h"
@@ -48,6 +49,10 @@
 
 #include <QtCore/qglobal.h>
 
+namespace blink {
+class WebLocalFrame;
+}
+
 namespace QtWebEngineCore {
 
 class WebChannelIPCTransport
@@ -61,13 +66,15 @@ private:
     // qtwebchannel::mojom::WebChannelTransportRender
     void SetWorldId(uint32_t worldId) override;
     void ResetWorldId() override;
-    void DispatchWebChannelMessage(const std::vector<uint8_t> &json, uint32_t worldId) override;
+    void DispatchWebChannelMessage(const std::vector<uint8_t> &message, uint32_t worldId) override;
 
     // RenderFrameObserver
     void DidCreateScriptContext(v8::Local<v8::Context> context, int32_t worldId) override;
     void WillReleaseScriptContext(v8::Local<v8::Context> context, int worldId) override;
     void OnDestruct() override;
     void BindReceiver(mojo::PendingAssociatedReceiver<qtwebchannel::mojom::WebChannelTransportRender> receiver);
+    void deliverMessage(blink::WebLocalFrame *frame, v8::Local<v8::Function> callback,
+                        v8::Local<v8::Object> webChannelObject, v8::Local<v8::Value> data);
 
 private:
     // The worldId from our WebChannelIPCTransportHost or empty when there is no
@@ -77,6 +84,7 @@ private:
     // True means it's currently OK to manipulate the frame's script context.
     bool m_canUseContext = false;
     mojo::AssociatedReceiver<qtwebchannel::mojom::WebChannelTransportRender> m_binding;
+    base::WeakPtrFactory<WebChannelIPCTransport> m_weakFactory{this};
 };
 
 } // namespace
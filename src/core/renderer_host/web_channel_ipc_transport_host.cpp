@@ -39,6 +39,9 @@
 
 #include "web_channel_ipc_transport_host.h"
 
+#include "web_contents_delegate_qt.h"
+#include "web_engine_settings.h"
+
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/web_contents.h"
@@ -47,6 +50,9 @@
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "qtwebengine/browser/qtwebchannel.mojom.h"
 
+#include <QCborMap>
+#include <QCborStreamWriter>
+#include <QCborValue>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLoggingCategory>
@@ -54,12 +60,31 @@
 namespace QtWebEngineCore {
 
 Q_LOGGING_CATEGORY(log, "qt.webengine.webchanneltransport")
+Q_LOGGING_CATEGORY(lcBatching, "qt.webengine.webchanneltransport.batching")
+
+// Coalesces the messages sent within the given number of milliseconds into a
+// single IPC, 0 batches the messages sent within one event loop iteration.
+// Read for every new transport, so it can be changed at run time.
+const static char kBatchIntervalEnv[] = "QTWEBENGINE_WEBCHANNEL_BATCH_INTERVAL";
+
+static int batchInterval()
+{
+    bool ok = false;
+    const int interval = qEnvironmentVariableIntValue(kBatchIntervalEnv, &ok);
+    return ok ? interval : -1;
+}
 
 inline QDebug operator<<(QDebug stream, content::RenderFrameHost *frame)
 {
     return stream << "frame " << frame->GetRoutingID() << " in process " << frame->GetProcess()->GetID();
 }
 
+// Messages are JSON or CBOR encoded objects, a CBOR map never starts with '{'.
+static inline bool isCborMap(const QByteArray &message)
+{
+    return !message.isEmpty() && (uchar(message.at(0)) & 0xe0) == 0xa0;
+}
+
 template<class T>
 inline QDebug operator<<(QDebug stream, const base::Optional<T> &opt)
 {
@@ -74,13 +99,28 @@ WebChannelIPCTransportHost::WebChannelIPCTransportHost(content::WebContents *con
     , content::WebContentsObserver(contents)
     , m_worldId(worldId)
     , m_receiver(contents, this)
+    , m_batchInterval(batchInterval())
 {
     for (content::RenderFrameHost *frame : contents->GetAllFrames())
         setWorldId(frame, worldId);
+
+    if (m_batchInterval >= 0) {
+        m_batchTimer.setSingleShot(true);
+        m_batchTimer.setInterval(m_batchInterval);
+        QObject::connect(&m_batchTimer, &QTimer::timeout, this,
+                         &WebChannelIPCTransportHost::flushMessages);
+    }
 }
 
 WebChannelIPCTransportHost::~WebChannelIPCTransportHost()
 {
+    flushMessages();
+    if (m_batchStatistics.batches) {
+        qCDebug(lcBatching).nospace()
+                << "delivered " << m_batchStatistics.messages << " messages in "
+                << m_batchStatistics.batches << " batches (largest " << m_batchStatistics.largestBatch
+                << ", " << m_batchStatistics.bytes << " bytes)";
+    }
     resetWorldId();
 }
 
@@ -91,18 +131,74 @@ uint WebChannelIPCTransportHost::worldId() const
 
 void WebChannelIPCTransportHost::sendMessage(const QJsonObject &message)
 {
-    QJsonDocument doc(message);
-    QByteArray json = doc.toJson(QJsonDocument::Compact);
+    if (m_batchInterval >= 0) {
+        m_pendingMessages.append(message);
+        if (!m_batchTimer.isActive())
+            m_batchTimer.start();
+        return;
+    }
+
+    content::RenderFrameHost *frame = web_contents()->GetMainFrame();
+    QByteArray data;
+    if (binaryEncodingEnabled()) {
+        data = QCborMap::fromJsonObject(message).toCborValue().toCbor();
+        qCDebug(log).nospace() << "sending binary webchannel message to " << frame << ": " << message;
+    } else {
+        data = QJsonDocument(message).toJson(QJsonDocument::Compact);
+        qCDebug(log).nospace() << "sending webchannel message to " << frame << ": " << message;
+    }
+    dispatchMessage(data);
+}
+
+void WebChannelIPCTransportHost::flushMessages()
+{
+    m_batchTimer.stop();
+    if (m_pendingMessages.isEmpty())
+        return;
+
+    // A batch is an array of messages, which the renderer unpacks and
+    // delivers to the page in one go.
+    QByteArray data;
+    if (binaryEncodingEnabled()) {
+        QCborStreamWriter writer(&data);
+        writer.startArray(m_pendingMessages.size());
+        for (const QJsonObject &message : qAsConst(m_pendingMessages))
+            QCborMap::fromJsonObject(message).toCborValue().toCbor(writer);
+        writer.endArray();
+    } else {
+        data.append('[');
+        for (const QJsonObject &message : qAsConst(m_pendingMessages)) {
+            if (data.size() > 1)
+                data.append(',');
+            data.append(QJsonDocument(message).toJson(QJsonDocument::Compact));
+        }
+        data.append(']');
+    }
+
+    const int count = m_pendingMessages.size();
+    m_pendingMessages.clear();
+    m_batchStatistics.messages += count;
+    m_batchStatistics.batches += 1;
+    m_batchStatistics.bytes += data.size();
+    m_batchStatistics.largestBatch = std::max(m_batchStatistics.largestBatch, count);
+    qCDebug(lcBatching).nospace() << "sending batch of " << count << " webchannel messages ("
+                                  << data.size() << " bytes)";
+    dispatchMessage(data);
+}
+
+void WebChannelIPCTransportHost::dispatchMessage(const QByteArray &data)
+{
     content::RenderFrameHost *frame = web_contents()->GetMainFrame();
-    qCDebug(log).nospace() << "sending webchannel message to " << frame << ": " << doc;
     GetWebChannelIPCTransportRemote(frame)->DispatchWebChannelMessage(
-            std::vector<uint8_t>(json.begin(), json.end()), m_worldId);
+            std::vector<uint8_t>(data.begin(), data.end()), m_worldId);
 }
 
 void WebChannelIPCTransportHost::setWorldId(uint32_t worldId)
 {
     if (m_worldId == worldId)
         return;
+    // Queued messages belong to the old world.
+    flushMessages();
     for (content::RenderFrameHost *frame : web_contents()->GetAllFrames())
         setWorldId(frame, worldId);
     m_worldId = worldId;
@@ -125,7 +221,14 @@ void WebChannelIPCTransportHost::resetWorldId()
     }
 }
 
-void WebChannelIPCTransportHost::DispatchWebChannelMessage(const std::vector<uint8_t> &json)
+bool WebChannelIPCTransportHost::binaryEncodingEnabled() const
+{
+    auto *delegate = static_cast<WebContentsDelegateQt *>(web_contents()->GetDelegate());
+    return delegate && delegate->webEngineSettings()->testAttribute(
+            QWebEngineSettings::BinaryWebChannelTransportEnabled);
+}
+
+void WebChannelIPCTransportHost::DispatchWebChannelMessage(const std::vector<uint8_t> &message)
 {
     content::RenderFrameHost *frame = web_contents()->GetMainFrame();
 
@@ -133,16 +236,31 @@ void WebChannelIPCTransportHost::DispatchWebChannelMessage(const std::vector<uin
         return;
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(
-            QByteArray(reinterpret_cast<const char *>(json.data()), json.size()));
-
-    if (!doc.isObject()) {
-        qCCritical(log).nospace() << "received invalid webchannel message from " << frame;
-        return;
+    // The renderer passes strings on as JSON text and encodes objects as
+    // CBOR, so both are accepted regardless of the current setting.
+    const QByteArray data = QByteArray::fromRawData(
+            reinterpret_cast<const char *>(message.data()), message.size());
+    QJsonObject object;
+    if (isCborMap(data)) {
+        QCborParserError error;
+        QCborValue value = QCborValue::fromCbor(data, &error);
+        if (error.error != QCborError::NoError || !value.isMap()) {
+            qCCritical(log).nospace() << "received invalid binary webchannel message from " << frame
+                                      << ": " << error.errorString();
+            return;
+        }
+        object = value.toMap().toJsonObject();
+    } else {
+        QJsonDocument doc = QJsonDocument::fromJson(data);
+        if (!doc.isObject()) {
+            qCCritical(log).nospace() << "received invalid webchannel message from " << frame;
+            return;
+        }
+        object = doc.object();
     }
 
-    qCDebug(log).nospace() << "received webchannel message from " << frame << ": " << doc;
-    Q_EMIT messageReceived(doc.object(), this);
+    qCDebug(log).nospace() << "received webchannel message from " << frame << ": " << object;
+    Q_EMIT messageReceived(object, this);
 }
 
 void WebChannelIPCTransportHost::RenderFrameCreated(content::RenderFrameHost *frame)
@@ -46,6 +46,9 @@
 #include "content/public/browser/web_contents_receiver_set.h"
 #include "qtwebengine/browser/qtwebchannel.mojom.h"
 
+#include <QJsonObject>
+#include <QList>
+#include <QTimer>
 #include <QWebChannelAbstractTransport>
 #include <map>
 
@@ -71,6 +74,9 @@ public:
 private:
     void setWorldId(content::RenderFrameHost *frame, uint32_t worldId);
     void resetWorldId();
+    bool binaryEncodingEnabled() const;
+    void flushMessages();
+    void dispatchMessage(const QByteArray &data);
 
     const mojo::AssociatedRemote<qtwebchannel::mojom::WebChannelTransportRender> &
     GetWebChannelIPCTransportRemote(content::RenderFrameHost *rfh);
@@ -80,7 +86,7 @@ private:
     void RenderFrameDeleted(content::RenderFrameHost *render_frame_host) override;
 
     // qtwebchannel::mojom::WebChannelTransportHost
-    void DispatchWebChannelMessage(const std::vector<uint8_t> &json) override;
+    void DispatchWebChannelMessage(const std::vector<uint8_t> &message) override;
 
     // Empty only during construction/destruction. Synchronized to all the
     // WebChannelIPCTransports/RenderFrames in the observed WebContents.
@@ -89,6 +95,19 @@ private:
     std::map<content::RenderFrameHost *,
              mojo::AssociatedRemote<qtwebchannel::mojom::WebChannelTransportRender>>
             m_renderFrames;
+
+    // Messages queued by sendMessage() while batching, delivered to the
+    // renderer as one array by flushMessages(). Batching is off if the
+    // interval is negative.
+    const int m_batchInterval;
+    QList<QJsonObject> m_pendingMessages;
+    QTimer m_batchTimer;
+    struct BatchStatistics {
+        quint64 messages = 0;
+        quint64 batches = 0;
+        quint64 bytes = 0;
+        int largestBatch = 0;
+    } m_batchStatistics;
 };
 
 } // namespace
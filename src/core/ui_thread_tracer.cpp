@@ -0,0 +1,155 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "ui_thread_tracer.h"
+
+#include "type_conversion.h"
+
+#include "base/pending_task.h"
+#include "base/task/current_thread.h"
+#include "base/trace_event/trace_config.h"
+#include "base/trace_event/trace_event.h"
+#include "content/public/browser/tracing_controller.h"
+
+#include <QAbstractEventDispatcher>
+
+namespace QtWebEngineCore {
+
+// "toplevel" has the message pump slices and Chromium's own task events,
+// "ui" has the Qt event loop and the UI thread tasks with their queue times.
+const static char kTraceCategories[] = "toplevel,toplevel.flow,ui";
+
+UiThreadTracer::UiThreadTracer() = default;
+
+UiThreadTracer::~UiThreadTracer()
+{
+    if (m_tracing)
+        stop(nullptr);
+}
+
+bool UiThreadTracer::start(const QString &fileName)
+{
+    if (m_tracing || fileName.isEmpty())
+        return false;
+
+    const base::trace_event::TraceConfig config(kTraceCategories, base::trace_event::RECORD_CONTINUOUSLY);
+    if (!content::TracingController::GetInstance()->StartTracing(config, base::OnceClosure()))
+        return false;
+
+    m_fileName = fileName;
+    m_tracing = true;
+
+    // Queue times are only recorded on request, as they cost a clock read per posted task.
+    base::CurrentThread::Get()->SetAddQueueTimeToTasks(true);
+    base::CurrentThread::Get()->AddTaskObserver(this);
+
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    m_awakeConnection = QObject::connect(dispatcher, &QAbstractEventDispatcher::awake,
+                                         [this]() { eventLoopAwake(); });
+    m_aboutToBlockConnection = QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                                                [this]() { eventLoopAboutToBlock(); });
+    return true;
+}
+
+void UiThreadTracer::stop(std::function<void()> done)
+{
+    if (!m_tracing)
+        return;
+    m_tracing = false;
+
+    QObject::disconnect(m_awakeConnection);
+    QObject::disconnect(m_aboutToBlockConnection);
+    eventLoopAboutToBlock();
+    base::CurrentThread::Get()->RemoveTaskObserver(this);
+    base::CurrentThread::Get()->SetAddQueueTimeToTasks(false);
+
+    const bool stopping = content::TracingController::GetInstance()->StopTracing(
+            content::TracingController::CreateFileEndpoint(
+                    toFilePath(m_fileName),
+                    base::BindOnce([](std::function<void()> done) { if (done) done(); }, done)));
+    // Nothing will be written then, so there is nothing to wait for.
+    if (!stopping) {
+        qWarning("Could not stop tracing the UI thread, %s is not written", qPrintable(m_fileName));
+        if (done)
+            done();
+    }
+}
+
+void UiThreadTracer::WillProcessTask(const base::PendingTask &pendingTask, bool wasBlockedOrLowPriority)
+{
+    const int64_t queueDuration = pendingTask.queue_time.is_null()
+            ? -1 : (base::TimeTicks::Now() - pendingTask.queue_time).InMicroseconds();
+    TRACE_EVENT_BEGIN2("ui", "UIThreadTask",
+                       "posted_from", pendingTask.posted_from.ToString(),
+                       "queue_duration_us", queueDuration);
+    Q_UNUSED(wasBlockedOrLowPriority);
+}
+
+void UiThreadTracer::DidProcessTask(const base::PendingTask &pendingTask)
+{
+    Q_UNUSED(pendingTask);
+    TRACE_EVENT_END0("ui", "UIThreadTask");
+}
+
+// An event loop iteration spans from waking up to getting ready to block
+// again. A nested event loop, run from a Chromium task or a Qt event, blocks
+// while the events of the outer iteration are still open, so an iteration
+// can't be nested with the other events of the thread. It is recorded on a
+// track of its own once it is over, with the times it started and ended.
+// Iterations there follow each other: one that runs a nested event loop ends
+// when that loop first blocks, and the nested loop's iterations follow.
+void UiThreadTracer::eventLoopAwake()
+{
+    if (!m_iterationStart.is_null())
+        return;
+    m_iterationStart = base::TimeTicks::Now();
+}
+
+void UiThreadTracer::eventLoopAboutToBlock()
+{
+    if (m_iterationStart.is_null())
+        return;
+    TRACE_EVENT_NESTABLE_ASYNC_BEGIN_WITH_TIMESTAMP0("ui", "QtEventLoopIteration", TRACE_ID_LOCAL(this),
+                                                     m_iterationStart);
+    TRACE_EVENT_NESTABLE_ASYNC_END_WITH_TIMESTAMP0("ui", "QtEventLoopIteration", TRACE_ID_LOCAL(this),
+                                                   base::TimeTicks::Now());
+    m_iterationStart = base::TimeTicks();
+}
+
+} // namespace QtWebEngineCore
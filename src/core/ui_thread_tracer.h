@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef UI_THREAD_TRACER_H
+#define UI_THREAD_TRACER_H
+
+#include "base/task/task_observer.h"
+#include "base/time/time.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+
+#include <functional>
+
+namespace QtWebEngineCore {
+
+// Records how the UI thread is shared between Qt and Chromium into a Chrome
+// JSON trace file: the iterations of the Qt event loop, the slices in which
+// MessagePumpForUIQt runs Chromium tasks, and every Chromium task with where
+// it was posted from and how long it was queued. The Chromium side goes
+// through the in-process tracing service, so the trace also contains the
+// toplevel task events of the other browser threads.
+class UiThreadTracer : public base::TaskObserver
+{
+public:
+    UiThreadTracer();
+    ~UiThreadTracer() override;
+
+    bool start(const QString &fileName);
+    // Calls |done| once the trace file has been written.
+    void stop(std::function<void()> done);
+    bool isTracing() const { return m_tracing; }
+
+    // base::TaskObserver
+    void WillProcessTask(const base::PendingTask &pendingTask, bool wasBlockedOrLowPriority) override;
+    void DidProcessTask(const base::PendingTask &pendingTask) override;
+
+private:
+    void eventLoopAwake();
+    void eventLoopAboutToBlock();
+
+    QString m_fileName;
+    bool m_tracing = false;
+    // Null outside of an event loop iteration.
+    base::TimeTicks m_iterationStart;
+    QMetaObject::Connection m_awakeConnection;
+    QMetaObject::Connection m_aboutToBlockConnection;
+};
+
+} // namespace QtWebEngineCore
+
+#endif // UI_THREAD_TRACER_H
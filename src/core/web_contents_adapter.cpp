@@ -1369,6 +1369,18 @@ QSizeF WebContentsAdapter::lastContentsSize() const
     return QSizeF();
 }
 
+void WebContentsAdapter::produceFrame(const std::function<void(const QImage &)> &callback)
+{
+    RenderWidgetHostViewQt *rwhv = nullptr;
+    if (isInitialized() && WebEngineContext::isHeadlessCompositing())
+        rwhv = static_cast<RenderWidgetHostViewQt *>(m_webContents->GetRenderWidgetHostView());
+    if (!rwhv) {
+        callback(QImage());
+        return;
+    }
+    rwhv->produceFrame(callback);
+}
+
 void WebContentsAdapter::grantMediaAccessPermission(const QUrl &securityOrigin, WebContentsAdapterClient::MediaRequestFlags flags)
 {
     CHECK_INITIALIZED();
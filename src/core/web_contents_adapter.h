@@ -62,6 +62,7 @@
 
 #include "web_contents_adapter_client.h"
 
+#include <functional>
 #include <memory>
 
 namespace blink {
@@ -80,6 +81,7 @@ class QAccessibleInterface;
 class QDragEnterEvent;
 class QDragMoveEvent;
 class QDropEvent;
+class QImage;
 class QMimeData;
 class QPageLayout;
 class QPageRanges;
@@ -213,6 +215,7 @@ public:
 
     QPointF lastScrollOffset() const;
     QSizeF lastContentsSize() const;
+    void produceFrame(const std::function<void(const QImage &)> &callback);
 
 #if QT_CONFIG(draganddrop)
     void startDragging(QObject *dragSource, const content::DropData &dropData,
@@ -125,8 +125,10 @@
 #include "ozone/gl_context_qt.h"
 #include "profile_adapter.h"
 #include "type_conversion.h"
+#include "ui_thread_tracer.h"
 #include "web_engine_library_info.h"
 
+#include <QDeadlineTimer>
 #include <QFileInfo>
 #include <QGuiApplication>
 #include <QMutex>
@@ -138,6 +140,7 @@
 #include <QQuickWindow>
 #include <QStringList>
 #include <QSurfaceFormat>
+#include <QThread>
 #include <QNetworkProxy>
 #include <QtGui/qpa/qplatformintegration.h>
 #include <QtGui/private/qguiapplication_p.h>
@@ -432,8 +435,41 @@ void WebEngineContext::flushMessages()
         while (delegate->DoWork().is_immediate()) { }
     }
 }
+
+bool WebEngineContext::startUiThreadTracing(const QString &fileName)
+{
+    if (!m_uiThreadTracer)
+        m_uiThreadTracer.reset(new UiThreadTracer);
+    return m_uiThreadTracer->start(fileName);
+}
+
+// How long stopUiThreadTracing() waits for the trace file, in milliseconds.
+const static int kUiTraceWriteTimeout = 30000;
+
+// The trace file is written asynchronously, this returns once it is complete,
+// or after a while if writing it is stuck.
+void WebEngineContext::stopUiThreadTracing()
+{
+    if (!m_uiThreadTracer || !m_uiThreadTracer->isTracing())
+        return;
+    auto written = std::make_shared<bool>(false);
+    m_uiThreadTracer->stop([written]() { *written = true; });
+    const QDeadlineTimer deadline(kUiTraceWriteTimeout);
+    while (!*written) {
+        if (deadline.hasExpired()) {
+            qWarning("Timed out writing the UI thread trace");
+            return;
+        }
+        flushMessages();
+        QThread::msleep(10);
+    }
+}
+
 void WebEngineContext::destroy()
 {
+    stopUiThreadTracing();
+    m_uiThreadTracer.reset();
+
     if (m_devtoolsServer)
         m_devtoolsServer->stop();
 
@@ -582,6 +618,8 @@ ProxyAuthentication WebEngineContext::qProxyNetworkAuthentication(QString host,
 const static char kChromiumFlagsEnv[] = "QTWEBENGINE_CHROMIUM_FLAGS";
 const static char kDisableSandboxEnv[] = "QTWEBENGINE_DISABLE_SANDBOX";
 const static char kDisableInProcGpuThread[] = "QTWEBENGINE_DISABLE_GPU_THREAD";
+const static char kHeadlessCompositorEnv[] = "QTWEBENGINE_HEADLESS_COMPOSITOR";
+const static char kUiTraceFileEnv[] = "QTWEBENGINE_UI_TRACE_FILE";
 
 // static
 bool WebEngineContext::isGpuServiceOnUIThread()
@@ -594,6 +632,15 @@ bool WebEngineContext::isGpuServiceOnUIThread()
     return !threadedGpu;
 }
 
+// static
+// Software compositing without any display: frames are only produced when
+// explicitly requested with QWebEnginePage::produceFrame().
+bool WebEngineContext::isHeadlessCompositing()
+{
+    static bool headless = qEnvironmentVariableIsSet(kHeadlessCompositorEnv);
+    return headless;
+}
+
 static void initializeFeatureList(base::CommandLine *commandLine, std::vector<std::string> enableFeatures, std::vector<std::string> disableFeatures)
 {
     std::string enableFeaturesString = base::JoinString(enableFeatures, ",");
@@ -738,7 +785,7 @@ WebEngineContext::WebEngineContext()
     // performant, but at least provides WebGL support.
     // TODO(miklocek), check if this still works with latest chromium
     const bool enableGLSoftwareRendering = appArgs.contains(QStringLiteral("--enable-webgl-software-rendering"));
-    const char *glType = getGLType(enableGLSoftwareRendering);
+    const char *glType = isHeadlessCompositing() ? nullptr : getGLType(enableGLSoftwareRendering);
 
     if (glType) {
 #if QT_CONFIG(opengl)
@@ -776,6 +823,15 @@ WebEngineContext::WebEngineContext()
         parsedCommandLine->AppendSwitch(switches::kDisableGpu);
     }
 
+    if (isHeadlessCompositing()) {
+        // Make every requested frame complete, as there is no next vsync
+        // to catch up with.
+        parsedCommandLine->AppendSwitch(cc::switches::kRunAllCompositorStagesBeforeDraw);
+        parsedCommandLine->AppendSwitch(cc::switches::kDisableCheckerImaging);
+        parsedCommandLine->AppendSwitch(cc::switches::kDisableThreadedAnimation);
+        parsedCommandLine->AppendSwitch(switches::kDisableNewContentRenderingTimeout);
+    }
+
     registerMainThreadFactories();
 
     content::ContentMainParams contentMainParams(m_mainDelegate.get());
@@ -818,6 +874,10 @@ WebEngineContext::WebEngineContext()
 
     m_devtoolsServer.reset(new DevToolsServerQt());
     m_devtoolsServer->start();
+
+    if (qEnvironmentVariableIsSet(kUiTraceFileEnv)
+            && !startUiThreadTracing(qEnvironmentVariable(kUiTraceFileEnv)))
+        qWarning("Could not start tracing the UI thread");
     // Force the initialization of MediaCaptureDevicesDispatcher on the UI
     // thread to avoid a thread check assertion in its constructor when it
     // first gets referenced on the IO thread.
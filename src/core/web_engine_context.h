@@ -94,6 +94,7 @@ class AccessibilityActivationObserver;
 class ContentMainDelegateQt;
 class DevToolsServerQt;
 class ProfileAdapter;
+class UiThreadTracer;
 
 bool usingSoftwareDynamicGL();
 
@@ -125,6 +126,12 @@ public:
     static gpu::SyncPointManager *syncPointManager();
 
     static bool isGpuServiceOnUIThread();
+    static bool isHeadlessCompositing();
+
+    // Records the UI thread's Qt event loop and Chromium tasks into a Chrome
+    // JSON trace file, which is written when tracing stops.
+    bool startUiThreadTracing(const QString &fileName);
+    void stopUiThreadTracing();
 
 private:
     friend class base::RefCounted<WebEngineContext>;
@@ -145,6 +152,7 @@ private:
     std::unique_ptr<QObject> m_globalQObject;
     std::unique_ptr<ProfileAdapter> m_defaultProfileAdapter;
     std::unique_ptr<DevToolsServerQt> m_devtoolsServer;
+    std::unique_ptr<UiThreadTracer> m_uiThreadTracer;
     QList<ProfileAdapter*> m_profileAdapters;
 #if QT_CONFIG(accessibility)
     std::unique_ptr<AccessibilityActivationObserver> m_accessibilityActivationObserver;
@@ -296,6 +296,7 @@ void WebEngineSettings::initDefaults()
 #else
         s_defaultAttributes.insert(QWebEngineSettings::PdfViewerEnabled, false);
 #endif
+        s_defaultAttributes.insert(QWebEngineSettings::BinaryWebChannelTransportEnabled, false);
     }
 
     if (s_defaultFontFamilies.isEmpty()) {
@@ -36,6 +36,12 @@
 
 #include "qpdfdocument.h"
 #include "qpdfdocument_p.h"
+#include "qpdfimagepool_p.h"
+#include "qpdfrangefetcher.h"
+#include "qpdfrenderprocesspool_p.h"
+#include "qpdftextindex_p.h"
+#include "qpdftextrun_p.h"
+#include "qpdftilecache_p.h"
 
 #include "third_party/pdfium/public/fpdf_doc.h"
 #include "third_party/pdfium/public/fpdf_text.h"
@@ -44,16 +50,28 @@
 #include <QDebug>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QHash>
 #include <QLoggingCategory>
 #include <QMutex>
+#include <QQueue>
+#include <QThread>
 #include <QVector2D>
+#include <QWaitCondition>
+
+#include <memory>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
 Q_GLOBAL_STATIC(QRecursiveMutex, pdfMutex)
 static int libraryRefCount;
 static const double CharacterHitTolerance = 16.0;
+// How many pages extractText() may extract before the sink has taken them.
+static const int MaxPagesExtractedAhead = 8;
+// How much of a progressively loaded document to fetch at a time, when
+// nothing in particular is waiting for data.
+static const qint64 FetchChunkSize = 256 * 1024;
 Q_LOGGING_CATEGORY(qLcDoc, "qt.pdf.document")
 
 QPdfMutexLocker::QPdfMutexLocker()
@@ -103,8 +121,21 @@ QPdfDocumentPrivate::~QPdfDocumentPrivate()
 
 void QPdfDocumentPrivate::clear()
 {
+    if (const quint64 id = renderProcessDocument.fetchAndStoreRelaxed(0))
+        QPdfRenderProcessPool::instance()->detachDocument(id);
+    if (tileCacheKey) {
+        QPdfTileCache::instance()->removeDocument(tileCacheKey);
+        tileCacheKey = 0;
+    }
+    // Stops the indexing thread before the document goes away.
+    textIndex.reset();
+    if (rangeFetcher)
+        rangeFetcher->disconnect(q);
+    rangeFetcher = nullptr;
+
     QPdfMutexLocker lock;
 
+    closePages();
     if (doc)
         FPDF_CloseDocument(doc);
     doc = nullptr;
@@ -112,8 +143,22 @@ void QPdfDocumentPrivate::clear()
     if (avail)
         FPDFAvail_Destroy(avail);
     avail = nullptr;
+
+    progressive = false;
+    allDataFetched.storeRelaxed(0);
+    fetchedData.clear();
+    fetchedRanges.clear();
     lock.unlock();
 
+    requestedRanges.clear();
+    hintedRanges.clear();
+    estimatedPageSize = QSizeF();
+    {
+        const QMutexLocker locker(&availabilityMutex);
+        availablePages.clear();
+        wantedPages.clear();
+    }
+
     if (pageCount != 0) {
         pageCount = 0;
         emit q->pageCountChanged(pageCount);
@@ -129,6 +174,58 @@ void QPdfDocumentPrivate::clear()
         sequentialSourceDevice->disconnect(q);
 }
 
+QPdfDocumentPrivate::LoadedPage *QPdfDocumentPrivate::loadedPage(int page)
+{
+    for (qsizetype i = 0; i < loadedPages.count(); ++i) {
+        if (loadedPages.at(i).page == page) {
+            loadedPages.move(i, 0);
+            return &loadedPages.first();
+        }
+    }
+    // A page loaded before all of its data has arrived would stay cached
+    // without it.
+    if (!doc || !checkPageComplete(page))
+        return nullptr;
+    FPDF_PAGE pdfPage = FPDF_LoadPage(doc, page);
+    if (!pdfPage)
+        return nullptr;
+    if (loadedPages.count() >= MaxLoadedPages) {
+        const LoadedPage &last = loadedPages.constLast();
+        if (last.textPage)
+            FPDFText_ClosePage(last.textPage);
+        FPDF_ClosePage(last.pdfPage);
+        loadedPages.removeLast();
+    }
+    loadedPages.prepend({page, pdfPage, nullptr});
+    return &loadedPages.first();
+}
+
+FPDF_PAGE QPdfDocumentPrivate::loadPage(int page)
+{
+    LoadedPage *loaded = loadedPage(page);
+    return loaded ? loaded->pdfPage : nullptr;
+}
+
+FPDF_TEXTPAGE QPdfDocumentPrivate::loadTextPage(int page)
+{
+    LoadedPage *loaded = loadedPage(page);
+    if (!loaded)
+        return nullptr;
+    if (!loaded->textPage)
+        loaded->textPage = FPDFText_LoadPage(loaded->pdfPage);
+    return loaded->textPage;
+}
+
+void QPdfDocumentPrivate::closePages()
+{
+    for (const LoadedPage &loaded : qAsConst(loadedPages)) {
+        if (loaded.textPage)
+            FPDFText_ClosePage(loaded.textPage);
+        FPDF_ClosePage(loaded.pdfPage);
+    }
+    loadedPages.clear();
+}
+
 void QPdfDocumentPrivate::updateLastError()
 {
     if (doc) {
@@ -319,6 +416,9 @@ void QPdfDocumentPrivate::checkComplete()
 
     QPdfMutexLocker lock;
 
+    // Pages loaded while the data was incomplete are parsed again.
+    closePages();
+
     const int newPageCount = FPDF_GetPageCount(doc);
     for (int i = 0; i < newPageCount; ++i) {
         int result = PDF_DATA_NOTAVAIL;
@@ -349,6 +449,8 @@ bool QPdfDocumentPrivate::checkPageComplete(int page)
 
     if (loadComplete)
         return true;
+    if (progressive)
+        return isPageAvailable(page);
 
     QPdfMutexLocker lock;
     int result = PDF_DATA_NOTAVAIL;
@@ -362,11 +464,268 @@ bool QPdfDocumentPrivate::checkPageComplete(int page)
     return (result != PDF_DATA_ERROR);
 }
 
+void QPdfDocumentPrivate::attachToRenderProcess()
+{
+    QPdfRenderProcessPool *pool = QPdfRenderProcessPool::instance();
+    if (!pool->processCount() || renderProcessDocument.loadRelaxed())
+        return;
+
+    // The render process opens local files itself. Documents that are in
+    // memory already are handed over as data, sharing the buffer until the
+    // process has it. Other devices would have to be copied first, so their
+    // documents are rendered here.
+    QString fileName;
+    QByteArray data;
+    QFile *file = qobject_cast<QFile *>(ownDevice.data());
+    if (file && !file->fileName().startsWith(QLatin1Char(':'))) {
+        fileName = QFileInfo(*file).absoluteFilePath();
+    } else if (progressive) {
+        if (!allDataFetched.loadAcquire())
+            return;
+        data = fetchedData;
+    } else if (device == &asyncBuffer) {
+        data = asyncBuffer.data();
+    } else if (QBuffer *buffer = qobject_cast<QBuffer *>(device.data())) {
+        data = buffer->data();
+    }
+    if (fileName.isEmpty() && data.isEmpty())
+        return;
+
+    renderProcessDocument.storeRelease(pool->attachDocument(fileName, data, password));
+}
+
+QPdfTextIndex *QPdfDocumentPrivate::ensureTextIndex()
+{
+    if (!textIndex && doc && status == QPdfDocument::Ready
+            && (!progressive || allDataFetched.loadAcquire())) {
+        textIndex.reset(new QPdfTextIndex(doc, pageCount));
+        textIndex->start();
+    }
+    return textIndex.data();
+}
+
+void QPdfDocumentPrivate::loadFromFetcher(QPdfRangeFetcher *fetcher)
+{
+    rangeFetcher = fetcher;
+    progressive = true;
+
+    QObject::connect(fetcher, &QPdfRangeFetcher::dataFetched, q,
+                     [this](qint64 offset, const QByteArray &data) { dataFetched(offset, data); });
+    QObject::connect(fetcher, &QPdfRangeFetcher::errorOccurred, q, [this]() {
+        if (doc) {
+            qWarning() << "QPdfDocument: failed to fetch the rest of the document";
+            return;
+        }
+        lastError = QPdfDocument::UnknownError;
+        setStatus(QPdfDocument::Error);
+    });
+
+    if (fetcher->size() >= 0) {
+        startFetching(fetcher->size());
+    } else {
+        QObject::connect(fetcher, &QPdfRangeFetcher::sizeChanged, q, [this](qint64 size) {
+            if (!avail)
+                startFetching(size);
+        });
+    }
+}
+
+void QPdfDocumentPrivate::startFetching(qint64 size)
+{
+    if (size <= 0) {
+        lastError = QPdfDocument::InvalidFileFormatError;
+        setStatus(QPdfDocument::Error);
+        return;
+    }
+
+    {
+        const QPdfMutexLocker lock;
+        fetchedData = QByteArray(size, Qt::Uninitialized);
+    }
+    initiateAsyncLoadWithTotalSizeKnown(size);
+    // PDFium says what it needs first, through fpdf_AddSegment().
+    updateProgressiveLoad();
+}
+
+void QPdfDocumentPrivate::dataFetched(qint64 offset, const QByteArray &data)
+{
+    if (!progressive || !avail || offset < 0 || offset >= qint64(m_FileLen) || data.isEmpty())
+        return;
+
+    const qint64 length = qMin(qint64(data.size()), qint64(m_FileLen) - offset);
+    {
+        const QPdfMutexLocker lock;
+        memcpy(fetchedData.data() + offset, data.constData(), length);
+        fetchedRanges.add(offset, length);
+    }
+    requestedRanges.remove(offset, length);
+    updateProgressiveLoad();
+}
+
+void QPdfDocumentPrivate::queueProgressiveUpdate()
+{
+    if (!progressiveUpdateQueued.testAndSetRelaxed(0, 1))
+        return;
+    QMetaObject::invokeMethod(q, [this]() {
+        progressiveUpdateQueued.storeRelaxed(0);
+        updateProgressiveLoad();
+    }, Qt::QueuedConnection);
+}
+
+// Only called on the document's thread, so that the hints that PDFium gives
+// while checking availability are only collected there.
+void QPdfDocumentPrivate::updateProgressiveLoad()
+{
+    if (!progressive || !avail || status == QPdfDocument::Error)
+        return;
+
+    bool becameReady = false;
+    bool becameComplete = false;
+    QList<int> nowAvailable;
+
+    QPdfMutexLocker lock;
+    if (!doc) {
+        switch (FPDFAvail_IsDocAvail(avail, this)) {
+        case PDF_DATA_NOTAVAIL:
+            lock.unlock();
+            fetchMissingData();
+            return;
+        case PDF_DATA_ERROR:
+            lock.unlock();
+            lastError = QPdfDocument::InvalidFileFormatError;
+            setStatus(QPdfDocument::Error);
+            return;
+        }
+
+        doc = FPDFAvail_GetDocument(avail, password);
+        if (!doc) {
+            lock.unlock();
+            updateLastError();
+            setStatus(QPdfDocument::Error);
+            if (lastError == QPdfDocument::IncorrectPasswordError)
+                emit q->passwordRequired();
+            return;
+        }
+
+        // Until the other pages are there, guess that they are as big as the first one.
+        pageCount = FPDF_GetPageCount(doc);
+        const int firstPage = qMax(0, FPDFAvail_GetFirstPageNum(doc));
+        double width = 0;
+        double height = 0;
+        if (FPDF_GetPageSizeByIndex(doc, firstPage, &width, &height))
+            estimatedPageSize = QSizeF(width, height);
+        const QMutexLocker locker(&availabilityMutex);
+        if (firstPage < pageCount)
+            wantedPages.insert(firstPage);
+        becameReady = true;
+    }
+
+    {
+        const QMutexLocker locker(&availabilityMutex);
+        for (auto it = wantedPages.begin(); it != wantedPages.end(); ) {
+            const int page = *it;
+            const int result = FPDFAvail_IsPageAvail(avail, page, this);
+            if (result == PDF_DATA_NOTAVAIL) {
+                ++it;
+                continue;
+            }
+            if (result == PDF_DATA_AVAIL && !availablePages.contains(page)) {
+                availablePages.insert(page);
+                nowAvailable.append(page);
+            }
+            it = wantedPages.erase(it);
+        }
+
+        if (fetchedRanges.contains(0, m_FileLen)) {
+            for (int page = 0; page < pageCount; ++page) {
+                if (!availablePages.contains(page))
+                    nowAvailable.append(page);
+            }
+            availablePages.clear();
+            wantedPages.clear();
+            allDataFetched.storeRelease(1);
+            loadComplete = true;
+            becameComplete = true;
+        }
+    }
+    lock.unlock();
+
+    if (becameReady) {
+        qCDebug(qLcDoc) << "document with" << pageCount << "pages available; first page size" << estimatedPageSize;
+        emit q->pageCountChanged(pageCount);
+        setStatus(QPdfDocument::Ready);
+    } else if (becameComplete) {
+        attachToRenderProcess();
+    }
+    for (int page : qAsConst(nowAvailable))
+        emit q->pageAvailable(page);
+
+    fetchMissingData();
+}
+
+void QPdfDocumentPrivate::fetchMissingData()
+{
+    if (!rangeFetcher || allDataFetched.loadRelaxed())
+        return;
+
+    // First what PDFium asked for, to open the document or the wanted pages...
+    const QList<QPdfByteRangeSet::Range> hints = std::exchange(hintedRanges, {});
+    for (const QPdfByteRangeSet::Range &hint : hints) {
+        for (const QPdfByteRangeSet::Range &missing : fetchedRanges.gaps(hint.start, hint.length)) {
+            for (const QPdfByteRangeSet::Range &range : requestedRanges.gaps(missing.start, missing.length)) {
+                requestedRanges.add(range.start, range.length);
+                rangeFetcher->fetch(range.start, range.length);
+            }
+        }
+    }
+
+    // ...and when nothing is waiting, the rest of the document in order.
+    if (requestedRanges.isEmpty()) {
+        const QList<QPdfByteRangeSet::Range> missing = fetchedRanges.gaps(0, m_FileLen);
+        if (!missing.isEmpty()) {
+            const qint64 length = qMin(missing.first().length, FetchChunkSize);
+            requestedRanges.add(missing.first().start, length);
+            rangeFetcher->fetch(missing.first().start, length);
+        }
+    }
+}
+
+bool QPdfDocumentPrivate::isPageAvailable(int page)
+{
+    if (page < 0 || page >= pageCount)
+        return false;
+    if (!progressive || allDataFetched.loadAcquire())
+        return true;
+
+    const QMutexLocker locker(&availabilityMutex);
+    return availablePages.contains(page);
+}
+
+void QPdfDocumentPrivate::requestPage(int page)
+{
+    if (page < 0 || page >= pageCount || !progressive || allDataFetched.loadAcquire())
+        return;
+
+    const QMutexLocker locker(&availabilityMutex);
+    if (availablePages.contains(page) || wantedPages.contains(page))
+        return;
+    // PDFium will say what is missing the next time the pages are checked.
+    wantedPages.insert(page);
+    queueProgressiveUpdate();
+}
+
 void QPdfDocumentPrivate::setStatus(QPdfDocument::Status documentStatus)
 {
     if (status == documentStatus)
         return;
 
+    if (documentStatus == QPdfDocument::Ready) {
+        static QAtomicInteger<quint64> nextTileCacheKey = 0;
+        if (!tileCacheKey)
+            tileCacheKey = ++nextTileCacheKey;
+        attachToRenderProcess();
+    }
+
     status = documentStatus;
     emit q->statusChanged(status);
 }
@@ -374,12 +733,20 @@ void QPdfDocumentPrivate::setStatus(QPdfDocument::Status documentStatus)
 FPDF_BOOL QPdfDocumentPrivate::fpdf_IsDataAvail(_FX_FILEAVAIL *pThis, size_t offset, size_t size)
 {
     QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(pThis);
+    if (d->progressive)
+        return d->fetchedRanges.contains(offset, size);
     return offset + size <= static_cast<quint64>(d->device->size());
 }
 
 int QPdfDocumentPrivate::fpdf_GetBlock(void *param, unsigned long position, unsigned char *pBuf, unsigned long size)
 {
     QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(reinterpret_cast<FPDF_FILEACCESS*>(param));
+    if (d->progressive) {
+        if (!d->fetchedRanges.contains(position, size))
+            return 0;
+        memcpy(pBuf, d->fetchedData.constData() + position, size);
+        return 1;
+    }
     d->device->seek(position);
     return qMax(qint64(0), d->device->read(reinterpret_cast<char *>(pBuf), size));
 
@@ -387,9 +754,9 @@ int QPdfDocumentPrivate::fpdf_GetBlock(void *param, unsigned long position, unsi
 
 void QPdfDocumentPrivate::fpdf_AddSegment(_FX_DOWNLOADHINTS *pThis, size_t offset, size_t size)
 {
-    Q_UNUSED(pThis);
-    Q_UNUSED(offset);
-    Q_UNUSED(size);
+    QPdfDocumentPrivate *d = static_cast<QPdfDocumentPrivate*>(pThis);
+    if (d->progressive)
+        d->hintedRanges.append({qint64(offset), qint64(size)});
 }
 
 QString QPdfDocumentPrivate::getText(FPDF_TEXTPAGE textPage, int startIndex, int count)
@@ -420,14 +787,190 @@ QRectF QPdfDocumentPrivate::getCharBox(FPDF_TEXTPAGE textPage, double pageHeight
     return QRectF(l, pageHeight - t, r - l, t - b);
 }
 
+bool QPdfDocumentPrivate::extractTextRuns(int page, QSizeF *pageSize, QList<QPdfTextRun> *runs)
+{
+    if (!isPageAvailable(page))
+        return false;
+    FPDF_PAGE pdfPage = FPDF_LoadPage(doc, page);
+    if (!pdfPage)
+        return false;
+    const double pageHeight = FPDF_GetPageHeight(pdfPage);
+    *pageSize = QSizeF(FPDF_GetPageWidth(pdfPage), pageHeight);
+    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    if (!textPage) {
+        FPDF_ClosePage(pdfPage);
+        return false;
+    }
+
+    std::unique_ptr<QPdfTextRunPrivate> run;
+    QByteArray runFont;
+    QByteArray font(64, Qt::Uninitialized);
+    auto finishRun = [&]() {
+        if (!run)
+            return;
+        while (run->text.endsWith(QLatin1Char(' ')))
+            run->text.chop(1);
+        if (!run->text.isEmpty())
+            runs->append(QPdfTextRun(run.release()));
+        run.reset();
+    };
+
+    // Characters come in PDFium's reading order. A run ends at a line break,
+    // or where the font changes or the text moves to another line.
+    const int count = FPDFText_CountChars(textPage);
+    for (int i = 0; i < count; ++i) {
+        const char32_t unicode = FPDFText_GetUnicode(textPage, i);
+        if (unicode == '\r' || unicode == '\n') {
+            finishRun();
+            continue;
+        }
+        if (FPDFText_IsGenerated(textPage, i)) {
+            // a space that PDFium inserted between words
+            if (run)
+                run->text.append(QChar(unicode));
+            continue;
+        }
+
+        int flags = 0;
+        unsigned long fontLength = FPDFText_GetFontInfo(textPage, i, font.data(), font.size(), &flags);
+        if (fontLength > unsigned(font.size())) {
+            font.resize(fontLength);
+            fontLength = FPDFText_GetFontInfo(textPage, i, font.data(), font.size(), &flags);
+        }
+        const QByteArray fontName = QByteArray::fromRawData(font.constData(), fontLength > 0 ? fontLength - 1 : 0);
+        const qreal fontSize = FPDFText_GetFontSize(textPage, i);
+        const QRectF box = getCharBox(textPage, pageHeight, i);
+
+        bool sameRun = run && fontName == runFont && qFuzzyCompare(fontSize, run->fontSize);
+        if (sameRun && !box.isEmpty() && !run->boundingRect.isEmpty()) {
+            const QRectF &bounds = run->boundingRect;
+            const qreal overlap = qMin(bounds.bottom(), box.bottom()) - qMax(bounds.top(), box.top());
+            sameRun = overlap > qMin(bounds.height(), box.height()) / 2;
+        }
+        if (!sameRun) {
+            finishRun();
+            run.reset(new QPdfTextRunPrivate);
+            run->page = page;
+            run->fontName = QString::fromUtf8(fontName);
+            run->fontSize = fontSize;
+            run->startIndex = i;
+            runFont = QByteArray(fontName.constData(), fontName.size());
+        }
+        if (!box.isEmpty())
+            run->boundingRect = run->boundingRect.isEmpty() ? box : run->boundingRect.united(box);
+        if (QChar::requiresSurrogates(unicode)) {
+            run->text.append(QChar::highSurrogate(unicode));
+            run->text.append(QChar::lowSurrogate(unicode));
+        } else {
+            run->text.append(QChar(unicode));
+        }
+    }
+    finishRun();
+
+    FPDFText_ClosePage(textPage);
+    FPDF_ClosePage(pdfPage);
+    return true;
+}
+
+bool QPdfDocumentPrivate::renderPage(int page, QImage *image, QPdfDocumentRenderOptions renderOptions)
+{
+    const QPdfMutexLocker lock;
+
+    QElapsedTimer timer;
+    if (Q_UNLIKELY(qLcDoc().isDebugEnabled()))
+        timer.start();
+    FPDF_PAGE pdfPage = loadPage(page);
+    if (!pdfPage)
+        return false;
+
+    // PDFium draws the page's content over what is in the bitmap.
+    const QSize imageSize = image->size();
+    const bool opaque = (image->format() == QImage::Format_RGB32
+                         || renderOptions.renderFlags().testFlag(QPdf::RenderOpaque));
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(image->width(), image->height(),
+                                             image->format() == QImage::Format_RGB32 ? FPDFBitmap_BGRx : FPDFBitmap_BGRA,
+                                             image->bits(), image->bytesPerLine());
+    FPDFBitmap_FillRect(bitmap, 0, 0, image->width(), image->height(), opaque ? 0xFFFFFFFF : 0x00000000);
+
+    int rotation = 0;
+    switch (renderOptions.rotation()) {
+    case QPdf::Rotate0:
+        rotation = 0;
+        break;
+    case QPdf::Rotate90:
+        rotation = 1;
+        break;
+    case QPdf::Rotate180:
+        rotation = 2;
+        break;
+    case QPdf::Rotate270:
+        rotation = 3;
+        break;
+    }
+
+    const QPdf::RenderFlags renderFlags = renderOptions.renderFlags();
+    int flags = 0;
+    if (renderFlags & QPdf::RenderAnnotations)
+        flags |= FPDF_ANNOT;
+    if (renderFlags & QPdf::RenderOptimizedForLcd)
+        flags |= FPDF_LCD_TEXT;
+    if (renderFlags & QPdf::RenderGrayscale)
+        flags |= FPDF_GRAYSCALE;
+    if (renderFlags & QPdf::RenderForceHalftone)
+        flags |= FPDF_RENDER_FORCEHALFTONE;
+    if (renderFlags & QPdf::RenderTextAliased)
+        flags |= FPDF_RENDER_NO_SMOOTHTEXT;
+    if (renderFlags & QPdf::RenderImageAliased)
+        flags |= FPDF_RENDER_NO_SMOOTHIMAGE;
+    if (renderFlags & QPdf::RenderPathAliased)
+        flags |= FPDF_RENDER_NO_SMOOTHPATH;
+
+    if (renderOptions.scaledClipRect().isValid()) {
+        const QRect &clipRect = renderOptions.scaledClipRect();
+
+        // TODO take rotation into account, like cpdf_page.cpp lines 145-178
+        float x0 = clipRect.left();
+        float y0 = clipRect.top();
+        float x1 = clipRect.left();
+        float y1 = clipRect.bottom();
+        float x2 = clipRect.right();
+        float y2 = clipRect.top();
+        QSizeF origSize = q->pageSize(page);
+        QVector2D pageScale(1, 1);
+        if (!renderOptions.scaledSize().isNull()) {
+            pageScale = QVector2D(renderOptions.scaledSize().width() / float(origSize.width()),
+                                  renderOptions.scaledSize().height() / float(origSize.height()));
+        }
+        FS_MATRIX matrix {(x2 - x0) / image->width() * pageScale.x(),
+                          (y2 - y0) / image->width() * pageScale.x(),
+                          (x1 - x0) / image->height() * pageScale.y(),
+                          (y1 - y0) / image->height() * pageScale.y(), -x0, -y0};
+
+        FS_RECTF clipRectF { 0, 0, float(imageSize.width()), float(imageSize.height()) };
+
+        FPDF_RenderPageBitmapWithMatrix(bitmap, pdfPage, &matrix, &clipRectF, flags);
+        qCDebug(qLcDoc) << "matrix" << matrix.a << matrix.b << matrix.c << matrix.d << matrix.e << matrix.f;
+        qCDebug(qLcDoc) << "page" << page << "region" << renderOptions.scaledClipRect()
+                        << "size" << imageSize << "took" << timer.elapsed() << "ms";
+    } else {
+        FPDF_RenderPageBitmap(bitmap, pdfPage, 0, 0, image->width(), image->height(), rotation, flags);
+        qCDebug(qLcDoc) << "page" << page << "size" << imageSize << "took" << timer.elapsed() << "ms";
+    }
+
+    FPDFBitmap_Destroy(bitmap);
+
+    return true;
+}
+
 QPdfDocumentPrivate::TextPosition QPdfDocumentPrivate::hitTest(int page, QPointF position)
 {
     const QPdfMutexLocker lock;
 
     TextPosition result;
-    FPDF_PAGE pdfPage = FPDF_LoadPage(doc, page);
-    double pageHeight = FPDF_GetPageHeight(pdfPage);
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = loadTextPage(page);
+    if (!textPage)
+        return result;
+    double pageHeight = FPDF_GetPageHeight(loadPage(page));
     int hitIndex = FPDFText_GetCharIndexAtPos(textPage, position.x(), pageHeight - position.y(),
                                               CharacterHitTolerance, CharacterHitTolerance);
     if (hitIndex >= 0) {
@@ -445,9 +988,6 @@ QPdfDocumentPrivate::TextPosition QPdfDocumentPrivate::hitTest(int page, QPointF
         }
     }
 
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(pdfPage);
-
     return result;
 }
 
@@ -502,6 +1042,8 @@ QPdfDocument::DocumentError QPdfDocument::load(const QString &fileName)
     \value Null The initial status after the document has been created or after it has been closed.
     \value Loading The status after load() has been called and before the document is fully loaded.
     \value Ready The status when the document is fully loaded and its data can be accessed.
+                 A document loaded from a QPdfRangeFetcher is ready as soon as its
+                 structure and first page have arrived; see isPageAvailable().
     \value Unloading The status after close() has been called on an open document.
                      At this point the document is still valid and all its data can be accessed.
     \value Error The status after Loading, if loading has failed.
@@ -526,6 +1068,36 @@ void QPdfDocument::load(QIODevice *device)
     d->load(device, /*transfer ownership*/false);
 }
 
+/*!
+    \since 6.3
+
+    Loads the document progressively through \a fetcher, which must stay
+    alive while the document is open.
+
+    The document asks \a fetcher for the parts it needs to open the document
+    and show its first page, and becomes \l Ready as soon as they have
+    arrived. Pages that are rendered, directly or through QPdfPageRenderer,
+    are fetched next, and then the rest of the document in order.
+    pageAvailable() is emitted as the pages can be used. This works best with
+    linearized documents; other documents need most of their data before they
+    can be opened.
+
+    \sa QPdfRangeFetcher
+*/
+void QPdfDocument::load(QPdfRangeFetcher *fetcher)
+{
+    close();
+
+    d->setStatus(QPdfDocument::Loading);
+
+    if (!fetcher) {
+        d->lastError = FileNotFoundError;
+        d->setStatus(QPdfDocument::Error);
+        return;
+    }
+    d->loadFromFetcher(fetcher);
+}
+
 void QPdfDocument::setPassword(const QString &password)
 {
     const QByteArray newPassword = password.toUtf8();
@@ -645,7 +1217,7 @@ QPdfDocument::DocumentError QPdfDocument::error() const
 */
 void QPdfDocument::close()
 {
-    if (!d->doc)
+    if (!d->doc && !d->progressive)
         return;
 
     d->setStatus(Unloading);
@@ -672,8 +1244,11 @@ int QPdfDocument::pageCount() const
 QSizeF QPdfDocument::pageSize(int page) const
 {
     QSizeF result;
-    if (!d->doc || !d->checkPageComplete(page))
+    if (!d->doc || page < 0 || page >= d->pageCount)
         return result;
+    // An estimate, while the page is still being fetched.
+    if (!d->checkPageComplete(page))
+        return d->progressive ? d->estimatedPageSize : result;
 
     const QPdfMutexLocker lock;
 
@@ -681,6 +1256,34 @@ QSizeF QPdfDocument::pageSize(int page) const
     return result;
 }
 
+/*!
+    \since 6.3
+
+    Returns whether the data of \a page is there, so that it can be rendered
+    and its text extracted. This is always the case once the document is
+    \l Ready, unless it is loaded progressively from a QPdfRangeFetcher. This
+    function does not fetch anything; rendering the page fetches its data
+    with priority, and pageAvailable() is emitted when it has arrived.
+
+    \sa pageAvailable(), render()
+*/
+bool QPdfDocument::isPageAvailable(int page) const
+{
+    return d->isPageAvailable(page);
+}
+
+/*!
+    \fn void QPdfDocument::pageAvailable(int page)
+    \since 6.3
+
+    This signal is emitted when the data of \a page has arrived, while the
+    document is loaded from a QPdfRangeFetcher. It is emitted once for every
+    page: first for the first page and the pages that were asked for, and for
+    all the others when the whole document has arrived.
+
+    \sa isPageAvailable(), load()
+*/
+
 /*!
     Renders the \a page into a QImage of size \a imageSize according to the
     provided \a renderOptions.
@@ -690,94 +1293,62 @@ QSizeF QPdfDocument::pageSize(int page) const
     Note: If the \a imageSize does not match the aspect ratio of the page in the
     PDF document, the page is rendered scaled, so that it covers the
     complete \a imageSize.
+
+    PDFium can only be used by one thread at a time, so all documents of a
+    process are rendered one after the other. If the environment variable
+    \c QT_PDF_RENDER_PROCESSES is set to a number greater than zero, that many
+    helper processes are started, and each document is rendered by one of
+    them. Renders of documents in different processes then run in parallel,
+    while this function waits for its own result.
 */
 QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions renderOptions)
 {
-    if (!d->doc || !d->checkPageComplete(page))
+    if (!d->doc || !d->checkPageComplete(page)) {
+        d->requestPage(page);
         return QImage();
+    }
 
-    const QPdfMutexLocker lock;
+    if (const quint64 id = d->renderProcessDocument.loadAcquire()) {
+        const QImage image = QPdfRenderProcessPool::instance()->render(id, page, imageSize, renderOptions);
+        if (!image.isNull())
+            return image;
+    }
 
-    QElapsedTimer timer;
-    if (Q_UNLIKELY(qLcDoc().isDebugEnabled()))
-        timer.start();
-    FPDF_PAGE pdfPage = FPDF_LoadPage(d->doc, page);
-    if (!pdfPage)
+    QImage result = QPdfImagePool::instance()->image(
+            imageSize, renderOptions.renderFlags().testFlag(QPdf::RenderOpaque)
+                       ? QImage::Format_RGB32 : QImage::Format_ARGB32);
+    if (result.isNull() || !d->renderPage(page, &result, renderOptions))
         return QImage();
+    return result;
+}
 
-    QImage result(imageSize, QImage::Format_ARGB32);
-    result.fill(Qt::transparent);
-    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(result.width(), result.height(), FPDFBitmap_BGRA, result.bits(), result.bytesPerLine());
-
-    int rotation = 0;
-    switch (renderOptions.rotation()) {
-    case QPdf::Rotate0:
-        rotation = 0;
-        break;
-    case QPdf::Rotate90:
-        rotation = 1;
-        break;
-    case QPdf::Rotate180:
-        rotation = 2;
-        break;
-    case QPdf::Rotate270:
-        rotation = 3;
-        break;
+/*!
+    \since 6.3
+
+    Renders the \a page into \a image, according to the provided
+    \a renderOptions, and returns whether it succeeded. The page is scaled
+    to the size of \a image, whose format must be QImage::Format_ARGB32 or
+    QImage::Format_RGB32.
+
+    Unlike the overload that returns a new image, this does not allocate: an
+    image that is reused, for example from a pool of thumbnails of the same
+    size, is rendered into directly. The page is drawn over a transparent
+    background, or over white if the image is opaque or
+    QPdf::RenderOpaque is set. It is always rendered in this process.
+*/
+bool QPdfDocument::render(int page, QImage *image, QPdfDocumentRenderOptions renderOptions)
+{
+    if (!image || image->isNull() || !d->doc)
+        return false;
+    if (!d->checkPageComplete(page)) {
+        d->requestPage(page);
+        return false;
     }
-
-    const QPdf::RenderFlags renderFlags = renderOptions.renderFlags();
-    int flags = 0;
-    if (renderFlags & QPdf::RenderAnnotations)
-        flags |= FPDF_ANNOT;
-    if (renderFlags & QPdf::RenderOptimizedForLcd)
-        flags |= FPDF_LCD_TEXT;
-    if (renderFlags & QPdf::RenderGrayscale)
-        flags |= FPDF_GRAYSCALE;
-    if (renderFlags & QPdf::RenderForceHalftone)
-        flags |= FPDF_RENDER_FORCEHALFTONE;
-    if (renderFlags & QPdf::RenderTextAliased)
-        flags |= FPDF_RENDER_NO_SMOOTHTEXT;
-    if (renderFlags & QPdf::RenderImageAliased)
-        flags |= FPDF_RENDER_NO_SMOOTHIMAGE;
-    if (renderFlags & QPdf::RenderPathAliased)
-        flags |= FPDF_RENDER_NO_SMOOTHPATH;
-
-    if (renderOptions.scaledClipRect().isValid()) {
-        const QRect &clipRect = renderOptions.scaledClipRect();
-
-        // TODO take rotation into account, like cpdf_page.cpp lines 145-178
-        float x0 = clipRect.left();
-        float y0 = clipRect.top();
-        float x1 = clipRect.left();
-        float y1 = clipRect.bottom();
-        float x2 = clipRect.right();
-        float y2 = clipRect.top();
-        QSizeF origSize = pageSize(page);
-        QVector2D pageScale(1, 1);
-        if (!renderOptions.scaledSize().isNull()) {
-            pageScale = QVector2D(renderOptions.scaledSize().width() / float(origSize.width()),
-                                  renderOptions.scaledSize().height() / float(origSize.height()));
-        }
-        FS_MATRIX matrix {(x2 - x0) / result.width() * pageScale.x(),
-                          (y2 - y0) / result.width() * pageScale.x(),
-                          (x1 - x0) / result.height() * pageScale.y(),
-                          (y1 - y0) / result.height() * pageScale.y(), -x0, -y0};
-
-        FS_RECTF clipRectF { 0, 0, float(imageSize.width()), float(imageSize.height()) };
-
-        FPDF_RenderPageBitmapWithMatrix(bitmap, pdfPage, &matrix, &clipRectF, flags);
-        qCDebug(qLcDoc) << "matrix" << matrix.a << matrix.b << matrix.c << matrix.d << matrix.e << matrix.f;
-        qCDebug(qLcDoc) << "page" << page << "region" << renderOptions.scaledClipRect()
-                        << "size" << imageSize << "took" << timer.elapsed() << "ms";
-    } else {
-        FPDF_RenderPageBitmap(bitmap, pdfPage, 0, 0, result.width(), result.height(), rotation, flags);
-        qCDebug(qLcDoc) << "page" << page << "size" << imageSize << "took" << timer.elapsed() << "ms";
+    if (image->format() != QImage::Format_ARGB32 && image->format() != QImage::Format_RGB32) {
+        qCWarning(qLcDoc) << "cannot render into an image of format" << image->format();
+        return false;
     }
-
-    FPDFBitmap_Destroy(bitmap);
-
-    FPDF_ClosePage(pdfPage);
-    return result;
+    return d->renderPage(page, image, renderOptions);
 }
 
 /*!
@@ -787,9 +1358,10 @@ QImage QPdfDocument::render(int page, QSize imageSize, QPdfDocumentRenderOptions
 QPdfSelection QPdfDocument::getSelection(int page, QPointF start, QPointF end)
 {
     const QPdfMutexLocker lock;
-    FPDF_PAGE pdfPage = FPDF_LoadPage(d->doc, page);
-    double pageHeight = FPDF_GetPageHeight(pdfPage);
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = d->loadTextPage(page);
+    if (!textPage)
+        return QPdfSelection();
+    double pageHeight = FPDF_GetPageHeight(d->loadPage(page));
     int startIndex = FPDFText_GetCharIndexAtPos(textPage, start.x(), pageHeight - start.y(),
                                                 CharacterHitTolerance, CharacterHitTolerance);
     int endIndex = FPDFText_GetCharIndexAtPos(textPage, end.x(), pageHeight - end.y(),
@@ -828,9 +1400,6 @@ QPdfSelection QPdfDocument::getSelection(int page, QPointF start, QPointF end)
         qCDebug(qLcDoc) << page << start << "->" << end << "nothing found";
     }
 
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(pdfPage);
-
     return result;
 }
 
@@ -844,9 +1413,10 @@ QPdfSelection QPdfDocument::getSelectionAtIndex(int page, int startIndex, int ma
     if (page < 0 || startIndex < 0 || maxLength < 0)
         return {};
     const QPdfMutexLocker lock;
-    FPDF_PAGE pdfPage = FPDF_LoadPage(d->doc, page);
-    double pageHeight = FPDF_GetPageHeight(pdfPage);
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = d->loadTextPage(page);
+    if (!textPage)
+        return QPdfSelection();
+    double pageHeight = FPDF_GetPageHeight(d->loadPage(page));
     int pageCount = FPDFText_CountChars(textPage);
     if (startIndex >= pageCount)
         return QPdfSelection();
@@ -873,9 +1443,6 @@ QPdfSelection QPdfDocument::getSelectionAtIndex(int page, int startIndex, int ma
     qCDebug(qLcDoc) << "on page" << page << "at index" << startIndex << "maxLength" << maxLength
                     << "got" << text.length() << "chars," << rectCount << "rects within" << hull;
 
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(pdfPage);
-
     return QPdfSelection(text, bounds, hull, startIndex, startIndex + text.length());
 }
 
@@ -885,9 +1452,10 @@ QPdfSelection QPdfDocument::getSelectionAtIndex(int page, int startIndex, int ma
 QPdfSelection QPdfDocument::getAllText(int page)
 {
     const QPdfMutexLocker lock;
-    FPDF_PAGE pdfPage = FPDF_LoadPage(d->doc, page);
-    double pageHeight = FPDF_GetPageHeight(pdfPage);
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = d->loadTextPage(page);
+    if (!textPage)
+        return QPdfSelection();
+    double pageHeight = FPDF_GetPageHeight(d->loadPage(page));
     int count = FPDFText_CountChars(textPage);
     if (count < 1)
         return QPdfSelection();
@@ -907,12 +1475,112 @@ QPdfSelection QPdfDocument::getAllText(int page)
     }
     qCDebug(qLcDoc) << "on page" << page << "got" << count << "chars," << rectCount << "rects within" << hull;
 
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(pdfPage);
-
     return QPdfSelection(text, bounds, hull, 0, count);
 }
 
+/*!
+    \enum QPdfDocument::TextExtractionOption
+    \since 6.3
+
+    This enum describes how extractText() works.
+
+    \value ExtractInParallel Pages are extracted on a helper thread while
+           the sink processes the pages before them. The sink is still
+           called on the calling thread, in page order.
+*/
+
+/*!
+    \since 6.3
+
+    Extracts the text of the pages from \a firstPage to \a lastPage, as runs
+    with their bounding rectangles and fonts, and passes them to \a sink.
+    If \a lastPage is negative, the text is extracted up to the last page.
+
+    This walks the document once, loading each page only once, so it is much
+    faster than calling getAllText() for each page when all the text of a
+    document is needed, for example to index it. With \a options, extraction
+    can run in parallel with the work done in the sink.
+
+    Returns \c false if the document is not ready, the page range is not
+    valid, or some pages could not be loaded; those pages are skipped.
+
+    \sa QPdfTextSink, QPdfTextRun
+*/
+bool QPdfDocument::extractText(QPdfTextSink *sink, int firstPage, int lastPage, TextExtractionOptions options)
+{
+    if (!sink || d->status != Ready)
+        return false;
+    if (lastPage < 0)
+        lastPage = d->pageCount - 1;
+    if (firstPage < 0 || firstPage > lastPage || lastPage >= d->pageCount)
+        return false;
+
+    struct ExtractedPage {
+        int page = -1;
+        bool ok = false;
+        QSizeF size;
+        QList<QPdfTextRun> runs;
+    };
+    auto extract = [this](int page) {
+        ExtractedPage ret;
+        ret.page = page;
+        const QPdfMutexLocker lock;
+        ret.ok = d->extractTextRuns(page, &ret.size, &ret.runs);
+        return ret;
+    };
+    bool ok = true;
+    auto deliver = [&](const ExtractedPage &extracted) {
+        if (!extracted.ok) {
+            qCWarning(qLcDoc) << "failed to extract text of page" << extracted.page;
+            ok = false;
+            return;
+        }
+        sink->beginPage(extracted.page, extracted.size);
+        for (const QPdfTextRun &run : extracted.runs)
+            sink->addRun(run);
+        sink->endPage(extracted.page);
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!options.testFlag(ExtractInParallel)) {
+        for (int page = firstPage; page <= lastPage; ++page)
+            deliver(extract(page));
+    } else {
+        // PDFium can only be used from one thread at a time, so one helper
+        // thread extracts the pages, staying a few pages ahead of the sink.
+        QMutex mutex;
+        QWaitCondition changed;
+        QQueue<ExtractedPage> queue;
+        std::unique_ptr<QThread> thread(QThread::create([&]() {
+            for (int page = firstPage; page <= lastPage; ++page) {
+                ExtractedPage extracted = extract(page);
+                QMutexLocker locker(&mutex);
+                while (queue.count() >= MaxPagesExtractedAhead)
+                    changed.wait(&mutex);
+                queue.enqueue(std::move(extracted));
+                changed.wakeAll();
+            }
+        }));
+        thread->start();
+        for (int page = firstPage; page <= lastPage; ++page) {
+            ExtractedPage extracted;
+            {
+                QMutexLocker locker(&mutex);
+                while (queue.isEmpty())
+                    changed.wait(&mutex);
+                extracted = queue.dequeue();
+                changed.wakeAll();
+            }
+            deliver(extracted);
+        }
+        thread->wait();
+    }
+    qCDebug(qLcDoc) << "extracted text of pages" << firstPage << "to" << lastPage
+                    << "in" << timer.elapsed() << "ms";
+    return ok;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qpdfdocument.cpp"
@@ -43,10 +43,12 @@
 #include <QtGui/qimage.h>
 #include <QtPdf/qpdfdocumentrenderoptions.h>
 #include <QtPdf/qpdfselection.h>
+#include <QtPdf/qpdftextrun.h>
 
 QT_BEGIN_NAMESPACE
 
 class QPdfDocumentPrivate;
+class QPdfRangeFetcher;
 class QNetworkReply;
 
 class Q_PDF_EXPORT QPdfDocument : public QObject
@@ -90,6 +92,12 @@ public:
     };
     Q_ENUM(MetaDataField)
 
+    enum TextExtractionOption {
+        ExtractInParallel = 0x01
+    };
+    Q_DECLARE_FLAGS(TextExtractionOptions, TextExtractionOption)
+    Q_FLAG(TextExtractionOptions)
+
     explicit QPdfDocument(QObject *parent = nullptr);
     ~QPdfDocument();
 
@@ -98,6 +106,7 @@ public:
     Status status() const;
 
     void load(QIODevice *device);
+    void load(QPdfRangeFetcher *fetcher);
     void setPassword(const QString &password);
     QString password() const;
 
@@ -110,24 +119,33 @@ public:
     int pageCount() const;
 
     QSizeF pageSize(int page) const;
+    bool isPageAvailable(int page) const;
 
     QImage render(int page, QSize imageSize, QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    bool render(int page, QImage *image, QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
 
     Q_INVOKABLE QPdfSelection getSelection(int page, QPointF start, QPointF end);
     Q_INVOKABLE QPdfSelection getSelectionAtIndex(int page, int startIndex, int maxLength);
     Q_INVOKABLE QPdfSelection getAllText(int page);
 
+    bool extractText(QPdfTextSink *sink, int firstPage = 0, int lastPage = -1,
+                     TextExtractionOptions options = TextExtractionOptions());
+
 Q_SIGNALS:
     void passwordChanged();
     void passwordRequired();
     void statusChanged(QPdfDocument::Status status);
     void pageCountChanged(int pageCount);
+    void pageAvailable(int page);
 
 private:
     friend class QPdfBookmarkModelPrivate;
+    friend class QPdfDocumentPrivate;
     friend class QPdfLinkModelPrivate;
+    friend class QPdfPageRenderer;
     friend class QPdfSearchModel;
     friend class QPdfSearchModelPrivate;
+    friend class QPdfTileRenderer;
     friend class QQuickPdfSelection;
 
     Q_PRIVATE_SLOT(d, void _q_tryLoadingWithSizeFromContentHeader())
@@ -135,6 +153,8 @@ private:
     QScopedPointer<QPdfDocumentPrivate> d;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QPdfDocument::TextExtractionOptions)
+
 QT_END_NAMESPACE
 
 #endif // QPDFDOCUMENT_H
@@ -49,19 +49,25 @@
 //
 
 #include "qpdfdocument.h"
+#include "qpdfrangefetcher_p.h"
 
 #include "third_party/pdfium/public/fpdfview.h"
 #include "third_party/pdfium/public/fpdf_dataavail.h"
+#include "third_party/pdfium/public/fpdf_text.h"
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qbuffer.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qpointer.h>
+#include <QtCore/qset.h>
 #include <QtNetwork/qnetworkreply.h>
 
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
 
+class QPdfTextIndex;
+
 class QPdfMutexLocker : public std::unique_lock<QRecursiveMutex>
 {
 public:
@@ -74,6 +80,8 @@ public:
     QPdfDocumentPrivate();
     ~QPdfDocumentPrivate();
 
+    static QPdfDocumentPrivate *get(QPdfDocument *q) { return q->d.data(); }
+
     QPdfDocument *q;
 
     FPDF_AVAIL avail;
@@ -90,7 +98,63 @@ public:
     QPdfDocument::DocumentError lastError;
     int pageCount;
 
+    // The id of the copy of the document in QPdfRenderProcessPool, if any.
+    QAtomicInteger<quint64> renderProcessDocument = 0;
+    // Identifies this load of the document in QPdfTileCache; 0 until Ready.
+    quint64 tileCacheKey = 0;
+    // Built on first use, and dropped when the document is closed.
+    QScopedPointer<QPdfTextIndex> textIndex;
+
+    // Pages kept loaded, most recently used first, so that hit-testing and
+    // selection don't parse the page content again on every mouse move.
+    // The handles belong to the cache: use them only while holding the
+    // PDFium mutex, and never close them.
+    struct LoadedPage {
+        int page;
+        FPDF_PAGE pdfPage;
+        FPDF_TEXTPAGE textPage;
+    };
+    // How many pages are kept loaded.
+    static constexpr int MaxLoadedPages = 8;
+    QList<LoadedPage> loadedPages;
+    LoadedPage *loadedPage(int page);
+    FPDF_PAGE loadPage(int page);
+    FPDF_TEXTPAGE loadTextPage(int page);
+    void closePages();
+
     void clear();
+    void attachToRenderProcess();
+    QPdfTextIndex *ensureTextIndex();
+
+    // Loading progressively from a QPdfRangeFetcher. The data arrives in
+    // any order: fetchedRanges says which parts of fetchedData are there,
+    // and is only changed with the PDFium mutex held. The pages are shown as
+    // soon as their data is there, rather than when the document is complete.
+    QPointer<QPdfRangeFetcher> rangeFetcher;
+    bool progressive = false;
+    QAtomicInt allDataFetched = 0;
+    QByteArray fetchedData;
+    QPdfByteRangeSet fetchedRanges;
+    QPdfByteRangeSet requestedRanges;
+    QList<QPdfByteRangeSet::Range> hintedRanges;
+    QSizeF estimatedPageSize;
+    // Pages known to be available, and pages waiting for data; guarded by
+    // availabilityMutex, which may be locked while holding the PDFium mutex
+    // but not the other way round.
+    QMutex availabilityMutex;
+    QSet<int> availablePages;
+    QSet<int> wantedPages;
+    QAtomicInt progressiveUpdateQueued = 0;
+
+    void loadFromFetcher(QPdfRangeFetcher *fetcher);
+    void startFetching(qint64 size);
+    void dataFetched(qint64 offset, const QByteArray &data);
+    void queueProgressiveUpdate();
+    void updateProgressiveLoad();
+    void fetchMissingData();
+    bool isPageAvailable(int page);
+    // Fetches the data of page with priority, if it isn't there yet.
+    void requestPage(int page);
 
     void load(QIODevice *device, bool ownDevice);
     void loadAsync(QIODevice *device);
@@ -110,6 +174,9 @@ public:
     QString getText(FPDF_TEXTPAGE textPage, int startIndex, int count);
     QPointF getCharPosition(FPDF_TEXTPAGE textPage, double pageHeight, int charIndex);
     QRectF getCharBox(FPDF_TEXTPAGE textPage, double pageHeight, int charIndex);
+    bool renderPage(int page, QImage *image, QPdfDocumentRenderOptions renderOptions);
+    // Must be called with the PDFium mutex held.
+    bool extractTextRuns(int page, QSizeF *pageSize, QList<QPdfTextRun> *runs);
 
     struct TextPosition {
         QPointF position;
@@ -0,0 +1,185 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfimagepool_p.h"
+
+#include <QMultiHash>
+#include <QMutex>
+
+#include <cstdlib>
+
+QT_BEGIN_NAMESPACE
+
+struct QPdfImagePool::Buffers
+{
+    struct Buffer
+    {
+        QWeakPointer<Buffers> pool;
+        qsizetype bytes;
+        uchar *data;
+    };
+
+    explicit Buffers(qint64 maxIdleBytes) : maxIdleBytes(maxIdleBytes) { }
+    ~Buffers() { clear(); }
+
+    static void release(void *info);
+    static void free(Buffer *buffer);
+    void recycle(Buffer *buffer);
+    void trim();
+    void clear();
+
+    QMutex mutex;
+    // Idle buffers by size in bytes: an image only needs as many bytes as
+    // before, not the same width and height.
+    QMultiHash<qsizetype, Buffer *> idle;
+    qint64 idleBytes = 0;
+    qint64 maxIdleBytes;
+};
+
+void QPdfImagePool::Buffers::free(Buffer *buffer)
+{
+    std::free(buffer->data);
+    delete buffer;
+}
+
+void QPdfImagePool::Buffers::release(void *info)
+{
+    Buffer *buffer = static_cast<Buffer *>(info);
+    if (const QSharedPointer<Buffers> pool = buffer->pool.toStrongRef())
+        pool->recycle(buffer);
+    else
+        free(buffer);
+}
+
+void QPdfImagePool::Buffers::recycle(Buffer *buffer)
+{
+    const QMutexLocker locker(&mutex);
+    if (buffer->bytes > maxIdleBytes) {
+        free(buffer);
+        return;
+    }
+    idle.insert(buffer->bytes, buffer);
+    idleBytes += buffer->bytes;
+    trim();
+}
+
+void QPdfImagePool::Buffers::trim()
+{
+    for (auto it = idle.begin(); it != idle.end() && idleBytes > maxIdleBytes; ) {
+        idleBytes -= it.key();
+        free(it.value());
+        it = idle.erase(it);
+    }
+}
+
+void QPdfImagePool::Buffers::clear()
+{
+    const QMutexLocker locker(&mutex);
+    for (Buffer *buffer : qAsConst(idle))
+        free(buffer);
+    idle.clear();
+    idleBytes = 0;
+}
+
+QPdfImagePool::QPdfImagePool(qint64 maxIdleBytes)
+    : m_buffers(QSharedPointer<Buffers>::create(maxIdleBytes))
+{
+}
+
+QPdfImagePool::~QPdfImagePool() = default;
+
+Q_GLOBAL_STATIC(QPdfImagePool, globalImagePool)
+
+QPdfImagePool *QPdfImagePool::instance()
+{
+    return globalImagePool();
+}
+
+QImage QPdfImagePool::image(QSize size, QImage::Format format)
+{
+    if (size.isEmpty() || format == QImage::Format_Invalid)
+        return QImage();
+
+    // Rows are 32-bit aligned, as QImage would make them.
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    const qsizetype bytesPerLine = ((qsizetype(size.width()) * depth + 31) >> 5) << 2;
+    const qsizetype bytes = bytesPerLine * size.height();
+
+    Buffers::Buffer *buffer = nullptr;
+    {
+        const QMutexLocker locker(&m_buffers->mutex);
+        const auto it = m_buffers->idle.find(bytes);
+        if (it != m_buffers->idle.end()) {
+            buffer = it.value();
+            m_buffers->idle.erase(it);
+            m_buffers->idleBytes -= bytes;
+        }
+    }
+    if (!buffer) {
+        uchar *data = static_cast<uchar *>(std::malloc(bytes));
+        if (!data)
+            return QImage();
+        buffer = new Buffers::Buffer{m_buffers.toWeakRef(), bytes, data};
+    }
+    return QImage(buffer->data, size.width(), size.height(), bytesPerLine, format,
+                  &Buffers::release, buffer);
+}
+
+qint64 QPdfImagePool::maxIdleBytes() const
+{
+    const QMutexLocker locker(&m_buffers->mutex);
+    return m_buffers->maxIdleBytes;
+}
+
+void QPdfImagePool::setMaxIdleBytes(qint64 bytes)
+{
+    const QMutexLocker locker(&m_buffers->mutex);
+    m_buffers->maxIdleBytes = bytes;
+    m_buffers->trim();
+}
+
+qint64 QPdfImagePool::idleBytes() const
+{
+    const QMutexLocker locker(&m_buffers->mutex);
+    return m_buffers->idleBytes;
+}
+
+void QPdfImagePool::clear()
+{
+    m_buffers->clear();
+}
+
+QT_END_NAMESPACE
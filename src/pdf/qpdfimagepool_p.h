@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFIMAGEPOOL_P_H
+#define QPDFIMAGEPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+
+#include <QtCore/qsharedpointer.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+// Hands out images whose pixel buffers go back to the pool when the last copy
+// of the image is destroyed, so that rendering many pages of the same size,
+// such as thumbnails or tiles, doesn't allocate a new buffer for each.
+// Thread-safe; the images may outlive the pool.
+class Q_PDF_PRIVATE_EXPORT QPdfImagePool
+{
+public:
+    static constexpr qint64 DefaultMaxIdleBytes = 32 * 1024 * 1024;
+
+    explicit QPdfImagePool(qint64 maxIdleBytes = DefaultMaxIdleBytes);
+    ~QPdfImagePool();
+
+    static QPdfImagePool *instance();
+
+    // The contents of the image are undefined.
+    QImage image(QSize size, QImage::Format format);
+
+    qint64 maxIdleBytes() const;
+    void setMaxIdleBytes(qint64 bytes);
+    qint64 idleBytes() const;
+    void clear();
+
+private:
+    Q_DISABLE_COPY(QPdfImagePool)
+
+    struct Buffers;
+    QSharedPointer<Buffers> m_buffers;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFIMAGEPOOL_P_H
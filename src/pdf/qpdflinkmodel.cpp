@@ -143,7 +143,7 @@ void QPdfLinkModelPrivate::update()
         return;
     auto doc = document->d->doc;
     const QPdfMutexLocker lock;
-    FPDF_PAGE pdfPage = FPDF_LoadPage(doc, page);
+    FPDF_PAGE pdfPage = document->d->loadPage(page);
     if (!pdfPage) {
         qCWarning(qLcLink) << "failed to load page" << page;
         return;
@@ -228,7 +228,7 @@ void QPdfLinkModelPrivate::update()
     }
 
     // Iterate the web links
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = document->d->loadTextPage(page);
     if (textPage) {
         FPDF_PAGELINK webLinks = FPDFLink_LoadWebLinks(textPage);
         if (webLinks) {
@@ -258,11 +258,9 @@ void QPdfLinkModelPrivate::update()
             }
             FPDFLink_CloseWebLinks(webLinks);
         }
-        FPDFText_ClosePage(textPage);
     }
 
     // All done
-    FPDF_ClosePage(pdfPage);
     if (Q_UNLIKELY(qLcLink().isDebugEnabled())) {
         for (const Link &l : links)
             qCDebug(qLcLink) << l.rect << l.toString();
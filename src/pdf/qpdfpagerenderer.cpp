@@ -35,12 +35,16 @@
 ****************************************************************************/
 
 #include "qpdfpagerenderer.h"
+#include "qpdfdocument_p.h"
 
 #include <private/qobject_p.h>
+#include <QAtomicInteger>
 #include <QMutex>
 #include <QPointer>
 #include <QThread>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 class RenderWorker : public QObject
@@ -52,6 +56,8 @@ public:
     ~RenderWorker();
 
     void setDocument(QPdfDocument *document);
+    // The last request the worker got to, from any thread.
+    quint64 startedRequestId() const { return m_startedRequestId.loadAcquire(); }
 
 public Q_SLOTS:
     void requestPage(quint64 requestId, int page, QSize imageSize,
@@ -60,22 +66,27 @@ public Q_SLOTS:
 Q_SIGNALS:
     void pageRendered(int page, QSize imageSize, const QImage &image,
                       QPdfDocumentRenderOptions options, quint64 requestId);
+    // Emitted for every request, even if the page could not be rendered.
+    void requestDone(quint64 requestId);
 
 private:
     QPointer<QPdfDocument> m_document;
     QMutex m_mutex;
+    QAtomicInteger<quint64> m_startedRequestId = 0;
 };
 
 class QPdfPageRendererPrivate
 {
 public:
-    QPdfPageRendererPrivate();
+    QPdfPageRendererPrivate(QPdfPageRenderer *q);
     ~QPdfPageRendererPrivate();
 
+    void createWorkers();
+    void destroyWorkers();
     void handleNextRequest();
-    void requestFinished(int page, QSize imageSize, const QImage &image,
-                         QPdfDocumentRenderOptions options, quint64 requestId);
+    void requestDone(quint64 requestId);
 
+    QPdfPageRenderer *q;
     QPdfPageRenderer::RenderMode m_renderMode = QPdfPageRenderer::RenderMode::SingleThreaded;
     QPointer<QPdfDocument> m_document;
 
@@ -85,17 +96,33 @@ public:
         int pageNumber;
         QSize imageSize;
         QPdfDocumentRenderOptions options;
+        int priority;
+
+        bool isSameRender(int page, QSize size, QPdfDocumentRenderOptions renderOptions) const
+        {
+            return pageNumber == page && imageSize == size && options == renderOptions;
+        }
     };
 
+    // Requests that no worker has started yet, in the order they were made,
+    // and those that are being rendered.
     QList<PageRequest> m_requests;
     QList<PageRequest> m_pendingRequests;
     quint64 m_requestIdCounter = 1;
 
-    QThread *m_renderThread = nullptr;
-    QScopedPointer<RenderWorker> m_renderWorker;
+    struct Worker
+    {
+        QThread *thread = nullptr;
+        RenderWorker *worker = nullptr;
+        quint64 requestId = 0;
+    };
+
+    QList<Worker> m_workers;
+    int m_workerCount = 1;
 };
 
 Q_DECLARE_TYPEINFO(QPdfPageRendererPrivate::PageRequest, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QPdfPageRendererPrivate::Worker, Q_PRIMITIVE_TYPE);
 
 
 RenderWorker::RenderWorker()
@@ -120,49 +147,122 @@ void RenderWorker::setDocument(QPdfDocument *document)
 void RenderWorker::requestPage(quint64 requestId, int pageNumber, QSize imageSize,
                                QPdfDocumentRenderOptions options)
 {
-    const QMutexLocker locker(&m_mutex);
-
-    if (!m_document || m_document->status() != QPdfDocument::Ready)
-        return;
+    m_startedRequestId.storeRelease(requestId);
+    {
+        const QMutexLocker locker(&m_mutex);
 
-    const QImage image = m_document->render(pageNumber, imageSize, options);
+        if (m_document && m_document->status() == QPdfDocument::Ready) {
+            const QImage image = m_document->render(pageNumber, imageSize, options);
+            emit pageRendered(pageNumber, imageSize, image, options, requestId);
+        }
+    }
 
-    emit pageRendered(pageNumber, imageSize, image, options, requestId);
+    emit requestDone(requestId);
 }
 
-QPdfPageRendererPrivate::QPdfPageRendererPrivate() : m_renderWorker(new RenderWorker) { }
+QPdfPageRendererPrivate::QPdfPageRendererPrivate(QPdfPageRenderer *q) : q(q) { }
 
 QPdfPageRendererPrivate::~QPdfPageRendererPrivate()
 {
-    if (m_renderThread) {
-        m_renderThread->quit();
-        m_renderThread->wait();
-    }
+    destroyWorkers();
 }
 
-void QPdfPageRendererPrivate::handleNextRequest()
+void QPdfPageRendererPrivate::createWorkers()
 {
-    if (m_requests.isEmpty())
-        return;
+    destroyWorkers();
+
+    const int count = (m_renderMode == QPdfPageRenderer::RenderMode::MultiThreaded ? m_workerCount : 1);
+    for (int i = 0; i < count; ++i) {
+        Worker worker;
+        worker.worker = new RenderWorker;
+        worker.worker->setDocument(m_document);
+
+        QObject::connect(worker.worker, &RenderWorker::pageRendered, q, &QPdfPageRenderer::pageRendered);
+        QObject::connect(worker.worker, &RenderWorker::requestDone, q,
+                         [this](quint64 requestId) { requestDone(requestId); });
+
+        if (m_renderMode == QPdfPageRenderer::RenderMode::MultiThreaded) {
+            worker.thread = new QThread;
+            worker.worker->moveToThread(worker.thread);
+            worker.thread->start();
+        }
+        m_workers.append(worker);
+    }
 
-    const PageRequest request = m_requests.takeFirst();
-    m_pendingRequests.append(request);
+    handleNextRequest();
+}
 
-    QMetaObject::invokeMethod(m_renderWorker.data(), "requestPage", Qt::QueuedConnection,
-                              Q_ARG(quint64, request.id), Q_ARG(int, request.pageNumber),
-                              Q_ARG(QSize, request.imageSize), Q_ARG(QPdfDocumentRenderOptions,
-                              request.options));
+void QPdfPageRendererPrivate::destroyWorkers()
+{
+    for (const Worker &worker : qAsConst(m_workers)) {
+        if (worker.thread) {
+            worker.thread->quit();
+            worker.thread->wait();
+            delete worker.thread;
+        }
+        const bool started = worker.requestId && worker.worker->startedRequestId() == worker.requestId;
+        delete worker.worker;
+
+        // A request the worker got to is done, and its results are on their
+        // way to this thread; requestDone() takes it off the pending list.
+        // One the worker quit before getting to is queued again, rather than
+        // leaving the caller waiting forever.
+        if (started)
+            continue;
+        const auto it = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
+                                     [&worker](const PageRequest &request){ return request.id == worker.requestId; });
+        if (it != m_pendingRequests.end()) {
+            m_requests.prepend(*it);
+            m_pendingRequests.erase(it);
+        }
+    }
+    m_workers.clear();
 }
 
-void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions options, quint64 requestId)
+void QPdfPageRendererPrivate::handleNextRequest()
 {
-    Q_UNUSED(image);
-    Q_UNUSED(requestId);
-    const auto it = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
-                                 [page, imageSize, options](const PageRequest &request){ return request.pageNumber == page && request.imageSize == imageSize && request.options == options; });
+    for (Worker &worker : m_workers) {
+        if (m_requests.isEmpty())
+            return;
+        if (worker.requestId)
+            continue;
+
+        // The first of the requests with the highest priority, among those
+        // for pages whose data is there; the others wait for pageAvailable().
+        auto it = m_requests.cend();
+        for (auto candidate = m_requests.cbegin(); candidate != m_requests.cend(); ++candidate) {
+            if ((it == m_requests.cend() || candidate->priority > it->priority)
+                    && (!m_document || m_document->isPageAvailable(candidate->pageNumber))) {
+                it = candidate;
+            }
+        }
+        if (it == m_requests.cend())
+            return;
+        const PageRequest request = *it;
+        m_requests.erase(it);
+        m_pendingRequests.append(request);
+        worker.requestId = request.id;
+
+        QMetaObject::invokeMethod(worker.worker, "requestPage", Qt::QueuedConnection,
+                                  Q_ARG(quint64, request.id), Q_ARG(int, request.pageNumber),
+                                  Q_ARG(QSize, request.imageSize), Q_ARG(QPdfDocumentRenderOptions,
+                                  request.options));
+    }
+}
 
+void QPdfPageRendererPrivate::requestDone(quint64 requestId)
+{
+    const auto it = std::find_if(m_pendingRequests.begin(), m_pendingRequests.end(),
+                                 [requestId](const PageRequest &request){ return request.id == requestId; });
     if (it != m_pendingRequests.end())
         m_pendingRequests.erase(it);
+
+    for (Worker &worker : m_workers) {
+        if (worker.requestId == requestId)
+            worker.requestId = 0;
+    }
+
+    handleNextRequest();
 }
 
 /*!
@@ -174,9 +274,18 @@ void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const Q
 
     The QPdfPageRenderer contains a queue that collects all render requests that are invoked through
     requestPage(). Depending on the configured RenderMode the QPdfPageRenderer processes this queue
-    in the main UI thread on next event loop invocation (\c RenderMode::SingleThreaded) or in a separate worker thread
-    (\c RenderMode::MultiThreaded) and emits the result through the pageRendered() signal for each request once
-    the rendering is done.
+    in the main UI thread on next event loop invocation (\c RenderMode::SingleThreaded) or in
+    workerCount separate worker threads (\c RenderMode::MultiThreaded) and emits the result through
+    the pageRendered() signal for each request once the rendering is done.
+
+    Requests with a higher priority are rendered first, and requests with equal priority in the
+    order they were made. A request that has not been started yet can be reprioritized with
+    setRequestPriority(), or dropped with cancelRequest() when the page it is for is no longer
+    visible.
+
+    While a document is loaded progressively, the data of requested pages is fetched first, and
+    requests for pages whose data has not arrived yet wait in the queue until
+    QPdfDocument::pageAvailable() is emitted for them.
 
     \sa QPdfDocument
 */
@@ -186,17 +295,11 @@ void QPdfPageRendererPrivate::requestFinished(int page, QSize imageSize, const Q
     Constructs a page renderer object with parent object \a parent.
 */
 QPdfPageRenderer::QPdfPageRenderer(QObject *parent)
-    : QObject(parent), d_ptr(new QPdfPageRendererPrivate)
+    : QObject(parent), d_ptr(new QPdfPageRendererPrivate(this))
 {
     qRegisterMetaType<QPdfDocumentRenderOptions>();
 
-    connect(d_ptr->m_renderWorker.data(), &RenderWorker::pageRendered, this,
-            [this](int page, QSize imageSize, const QImage &image,
-                   QPdfDocumentRenderOptions options, quint64 requestId) {
-                d_ptr->requestFinished(page, imageSize, image, options, requestId);
-                emit pageRendered(page, imageSize, image, options, requestId);
-                d_ptr->handleNextRequest();
-            });
+    d_ptr->createWorkers();
 }
 
 /*!
@@ -249,19 +352,37 @@ void QPdfPageRenderer::setRenderMode(RenderMode mode)
     d_ptr->m_renderMode = mode;
     emit renderModeChanged(d_ptr->m_renderMode);
 
-    if (d_ptr->m_renderMode == RenderMode::MultiThreaded) {
-        d_ptr->m_renderThread = new QThread;
-        d_ptr->m_renderWorker->moveToThread(d_ptr->m_renderThread);
-        d_ptr->m_renderThread->start();
-    } else {
-        d_ptr->m_renderThread->quit();
-        d_ptr->m_renderThread->wait();
-        delete d_ptr->m_renderThread;
-        d_ptr->m_renderThread = nullptr;
-
-        // pulling the object from another thread should be fine, once that thread is deleted
-        d_ptr->m_renderWorker->moveToThread(this->thread());
-    }
+    d_ptr->createWorkers();
+}
+
+/*!
+    \property QPdfPageRenderer::workerCount
+    \brief The number of threads that render pages in \c RenderMode::MultiThreaded.
+    \since 6.3
+
+    By default, this property is \c 1. In \c RenderMode::SingleThreaded mode, it has no effect.
+
+    \note PDFium can render only one page at a time in a process, so more than one worker only
+    helps when rendering is done in helper processes; see QPdfDocument::render().
+
+    \sa renderMode
+*/
+int QPdfPageRenderer::workerCount() const
+{
+    return d_ptr->m_workerCount;
+}
+
+void QPdfPageRenderer::setWorkerCount(int count)
+{
+    count = qMax(1, count);
+    if (d_ptr->m_workerCount == count)
+        return;
+
+    d_ptr->m_workerCount = count;
+    emit workerCountChanged(count);
+
+    if (d_ptr->m_renderMode == RenderMode::MultiThreaded)
+        d_ptr->createWorkers();
 }
 
 /*!
@@ -294,10 +415,18 @@ void QPdfPageRenderer::setDocument(QPdfDocument *document)
     if (d_ptr->m_document == document)
         return;
 
+    if (d_ptr->m_document)
+        d_ptr->m_document->disconnect(this);
     d_ptr->m_document = document;
     emit documentChanged(d_ptr->m_document);
 
-    d_ptr->m_renderWorker->setDocument(d_ptr->m_document);
+    for (const auto &worker : qAsConst(d_ptr->m_workers))
+        worker.worker->setDocument(d_ptr->m_document);
+
+    if (d_ptr->m_document) {
+        connect(d_ptr->m_document, &QPdfDocument::pageAvailable, this,
+                [this]() { d_ptr->handleNextRequest(); });
+    }
 }
 
 /*!
@@ -311,16 +440,38 @@ void QPdfPageRenderer::setDocument(QPdfDocument *document)
 */
 quint64 QPdfPageRenderer::requestPage(int pageNumber, QSize imageSize,
                                       QPdfDocumentRenderOptions options)
+{
+    return requestPage(pageNumber, imageSize, options, 0);
+}
+
+/*!
+    \overload
+    \since 6.3
+
+    Requests the renderer to render the page \a pageNumber into a QImage of size \a imageSize
+    according to the provided \a options, before any queued request with a lower \a priority.
+
+    If a request with the same parameters is still in the queue, its priority is raised to
+    \a priority if that is higher, and its ID is returned.
+
+    \sa setRequestPriority(), cancelRequest()
+*/
+quint64 QPdfPageRenderer::requestPage(int pageNumber, QSize imageSize,
+                                      QPdfDocumentRenderOptions options, int priority)
 {
     if (!d_ptr->m_document || d_ptr->m_document->status() != QPdfDocument::Ready)
         return 0;
 
     for (const auto &request : qAsConst(d_ptr->m_pendingRequests)) {
-        if (request.pageNumber == pageNumber
-            && request.imageSize == imageSize
-            && request.options == options)
+        if (request.isSameRender(pageNumber, imageSize, options))
             return request.id;
     }
+    for (auto &request : d_ptr->m_requests) {
+        if (request.isSameRender(pageNumber, imageSize, options)) {
+            request.priority = qMax(request.priority, priority);
+            return request.id;
+        }
+    }
 
     const auto id = d_ptr->m_requestIdCounter++;
 
@@ -329,14 +480,65 @@ quint64 QPdfPageRenderer::requestPage(int pageNumber, QSize imageSize,
     request.pageNumber = pageNumber;
     request.imageSize = imageSize;
     request.options = options;
+    request.priority = priority;
 
     d_ptr->m_requests.append(request);
+    // Pages that are still missing are fetched before the rest of the document.
+    d_ptr->m_document->d->requestPage(pageNumber);
 
     d_ptr->handleNextRequest();
 
     return id;
 }
 
+/*!
+    \since 6.3
+
+    Sets the priority of the queued request \a requestId to \a priority.
+
+    Returns \c false if the request is not in the queue anymore, because it is being rendered or
+    is done.
+*/
+bool QPdfPageRenderer::setRequestPriority(quint64 requestId, int priority)
+{
+    for (auto &request : d_ptr->m_requests) {
+        if (request.id == requestId) {
+            request.priority = priority;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+    \since 6.3
+
+    Removes the request \a requestId from the queue, so that pageRendered() is not emitted for it.
+
+    Returns \c false if the request is not in the queue anymore, because it is being rendered or
+    is done.
+
+    \sa cancelAllRequests()
+*/
+bool QPdfPageRenderer::cancelRequest(quint64 requestId)
+{
+    return d_ptr->m_requests.removeIf([requestId](const QPdfPageRendererPrivate::PageRequest &request) {
+        return request.id == requestId;
+    }) > 0;
+}
+
+/*!
+    \since 6.3
+
+    Removes all requests that are not being rendered yet from the queue.
+
+    \sa cancelRequest()
+*/
+void QPdfPageRenderer::cancelAllRequests()
+{
+    d_ptr->m_requests.clear();
+}
+
 QT_END_NAMESPACE
 
 #include "qpdfpagerenderer.moc"
@@ -55,6 +55,7 @@ class Q_PDF_EXPORT QPdfPageRenderer : public QObject
 
     Q_PROPERTY(QPdfDocument* document READ document WRITE setDocument NOTIFY documentChanged)
     Q_PROPERTY(RenderMode renderMode READ renderMode WRITE setRenderMode NOTIFY renderModeChanged)
+    Q_PROPERTY(int workerCount READ workerCount WRITE setWorkerCount NOTIFY workerCountChanged)
 
 public:
     enum class RenderMode
@@ -70,15 +71,24 @@ public:
     RenderMode renderMode() const;
     void setRenderMode(RenderMode mode);
 
+    int workerCount() const;
+    void setWorkerCount(int count);
+
     QPdfDocument* document() const;
     void setDocument(QPdfDocument *document);
 
     quint64 requestPage(int pageNumber, QSize imageSize,
                         QPdfDocumentRenderOptions options = QPdfDocumentRenderOptions());
+    quint64 requestPage(int pageNumber, QSize imageSize,
+                        QPdfDocumentRenderOptions options, int priority);
+    bool setRequestPriority(quint64 requestId, int priority);
+    bool cancelRequest(quint64 requestId);
+    void cancelAllRequests();
 
 Q_SIGNALS:
     void documentChanged(QPdfDocument *document);
     void renderModeChanged(RenderMode renderMode);
+    void workerCountChanged(int workerCount);
 
     void pageRendered(int pageNumber, QSize imageSize, const QImage &image,
                       QPdfDocumentRenderOptions options, quint64 requestId);
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrangefetcher.h"
+#include "qpdfrangefetcher_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QPdfRangeFetcher
+    \since 6.3
+    \inmodule QtPdf
+
+    \brief The QPdfRangeFetcher class is the interface through which
+    QPdfDocument fetches parts of a document that is loaded progressively.
+
+    When a document is loaded with QPdfDocument::load(QPdfRangeFetcher *),
+    it asks for the byte ranges it needs to show the first page, and then the
+    pages that are asked for, before the rest of the document. This is most
+    effective with linearized ("fast web view") PDF files, where the first
+    page and the hint tables come at the start of the file.
+
+    Subclasses implement size() and fetch(), for example with HTTP range
+    requests, and emit dataFetched() as data arrives. Fetches may complete in
+    any order, and the data of one fetch may come in several parts. The
+    signals must be emitted on the thread that the document lives in.
+
+    \sa QPdfDocument::pageAvailable()
+*/
+
+/*!
+    Constructs a range fetcher with parent object \a parent.
+*/
+QPdfRangeFetcher::QPdfRangeFetcher(QObject *parent)
+    : QObject(parent)
+{
+}
+
+/*!
+    Destroys the range fetcher.
+*/
+QPdfRangeFetcher::~QPdfRangeFetcher()
+{
+}
+
+/*!
+    \fn qint64 QPdfRangeFetcher::size() const
+
+    Returns the size of the whole document in bytes, or \c -1 if it is not
+    known yet. In that case, sizeChanged() must be emitted once it is known.
+*/
+
+/*!
+    \fn void QPdfRangeFetcher::fetch(qint64 offset, qint64 length)
+
+    Starts fetching \a length bytes of the document from \a offset, and
+    returns without waiting for them. The data is delivered with
+    dataFetched().
+*/
+
+/*!
+    \fn void QPdfRangeFetcher::sizeChanged(qint64 size)
+
+    This signal is emitted when the \a size of the document becomes known.
+*/
+
+/*!
+    \fn void QPdfRangeFetcher::dataFetched(qint64 offset, const QByteArray &data)
+
+    This signal is emitted when the bytes of the document starting at
+    \a offset have arrived as \a data.
+*/
+
+/*!
+    \fn void QPdfRangeFetcher::errorOccurred()
+
+    This signal is emitted when the document cannot be fetched.
+*/
+
+void QPdfByteRangeSet::add(qint64 start, qint64 length)
+{
+    if (length <= 0)
+        return;
+    qint64 end = start + length;
+
+    // Merge with the ranges that overlap or touch [start, end).
+    auto it = m_ranges.upperBound(start);
+    if (it != m_ranges.begin()) {
+        auto previous = std::prev(it);
+        if (previous.value() >= start) {
+            start = previous.key();
+            end = qMax(end, previous.value());
+            it = m_ranges.erase(previous);
+        }
+    }
+    while (it != m_ranges.end() && it.key() <= end) {
+        end = qMax(end, it.value());
+        it = m_ranges.erase(it);
+    }
+    m_ranges.insert(start, end);
+}
+
+void QPdfByteRangeSet::remove(qint64 start, qint64 length)
+{
+    if (length <= 0)
+        return;
+    const qint64 end = start + length;
+
+    auto it = m_ranges.upperBound(start);
+    if (it != m_ranges.begin())
+        --it;
+    while (it != m_ranges.end() && it.key() < end) {
+        const qint64 rangeStart = it.key();
+        const qint64 rangeEnd = it.value();
+        if (rangeEnd <= start) {
+            ++it;
+            continue;
+        }
+        it = m_ranges.erase(it);
+        if (rangeStart < start)
+            m_ranges.insert(rangeStart, start);
+        if (rangeEnd > end) {
+            m_ranges.insert(end, rangeEnd);
+            break;
+        }
+    }
+}
+
+bool QPdfByteRangeSet::contains(qint64 start, qint64 length) const
+{
+    if (length <= 0)
+        return true;
+    auto it = m_ranges.upperBound(start);
+    if (it == m_ranges.begin())
+        return false;
+    --it;
+    return it.value() >= start + length;
+}
+
+QList<QPdfByteRangeSet::Range> QPdfByteRangeSet::gaps(qint64 start, qint64 length) const
+{
+    QList<Range> ret;
+    if (length <= 0)
+        return ret;
+    const qint64 end = start + length;
+
+    qint64 position = start;
+    auto it = m_ranges.upperBound(start);
+    if (it != m_ranges.begin()) {
+        const auto previous = std::prev(it);
+        position = qMax(position, previous.value());
+    }
+    for (; it != m_ranges.end() && position < end; ++it) {
+        if (it.key() > position)
+            ret.append({position, qMin(it.key(), end) - position});
+        position = qMax(position, it.value());
+    }
+    if (position < end)
+        ret.append({position, end - position});
+    return ret;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdfrangefetcher.cpp"
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRANGEFETCHER_P_H
+#define QPDFRANGEFETCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+
+#include <QtCore/qlist.h>
+#include <QtCore/qmap.h>
+
+QT_BEGIN_NAMESPACE
+
+// A set of byte offsets, kept as disjoint [start, end) ranges.
+class Q_PDF_PRIVATE_EXPORT QPdfByteRangeSet
+{
+public:
+    struct Range
+    {
+        qint64 start;
+        qint64 length;
+
+        bool operator==(const Range &other) const
+        { return start == other.start && length == other.length; }
+    };
+
+    bool isEmpty() const { return m_ranges.isEmpty(); }
+    void clear() { m_ranges.clear(); }
+
+    void add(qint64 start, qint64 length);
+    void remove(qint64 start, qint64 length);
+    bool contains(qint64 start, qint64 length) const;
+    // The parts of [start, start + length) that are not in the set.
+    QList<Range> gaps(qint64 start, qint64 length) const;
+
+private:
+    // start -> end
+    QMap<qint64, qint64> m_ranges;
+};
+
+Q_DECLARE_TYPEINFO(QPdfByteRangeSet::Range, Q_PRIMITIVE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QPDFRANGEFETCHER_P_H
@@ -0,0 +1,378 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdfrenderprocesspool_p.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QLibraryInfo>
+#include <QLoggingCategory>
+#include <QProcess>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThread>
+#include <QtEndian>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcRenderProcess, "qt.pdf.renderprocess")
+
+static const char kRenderProcessesEnv[] = "QT_PDF_RENDER_PROCESSES";
+static const char kRenderProcessPathEnv[] = "QTPDF_RENDERPROCESS_PATH";
+static const int kTimeout = 30000;
+
+static QString renderProcessPath()
+{
+    const QString fromEnv = qEnvironmentVariable(kRenderProcessPathEnv);
+    if (!fromEnv.isEmpty())
+        return fromEnv;
+#if defined(Q_OS_WIN)
+    return QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + QLatin1String("/QtPdfRenderProcess.exe");
+#else
+    return QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + QLatin1String("/QtPdfRenderProcess");
+#endif
+}
+
+// One helper process, driven from a thread of its own so that callers on
+// any thread can wait for it.
+class QPdfRenderProcess : public QObject
+{
+public:
+    QPdfRenderProcess()
+    {
+        m_thread.setObjectName(QStringLiteral("QPdfRenderProcess"));
+        moveToThread(&m_thread);
+        m_thread.start();
+    }
+
+    ~QPdfRenderProcess()
+    {
+        QMetaObject::invokeMethod(this, [this] { stop(); }, Qt::BlockingQueuedConnection);
+        m_thread.quit();
+        m_thread.wait();
+    }
+
+    // Sets opened if the document was sent to the process for this render.
+    QImage render(quint64 documentId, const QString &fileName, const QByteArray &data,
+                  const QByteArray &password, int page, QSize imageSize, QPdfDocumentRenderOptions options,
+                  bool *opened)
+    {
+        Q_ASSERT(QThread::currentThread() != &m_thread);
+        QImage result;
+        QMetaObject::invokeMethod(this, [&] {
+            if (!m_openDocuments.contains(documentId)) {
+                // A document the process failed to open once is not sent again.
+                if (m_failedDocuments.contains(documentId))
+                    return;
+                if (!open(documentId, fileName, data, password)) {
+                    m_failedDocuments.insert(documentId);
+                    return;
+                }
+                *opened = true;
+            }
+            result = renderPage(documentId, page, imageSize, options);
+        }, Qt::BlockingQueuedConnection);
+        return result;
+    }
+
+    void closeDocument(quint64 documentId)
+    {
+        QMetaObject::invokeMethod(this, [this, documentId] {
+            m_failedDocuments.remove(documentId);
+            if (!m_openDocuments.remove(documentId))
+                return;
+            QByteArray message;
+            QDataStream out(&message, QIODevice::WriteOnly);
+            out.setVersion(QPdfRenderProtocol::StreamVersion);
+            out << quint8(QPdfRenderProtocol::CloseDocument) << documentId;
+            send(message);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    bool ensureStarted()
+    {
+        if (m_process)
+            return true;
+        if (m_failedToStart)
+            return false;
+
+        m_process = new QProcess(this);
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.remove(QLatin1String(kRenderProcessesEnv));
+        m_process->setProcessEnvironment(environment);
+        m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        m_process->start(renderProcessPath(), QStringList());
+        if (!m_process->waitForStarted(kTimeout)) {
+            qCWarning(qLcRenderProcess) << "Could not start" << renderProcessPath() << m_process->errorString()
+                                        << "- rendering in process instead.";
+            m_failedToStart = true;
+            stop();
+            return false;
+        }
+        return true;
+    }
+
+    void stop()
+    {
+        delete m_process;
+        m_process = nullptr;
+        m_openDocuments.clear();
+    }
+
+    // Drops the process after an error. It is restarted, and documents are
+    // opened again, on the next request.
+    void fail(const char *what)
+    {
+        qCWarning(qLcRenderProcess) << what << (m_process ? m_process->errorString() : QString());
+        stop();
+    }
+
+    bool send(const QByteArray &message)
+    {
+        if (quint32(message.size()) > QPdfRenderProtocol::MaxMessageSize) {
+            qCDebug(qLcRenderProcess) << "message of" << message.size() << "bytes is too large for the render process";
+            return false;
+        }
+        if (!ensureStarted())
+            return false;
+        const quint32 size = qToBigEndian(quint32(message.size()));
+        m_process->write(reinterpret_cast<const char *>(&size), sizeof(size));
+        m_process->write(message);
+        while (m_process->bytesToWrite()) {
+            if (!m_process->waitForBytesWritten(kTimeout)) {
+                fail("Writing to the render process failed:");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool waitForBytes(qint64 count)
+    {
+        while (m_process->bytesAvailable() < count) {
+            if (!m_process->waitForReadyRead(kTimeout)) {
+                fail("Reading from the render process failed:");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool receive(QByteArray *message)
+    {
+        quint32 size;
+        if (!waitForBytes(sizeof(size)))
+            return false;
+        m_process->read(reinterpret_cast<char *>(&size), sizeof(size));
+        size = qFromBigEndian(size);
+        if (size > QPdfRenderProtocol::MaxMessageSize) {
+            fail("The render process sent an oversized message");
+            return false;
+        }
+        if (!waitForBytes(size))
+            return false;
+        *message = m_process->read(size);
+        return true;
+    }
+
+    bool open(quint64 documentId, const QString &fileName, const QByteArray &data, const QByteArray &password)
+    {
+        // The pool no longer has the data of a document that was opened by a
+        // process which went away since.
+        if (fileName.isEmpty() && data.isEmpty())
+            return false;
+        QByteArray message;
+        QDataStream out(&message, QIODevice::WriteOnly);
+        out.setVersion(QPdfRenderProtocol::StreamVersion);
+        out << quint8(QPdfRenderProtocol::OpenDocument) << documentId << fileName << data << password;
+        QByteArray reply;
+        if (!send(message) || !receive(&reply))
+            return false;
+        QDataStream in(reply);
+        in.setVersion(QPdfRenderProtocol::StreamVersion);
+        bool ready = false;
+        in >> ready;
+        if (!ready) {
+            qCDebug(qLcRenderProcess) << "render process could not open document" << documentId;
+            return false;
+        }
+        m_openDocuments.insert(documentId);
+        return true;
+    }
+
+    QImage renderPage(quint64 documentId, int page, QSize imageSize, QPdfDocumentRenderOptions options)
+    {
+        using namespace QPdfRenderProtocol;
+        QByteArray message;
+        QDataStream out(&message, QIODevice::WriteOnly);
+        out.setVersion(StreamVersion);
+        out << quint8(RenderPage) << documentId << qint32(page) << imageSize << options;
+        QByteArray reply;
+        if (!send(message) || !receive(&reply))
+            return QImage();
+
+        ImageHeader header;
+        const qsizetype headerSize = sizeof(header);
+        if (reply.size() < headerSize)
+            return QImage();
+        memcpy(&header, reply.constData(), headerSize);
+        if (header.format == QImage::Format_Invalid
+                || reply.size() - headerSize < qsizetype(header.bytesPerLine) * header.height)
+            return QImage();
+
+        // The image adopts the received buffer.
+        auto *buffer = new QByteArray(std::move(reply));
+        return QImage(reinterpret_cast<uchar *>(buffer->data()) + headerSize, header.width, header.height,
+                      header.bytesPerLine, QImage::Format(header.format),
+                      [](void *buffer) { delete static_cast<QByteArray *>(buffer); }, buffer);
+    }
+
+    QThread m_thread;
+    QProcess *m_process = nullptr;
+    QSet<quint64> m_openDocuments;
+    QSet<quint64> m_failedDocuments;
+    bool m_failedToStart = false;
+};
+
+Q_GLOBAL_STATIC(QPdfRenderProcessPool, renderProcessPool)
+
+QPdfRenderProcessPool *QPdfRenderProcessPool::instance()
+{
+    return renderProcessPool();
+}
+
+QPdfRenderProcessPool::QPdfRenderProcessPool()
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue(kRenderProcessesEnv, &ok);
+    if (ok && count > 0)
+        setProcessCount(count);
+    // The helper processes have to be gone before the application is.
+    qAddPostRoutine([] { QPdfRenderProcessPool::instance()->setProcessCount(0); });
+}
+
+QPdfRenderProcessPool::~QPdfRenderProcessPool()
+{
+}
+
+int QPdfRenderProcessPool::processCount() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_processes.size();
+}
+
+void QPdfRenderProcessPool::setProcessCount(int count)
+{
+    QList<QSharedPointer<QPdfRenderProcess>> oldProcesses;
+    const QMutexLocker locker(&m_mutex);
+    if (count == m_processes.size())
+        return;
+
+    // Processes still rendering for another thread go away once it is done.
+    oldProcesses.swap(m_processes);
+    for (int i = 0; i < count; ++i)
+        m_processes.append(QSharedPointer<QPdfRenderProcess>::create());
+
+    // Spread the attached documents over the new processes.
+    m_documentCounts.fill(0, count);
+    int next = 0;
+    for (Document &document : m_documents) {
+        if (count) {
+            document.process = m_processes.at(next);
+            ++m_documentCounts[next];
+            next = (next + 1) % count;
+        } else {
+            document.process.reset();
+        }
+    }
+}
+
+quint64 QPdfRenderProcessPool::attachDocument(const QString &fileName, const QByteArray &data,
+                                              const QByteArray &password)
+{
+    const QMutexLocker locker(&m_mutex);
+    if (m_processes.isEmpty())
+        return 0;
+
+    const auto leastBusy = std::min_element(m_documentCounts.begin(), m_documentCounts.end());
+    ++*leastBusy;
+
+    Document document;
+    document.fileName = fileName;
+    document.data = data;
+    document.password = password;
+    document.process = m_processes.at(leastBusy - m_documentCounts.begin());
+    const quint64 documentId = m_nextDocumentId++;
+    m_documents.insert(documentId, document);
+    return documentId;
+}
+
+void QPdfRenderProcessPool::detachDocument(quint64 documentId)
+{
+    const QMutexLocker locker(&m_mutex);
+    const Document document = m_documents.take(documentId);
+    if (!document.process)
+        return;
+    const qsizetype index = m_processes.indexOf(document.process);
+    if (index >= 0)
+        --m_documentCounts[index];
+    document.process->closeDocument(documentId);
+}
+
+QImage QPdfRenderProcessPool::render(quint64 documentId, int page, QSize imageSize,
+                                     QPdfDocumentRenderOptions options)
+{
+    QMutexLocker locker(&m_mutex);
+    const Document document = m_documents.value(documentId);
+    locker.unlock();
+    if (!document.process)
+        return QImage();
+    bool opened = false;
+    const QImage image = document.process->render(documentId, document.fileName, document.data,
+                                                  document.password, page, imageSize, options, &opened);
+
+    // Once the process has the document, the pool need not keep its data.
+    if (opened && !document.data.isEmpty()) {
+        locker.relock();
+        const auto it = m_documents.find(documentId);
+        if (it != m_documents.end())
+            it->data.clear();
+    }
+    return image;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,155 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFRENDERPROCESSPOOL_P_H
+#define QPDFRENDERPROCESSPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+#include "qpdfdocumentrenderoptions.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfRenderProcess;
+
+// PDFium keeps global state, so all documents of a process share one lock.
+// The pool lets documents be rendered in helper processes instead, each
+// owning its own copy of the documents assigned to it. Renders of documents
+// in different processes then run in parallel, while the calling thread
+// waits for its own result.
+class Q_PDF_PRIVATE_EXPORT QPdfRenderProcessPool
+{
+public:
+    static QPdfRenderProcessPool *instance();
+
+    QPdfRenderProcessPool();
+    ~QPdfRenderProcessPool();
+
+    // 0 disables the pool. Defaults to QT_PDF_RENDER_PROCESSES.
+    int processCount() const;
+    void setProcessCount(int count);
+
+    // Returns 0 if the pool is disabled. The data is shared until a process
+    // has opened the document, and dropped then; if that process goes away,
+    // the document is no longer rendered out of process.
+    quint64 attachDocument(const QString &fileName, const QByteArray &data, const QByteArray &password);
+    void detachDocument(quint64 documentId);
+
+    // Returns a null image if the document can't be rendered out of process,
+    // so that the caller can fall back to rendering it itself.
+    QImage render(quint64 documentId, int page, QSize imageSize, QPdfDocumentRenderOptions options);
+
+private:
+    struct Document
+    {
+        QString fileName;
+        QByteArray data;
+        QByteArray password;
+        QSharedPointer<QPdfRenderProcess> process;
+    };
+
+    mutable QMutex m_mutex;
+    QList<QSharedPointer<QPdfRenderProcess>> m_processes;
+    QList<int> m_documentCounts;
+    QHash<quint64, Document> m_documents;
+    quint64 m_nextDocumentId = 1;
+};
+
+// The messages exchanged with the helper process, each preceded by its size
+// as a quint32.
+namespace QPdfRenderProtocol {
+// Both sides reject larger messages instead of allocating for them.
+constexpr quint32 MaxMessageSize = 1024 * 1024 * 1024;
+
+enum Command : quint8 {
+    OpenDocument = 1,
+    CloseDocument,
+    RenderPage
+};
+
+constexpr QDataStream::Version StreamVersion = QDataStream::Qt_6_0;
+
+inline QDataStream &operator<<(QDataStream &stream, const QPdfDocumentRenderOptions &options)
+{
+    return stream << qint32(options.rotation()) << qint32(options.renderFlags())
+                  << options.scaledClipRect() << options.scaledSize();
+}
+
+inline QDataStream &operator>>(QDataStream &stream, QPdfDocumentRenderOptions &options)
+{
+    qint32 rotation, flags;
+    QRect clipRect;
+    QSize scaledSize;
+    stream >> rotation >> flags >> clipRect >> scaledSize;
+    options.setRotation(QPdf::Rotation(rotation));
+    options.setRenderFlags(QPdf::RenderFlags(flags));
+    options.setScaledClipRect(clipRect);
+    options.setScaledSize(scaledSize);
+    return stream;
+}
+
+// A rendered page is sent as its geometry followed by the raw pixels, which
+// avoids encoding the image.
+struct ImageHeader
+{
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+    qint32 format = QImage::Format_Invalid;
+};
+} // namespace QPdfRenderProtocol
+
+QT_END_NAMESPACE
+
+#endif // QPDFRENDERPROCESSPOOL_P_H
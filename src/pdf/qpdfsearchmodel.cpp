@@ -39,6 +39,7 @@
 #include "qpdfsearchmodel.h"
 #include "qpdfsearchmodel_p.h"
 #include "qpdfsearchresult_p.h"
+#include "qpdftextindex_p.h"
 
 #include "third_party/pdfium/public/fpdf_doc.h"
 #include "third_party/pdfium/public/fpdf_text.h"
@@ -52,8 +53,9 @@ QT_BEGIN_NAMESPACE
 Q_LOGGING_CATEGORY(qLcS, "qt.pdf.search")
 
 static const int UpdateTimerInterval = 100;
+// How long to search the text index in one go, in milliseconds.
+static const int IndexSearchSliceTime = 10;
 static const int ContextChars = 64;
-static const double CharacterHitTolerance = 6.0;
 
 QPdfSearchModel::QPdfSearchModel(QObject *parent)
     : QAbstractListModel(*(new QPdfSearchModelPrivate()), parent)
@@ -129,6 +131,11 @@ void QPdfSearchModel::setSearchString(QString searchString)
     if (d->searchString == searchString)
         return;
 
+    // Typing ahead only narrows down the matches found so far.
+    if (!d->searchString.isEmpty() && searchString.startsWith(d->searchString, Qt::CaseInsensitive))
+        d->previousMatchPositions = d->matchPositions;
+    else
+        d->previousMatchPositions.clear();
     d->searchString = searchString;
     beginResetModel();
     d->clearResults();
@@ -167,6 +174,7 @@ void QPdfSearchModel::setDocument(QPdfDocument *document)
         return;
 
     d->document = document;
+    d->previousMatchPositions.clear();
     d->clearResults();
     emit documentChanged();
 }
@@ -176,13 +184,25 @@ void QPdfSearchModel::timerEvent(QTimerEvent *event)
     Q_D(QPdfSearchModel);
     if (event->timerId() != d->updateTimerId)
         return;
-    if (!d->document || d->nextPageToUpdate >= d->document->pageCount()) {
-        if (d->document)
-            qCDebug(qLcS) << "done updating search results on" << d->searchResults.count() << "pages";
-        killTimer(d->updateTimerId);
-        d->updateTimerId = -1;
+
+    // Pages that are in the text index are searched many at a time; the
+    // others, which the index has not reached yet, go through PDFium one
+    // per tick rather than waiting for it.
+    QElapsedTimer timer;
+    timer.start();
+    while (d->document && d->nextPageToUpdate < d->document->pageCount()) {
+        const int page = d->nextPageToUpdate;
+        const bool indexed = d->textIndex && d->textIndex->isIndexed(page);
+        d->doSearch(page);
+        ++d->nextPageToUpdate;
+        if (!indexed || timer.elapsed() > IndexSearchSliceTime)
+            return;
     }
-    d->doSearch(d->nextPageToUpdate++);
+
+    if (d->document)
+        qCDebug(qLcS) << "done updating search results on" << d->searchResults.count() << "pages";
+    killTimer(d->updateTimerId);
+    d->updateTimerId = -1;
 }
 
 QPdfSearchModelPrivate::QPdfSearchModelPrivate() : QAbstractItemModelPrivate()
@@ -195,12 +215,15 @@ void QPdfSearchModelPrivate::clearResults()
     rowCountSoFar = 0;
     searchResults.clear();
     pagesSearched.clear();
+    matchPositions.clear();
+    textIndex = document ? document->d->ensureTextIndex() : nullptr;
     if (document) {
         searchResults.resize(document->pageCount());
         pagesSearched.resize(document->pageCount());
     }
     nextPageToUpdate = 0;
-    updateTimerId = q->startTimer(UpdateTimerInterval);
+    if (updateTimerId < 0)
+        updateTimerId = q->startTimer(UpdateTimerInterval);
 }
 
 bool QPdfSearchModelPrivate::doSearch(int page)
@@ -211,88 +234,123 @@ bool QPdfSearchModelPrivate::doSearch(int page)
         return true;
     Q_Q(QPdfSearchModel);
 
+    QList<QPdfSearchResult> newSearchResults;
+    if (textIndex && textIndex->isIndexed(page))
+        newSearchResults = searchIndex(page);
+    else if (!searchWithPdfium(page, &newSearchResults))
+        return false;
+
+    pagesSearched[page] = true;
+    searchResults[page] = newSearchResults;
+    if (newSearchResults.count() > 0) {
+        int rowsBefore = rowsBeforePage(page);
+        qCDebug(qLcS) << "from row" << rowsBefore << "rowCount" << rowCountSoFar << "increasing by" << newSearchResults.count();
+        rowCountSoFar += newSearchResults.count();
+        q->beginInsertRows(QModelIndex(), rowsBefore, rowsBefore + newSearchResults.count() - 1);
+        q->endInsertRows();
+    }
+    return true;
+}
+
+// Up to count characters of textPage, starting at start.
+static QString textRange(FPDF_TEXTPAGE textPage, int start, int count)
+{
+    count = qMin(count, FPDFText_CountChars(textPage) - start);
+    if (count <= 0)
+        return QString();
+    QList<ushort> buf(2 * count + 1);
+    const int len = FPDFText_GetText(textPage, start, count, buf.data());
+    // len is the number of code units written, including the terminator.
+    return QString::fromUtf16(reinterpret_cast<const char16_t *>(buf.constData()), qMax(0, len - 1));
+}
+
+static QString searchContext(QStringView text)
+{
+    QString context = text.toString();
+    context.replace(QLatin1Char('\n'), QStringLiteral("\u23CE"));
+    context.remove(QLatin1Char('\r'));
+    return context;
+}
+
+bool QPdfSearchModelPrivate::searchWithPdfium(int page, QList<QPdfSearchResult> *results)
+{
     const QPdfMutexLocker lock;
     QElapsedTimer timer;
     timer.start();
-    FPDF_PAGE pdfPage = FPDF_LoadPage(document->d->doc, page);
+    FPDF_PAGE pdfPage = document->d->loadPage(page);
     if (!pdfPage) {
         qWarning() << "failed to load page" << page;
         return false;
     }
     double pageHeight = FPDF_GetPageHeight(pdfPage);
-    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    FPDF_TEXTPAGE textPage = document->d->loadTextPage(page);
     if (!textPage) {
         qWarning() << "failed to load text of page" << page;
-        FPDF_ClosePage(pdfPage);
         return false;
     }
+    // Matches are described exactly as when searching the text index, which
+    // holds the same characters: which path a page takes depends on how far
+    // indexing has got.
     FPDF_SCHHANDLE sh = FPDFText_FindStart(textPage, searchString.utf16(), 0, 0);
-    QList<QPdfSearchResult> newSearchResults;
     while (FPDFText_FindNext(sh)) {
-        int idx = FPDFText_GetSchResultIndex(sh);
-        int count = FPDFText_GetSchCount(sh);
-        int rectCount = FPDFText_CountRects(textPage, idx, count);
-        QList<QRectF> rects;
-        int startIndex = -1;
-        int endIndex = -1;
-        for (int r = 0; r < rectCount; ++r) {
-            double left, top, right, bottom;
-            FPDFText_GetRect(textPage, r, &left, &top, &right, &bottom);
-            rects << QRectF(left, pageHeight - top, right - left, top - bottom);
-            if (r == 0) {
-                startIndex = FPDFText_GetCharIndexAtPos(textPage, left, top,
-                        CharacterHitTolerance, CharacterHitTolerance);
-            }
-            if (r == rectCount - 1) {
-                endIndex = FPDFText_GetCharIndexAtPos(textPage, right, top,
-                        CharacterHitTolerance, CharacterHitTolerance);
-            }
-            qCDebug(qLcS) << rects.last() << "char idx" << startIndex << "->" << endIndex;
-        }
-        QString contextBefore, contextAfter;
-        if (startIndex >= 0 || endIndex >= 0) {
-            startIndex = qMax(0, startIndex - ContextChars);
-            endIndex += ContextChars;
-            int count = endIndex - startIndex + 1;
-            if (count > 0) {
-                QList<ushort> buf(count + 1);
-                int len = FPDFText_GetText(textPage, startIndex, count, buf.data());
-                Q_ASSERT(len - 1 <= count); // len is number of characters written, including the terminator
-                QString context = QString::fromUtf16(
-                        reinterpret_cast<const char16_t *>(buf.constData()), len - 1);
-                context = context.replace(QLatin1Char('\n'), QStringLiteral("\u23CE"));
-                context = context.remove(QLatin1Char('\r'));
-                // try to find the search string near the middle of the context if possible
-                int si = context.indexOf(searchString, ContextChars - 5, Qt::CaseInsensitive);
-                if (si < 0)
-                    si = context.indexOf(searchString, Qt::CaseInsensitive);
-                if (si < 0)
-                    qWarning() << "search string" << searchString << "not found in context" << context;
-                contextBefore = context.mid(0, si);
-                contextAfter = context.mid(si + searchString.length());
-            }
-        }
-        if (!rects.isEmpty())
-            newSearchResults << QPdfSearchResult(page, rects, contextBefore, contextAfter);
+        const int index = FPDFText_GetSchResultIndex(sh);
+        const int count = FPDFText_GetSchCount(sh);
+        QPdfTextIndex::PageText match;
+        match.charBoxes.reserve(count);
+        for (int i = index; i < index + count; ++i)
+            match.charBoxes.append(QPdfTextIndex::charBox(textPage, i, pageHeight));
+        const QList<QRectF> rects = QPdfTextIndex::rectsForRange(match, 0, count);
+        qCDebug(qLcS) << rects << "char idx" << index << "->" << index + count - 1;
+        if (rects.isEmpty())
+            continue;
+        // A character can take two UTF-16 code units, so fetch as many
+        // characters as the context has code units, then trim.
+        const int contextStart = qMax(0, index - ContextChars);
+        const QString before = textRange(textPage, contextStart, index - contextStart);
+        const QString after = textRange(textPage, index + count, ContextChars);
+        *results << QPdfSearchResult(page, rects, searchContext(QStringView(before).right(ContextChars)),
+                                     searchContext(QStringView(after).left(ContextChars)));
     }
     FPDFText_FindClose(sh);
-    FPDFText_ClosePage(textPage);
-    FPDF_ClosePage(pdfPage);
     qCDebug(qLcS) << searchString << "took" << timer.elapsed() << "ms to find"
-                  << newSearchResults.count() << "results on page" << page;
+                  << results->count() << "results on page" << page;
 
-    pagesSearched[page] = true;
-    searchResults[page] = newSearchResults;
-    if (newSearchResults.count() > 0) {
-        int rowsBefore = rowsBeforePage(page);
-        qCDebug(qLcS) << "from row" << rowsBefore << "rowCount" << rowCountSoFar << "increasing by" << newSearchResults.count();
-        rowCountSoFar += newSearchResults.count();
-        q->beginInsertRows(QModelIndex(), rowsBefore, rowsBefore + newSearchResults.count() - 1);
-        q->endInsertRows();
-    }
     return true;
 }
 
+QList<QPdfSearchResult> QPdfSearchModelPrivate::searchIndex(int page)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QPdfTextIndex::PageText pageText = textIndex->pageText(page);
+    const auto previous = previousMatchPositions.constFind(page);
+    const QList<int> positions = (previous != previousMatchPositions.constEnd()
+            ? QPdfTextIndex::refine(pageText.text, *previous, searchString)
+            : QPdfTextIndex::find(pageText.text, searchString));
+    matchPositions.insert(page, positions);
+
+    QList<QPdfSearchResult> ret;
+    const QStringView text(pageText.text);
+    const int length = searchString.length();
+    int end = 0;
+    for (int position : positions) {
+        // Report matches without overlaps, as PDFium does.
+        if (position < end)
+            continue;
+        end = position + length;
+        const QList<QRectF> rects = QPdfTextIndex::rectsForRange(pageText, position, length);
+        if (rects.isEmpty())
+            continue;
+        const int contextStart = qMax(0, position - ContextChars);
+        ret << QPdfSearchResult(page, rects,
+                                searchContext(text.mid(contextStart, position - contextStart)),
+                                searchContext(text.mid(end, ContextChars)));
+    }
+    qCDebug(qLcS) << searchString << "took" << timer.nsecsElapsed() / 1000 << "us to find"
+                  << ret.count() << "results on page" << page << "in the text index";
+    return ret;
+}
+
 QPdfSearchModelPrivate::PageAndIndex QPdfSearchModelPrivate::pageAndIndexForResult(int resultIndex)
 {
     const int pageCount = document->pageCount();
@@ -54,8 +54,13 @@
 
 #include "third_party/pdfium/public/fpdfview.h"
 
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+
 QT_BEGIN_NAMESPACE
 
+class QPdfTextIndex;
+
 class QPdfSearchModelPrivate : public QAbstractItemModelPrivate
 {
     Q_DECLARE_PUBLIC(QPdfSearchModel)
@@ -64,6 +69,8 @@ public:
     QPdfSearchModelPrivate();
     void clearResults();
     bool doSearch(int page);
+    bool searchWithPdfium(int page, QList<QPdfSearchResult> *results);
+    QList<QPdfSearchResult> searchIndex(int page);
 
     struct PageAndIndex {
         int page;
@@ -79,6 +86,13 @@ public:
     int rowCountSoFar = 0;
     int updateTimerId = -1;
     int nextPageToUpdate = 0;
+
+    QPointer<QPdfTextIndex> textIndex;
+    // Where searchString starts in the text of each page searched in the
+    // index, overlapping matches included. When more characters are typed,
+    // the new matches can only be among these.
+    QHash<int, QList<int>> matchPositions;
+    QHash<int, QList<int>> previousMatchPositions;
 };
 
 QT_END_NAMESPACE
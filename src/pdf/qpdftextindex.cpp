@@ -0,0 +1,226 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdftextindex_p.h"
+#include "qpdfdocument_p.h"
+
+#include "third_party/pdfium/public/fpdf_text.h"
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qthread.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcTextIndex, "qt.pdf.textindex")
+
+QPdfTextIndex::QPdfTextIndex(FPDF_DOCUMENT document, int pageCount)
+    : m_document(document)
+    , m_pageCount(pageCount)
+    , m_pages(pageCount)
+    , m_indexed(pageCount, false)
+{
+}
+
+QPdfTextIndex::~QPdfTextIndex()
+{
+    cancel();
+}
+
+void QPdfTextIndex::start()
+{
+    if (m_thread || !m_pageCount)
+        return;
+
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName(QStringLiteral("QPdfTextIndex"));
+    m_thread->start(QThread::LowPriority);
+}
+
+void QPdfTextIndex::cancel()
+{
+    if (!m_thread)
+        return;
+
+    m_cancelled.storeRelaxed(1);
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool QPdfTextIndex::isIndexed(int page) const
+{
+    const QMutexLocker locker(&m_mutex);
+    return page >= 0 && page < m_pageCount && m_indexed.at(page);
+}
+
+bool QPdfTextIndex::isFinished() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_indexedCount == m_pageCount;
+}
+
+QPdfTextIndex::PageText QPdfTextIndex::pageText(int page) const
+{
+    const QMutexLocker locker(&m_mutex);
+    if (page < 0 || page >= m_pageCount)
+        return PageText();
+    return m_pages.at(page);
+}
+
+void QPdfTextIndex::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int page = 0; page < m_pageCount && !m_cancelled.loadRelaxed(); ++page) {
+        PageText pageText;
+        {
+            // Taken page by page, so that rendering can go on in between.
+            const QPdfMutexLocker lock;
+            pageText = extractPage(m_document, page);
+        }
+        {
+            const QMutexLocker locker(&m_mutex);
+            m_pages[page] = std::move(pageText);
+            m_indexed[page] = true;
+            ++m_indexedCount;
+        }
+        QMetaObject::invokeMethod(this, [this, page]() { emit pageIndexed(page); }, Qt::QueuedConnection);
+    }
+
+    if (m_cancelled.loadRelaxed())
+        return;
+    qCDebug(qLcTextIndex) << "indexed" << m_pageCount << "pages in" << timer.elapsed() << "ms";
+    QMetaObject::invokeMethod(this, [this]() { emit finished(); }, Qt::QueuedConnection);
+}
+
+QPdfTextIndex::PageText QPdfTextIndex::extractPage(FPDF_DOCUMENT document, int page)
+{
+    PageText ret;
+    FPDF_PAGE pdfPage = FPDF_LoadPage(document, page);
+    if (!pdfPage) {
+        qCWarning(qLcTextIndex) << "failed to load page" << page;
+        return ret;
+    }
+    const double pageHeight = FPDF_GetPageHeight(pdfPage);
+    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(pdfPage);
+    if (!textPage) {
+        qCWarning(qLcTextIndex) << "failed to load text of page" << page;
+        FPDF_ClosePage(pdfPage);
+        return ret;
+    }
+
+    const int count = FPDFText_CountChars(textPage);
+    ret.text.reserve(count);
+    ret.charBoxes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const char32_t unicode = FPDFText_GetUnicode(textPage, i);
+        const CharBox box = charBox(textPage, i, pageHeight);
+        if (QChar::requiresSurrogates(unicode)) {
+            ret.text.append(QChar::highSurrogate(unicode));
+            ret.text.append(QChar::lowSurrogate(unicode));
+            ret.charBoxes.append(box);
+        } else {
+            ret.text.append(QChar(unicode));
+        }
+        ret.charBoxes.append(box);
+    }
+
+    FPDFText_ClosePage(textPage);
+    FPDF_ClosePage(pdfPage);
+    ret.text.squeeze();
+    ret.charBoxes.squeeze();
+    return ret;
+}
+
+// The box of the character at index, or an empty one if it was generated
+// by PDFium rather than drawn on the page.
+QPdfTextIndex::CharBox QPdfTextIndex::charBox(FPDF_TEXTPAGE textPage, int index, double pageHeight)
+{
+    double l, t, r, b;
+    if (FPDFText_IsGenerated(textPage, index) || !FPDFText_GetCharBox(textPage, index, &l, &r, &b, &t))
+        return CharBox();
+    return QRectF(l, pageHeight - t, r - l, t - b);
+}
+
+QList<int> QPdfTextIndex::find(const QString &text, const QString &needle)
+{
+    QList<int> ret;
+    if (needle.isEmpty())
+        return ret;
+    for (qsizetype i = text.indexOf(needle, 0, Qt::CaseInsensitive); i >= 0;
+         i = text.indexOf(needle, i + 1, Qt::CaseInsensitive))
+        ret.append(int(i));
+    return ret;
+}
+
+QList<int> QPdfTextIndex::refine(const QString &text, const QList<int> &positions, const QString &needle)
+{
+    QList<int> ret;
+    for (int position : positions) {
+        if (QStringView(text).mid(position).startsWith(needle, Qt::CaseInsensitive))
+            ret.append(position);
+    }
+    return ret;
+}
+
+QList<QRectF> QPdfTextIndex::rectsForRange(const PageText &pageText, int start, int length)
+{
+    QList<QRectF> ret;
+    const int end = qMin(start + length, int(pageText.charBoxes.size()));
+    for (int i = qMax(0, start); i < end; ++i) {
+        const CharBox &charBox = pageText.charBoxes.at(i);
+        if (charBox.isEmpty())
+            continue;
+        const QRectF box = charBox.toRectF();
+        // Extend the current rectangle while the characters stay on its line.
+        if (!ret.isEmpty()) {
+            QRectF &last = ret.last();
+            const qreal overlap = qMin(last.bottom(), box.bottom()) - qMax(last.top(), box.top());
+            if (box.left() >= last.left() && overlap > qMin(last.height(), box.height()) / 2) {
+                last = last.united(box);
+                continue;
+            }
+        }
+        ret.append(box);
+    }
+    return ret;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdftextindex_p.cpp"
@@ -0,0 +1,145 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFTEXTINDEX_P_H
+#define QPDFTEXTINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qstring.h>
+
+#include "third_party/pdfium/public/fpdfview.h"
+
+QT_BEGIN_NAMESPACE
+
+class QThread;
+
+// The text of every page of a document, with the box of each character,
+// extracted once on a background thread so that searches don't have to go
+// through PDFium again.
+class Q_PDF_PRIVATE_EXPORT QPdfTextIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Single precision is plenty for page coordinates, and halves the size
+    // of the index compared to QRectF.
+    struct CharBox
+    {
+        CharBox() = default;
+        CharBox(const QRectF &rect)
+            : left(float(rect.left())), top(float(rect.top()))
+            , width(float(rect.width())), height(float(rect.height())) {}
+
+        bool isEmpty() const { return width <= 0 || height <= 0; }
+        QRectF toRectF() const { return QRectF(left, top, width, height); }
+
+        float left = 0;
+        float top = 0;
+        float width = 0;
+        float height = 0;
+    };
+
+    struct PageText
+    {
+        QString text;
+        // One box per UTF-16 code unit of text, in points from the top left
+        // of the page; empty for generated characters such as line breaks.
+        QList<CharBox> charBoxes;
+    };
+
+    QPdfTextIndex(FPDF_DOCUMENT document, int pageCount);
+    ~QPdfTextIndex() override;
+
+    void start();
+    // Stops indexing, waiting for the page being indexed.
+    void cancel();
+
+    int pageCount() const { return m_pageCount; }
+    bool isIndexed(int page) const;
+    bool isFinished() const;
+    PageText pageText(int page) const;
+
+    // Case-insensitive; returns overlapping matches, so that the matches of
+    // a longer needle are always a subset of those of its prefix.
+    static QList<int> find(const QString &text, const QString &needle);
+    static QList<int> refine(const QString &text, const QList<int> &positions, const QString &needle);
+    // Rectangles covering the characters in [start, start + length), one per line.
+    static QList<QRectF> rectsForRange(const PageText &pageText, int start, int length);
+
+    // Must be called with the PDFium mutex held.
+    static PageText extractPage(FPDF_DOCUMENT document, int page);
+    static CharBox charBox(FPDF_TEXTPAGE textPage, int index, double pageHeight);
+
+Q_SIGNALS:
+    void pageIndexed(int page);
+    void finished();
+
+private:
+    void run();
+
+    const FPDF_DOCUMENT m_document;
+    const int m_pageCount;
+    mutable QMutex m_mutex;
+    QList<PageText> m_pages;
+    QList<bool> m_indexed;
+    int m_indexedCount = 0;
+    QAtomicInt m_cancelled = 0;
+    QThread *m_thread = nullptr;
+};
+
+Q_DECLARE_TYPEINFO(QPdfTextIndex::CharBox, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QPdfTextIndex::PageText, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QPDFTEXTINDEX_P_H
@@ -0,0 +1,206 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdftextrun.h"
+#include "qpdftextrun_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QPdfTextRun
+    \since 6.3
+    \inmodule QtPdf
+
+    \brief The QPdfTextRun class holds a run of text on one page in a PDF
+    document, set in one font and on one line, and its bounding rectangle.
+
+    Runs are extracted from whole pages at once by
+    QPdfDocument::extractText(), which passes them to a QPdfTextSink in
+    reading order.
+
+    \sa QPdfDocument::extractText(), QPdfTextSink
+*/
+
+/*!
+    Constructs an empty text run.
+*/
+QPdfTextRun::QPdfTextRun()
+  : d(new QPdfTextRunPrivate())
+{
+}
+
+QPdfTextRun::QPdfTextRun(QPdfTextRunPrivate *d)
+  : d(d)
+{
+}
+
+QPdfTextRun::QPdfTextRun(const QPdfTextRun &other)
+  : d(other.d)
+{
+}
+
+QPdfTextRun::QPdfTextRun(QPdfTextRun &&other) noexcept
+  : d(std::move(other.d))
+{
+}
+
+QPdfTextRun::~QPdfTextRun()
+{
+}
+
+QPdfTextRun &QPdfTextRun::operator=(const QPdfTextRun &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \property QPdfTextRun::page
+
+    This property holds the page on which the text is found.
+*/
+int QPdfTextRun::page() const
+{
+    return d->page;
+}
+
+/*!
+    \property QPdfTextRun::text
+
+    This property holds the text of the run. Spaces that PDFium inserts
+    between words are included; line breaks are not, since a run never spans
+    more than one line.
+*/
+QString QPdfTextRun::text() const
+{
+    return d->text;
+}
+
+/*!
+    \property QPdfTextRun::boundingRectangle
+
+    This property holds the rectangle around the glyphs of the run. The
+    coordinate system has the origin at the upper-left corner of the page, and
+    the units are \l {https://en.wikipedia.org/wiki/Point_(typography)}{points}.
+*/
+QRectF QPdfTextRun::boundingRectangle() const
+{
+    return d->boundingRect;
+}
+
+/*!
+    \property QPdfTextRun::fontName
+
+    This property holds the name of the font the run is set in, as given in
+    the document.
+*/
+QString QPdfTextRun::fontName() const
+{
+    return d->fontName;
+}
+
+/*!
+    \property QPdfTextRun::fontSize
+
+    This property holds the size of the font the run is set in, in points.
+*/
+qreal QPdfTextRun::fontSize() const
+{
+    return d->fontSize;
+}
+
+/*!
+    \property QPdfTextRun::startIndex
+
+    This property holds the index of the first character of the run within
+    the full text on the page, as used by QPdfDocument::getSelectionAtIndex().
+    Runs are extracted in increasing order of this index, which is the reading
+    order that PDFium determines for the page.
+*/
+int QPdfTextRun::startIndex() const
+{
+    return d->startIndex;
+}
+
+/*!
+    \class QPdfTextSink
+    \since 6.3
+    \inmodule QtPdf
+
+    \brief The QPdfTextSink class receives the text extracted from a PDF
+    document by QPdfDocument::extractText().
+
+    Reimplement addRun() to store or process each run of text. For every page,
+    beginPage() is called first, then addRun() once per run in reading order,
+    and then endPage(). The functions are always called on the thread that
+    called QPdfDocument::extractText(), one page after another.
+*/
+
+/*!
+    Destroys the sink.
+*/
+QPdfTextSink::~QPdfTextSink()
+{
+}
+
+/*!
+    Called before the runs of \a page, whose size in points is \a pageSize.
+    The default implementation does nothing.
+*/
+void QPdfTextSink::beginPage(int page, QSizeF pageSize)
+{
+    Q_UNUSED(page);
+    Q_UNUSED(pageSize);
+}
+
+/*!
+    \fn void QPdfTextSink::addRun(const QPdfTextRun &run)
+
+    Called for each \a run of text, in reading order.
+*/
+
+/*!
+    Called after the last run of \a page. The default implementation does
+    nothing.
+*/
+void QPdfTextSink::endPage(int page)
+{
+    Q_UNUSED(page);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdftextrun.cpp"
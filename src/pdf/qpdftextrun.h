@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFTEXTRUN_H
+#define QPDFTEXTRUN_H
+
+#include <QtPdf/qtpdfglobal.h>
+
+#include <QtCore/qobject.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qshareddata.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfTextRunPrivate;
+
+class Q_PDF_EXPORT QPdfTextRun
+{
+    Q_GADGET
+    Q_PROPERTY(int page READ page)
+    Q_PROPERTY(QString text READ text)
+    Q_PROPERTY(QRectF boundingRectangle READ boundingRectangle)
+    Q_PROPERTY(QString fontName READ fontName)
+    Q_PROPERTY(qreal fontSize READ fontSize)
+    Q_PROPERTY(int startIndex READ startIndex)
+
+public:
+    QPdfTextRun();
+    ~QPdfTextRun();
+    QPdfTextRun(const QPdfTextRun &other);
+    QPdfTextRun &operator=(const QPdfTextRun &other);
+    QPdfTextRun(QPdfTextRun &&other) noexcept;
+    QPdfTextRun &operator=(QPdfTextRun &&other) noexcept { swap(other); return *this; }
+    void swap(QPdfTextRun &other) noexcept { d.swap(other.d); }
+    int page() const;
+    QString text() const;
+    QRectF boundingRectangle() const;
+    QString fontName() const;
+    qreal fontSize() const;
+    int startIndex() const;
+
+private:
+    QPdfTextRun(QPdfTextRunPrivate *d);
+    friend class QPdfDocumentPrivate;
+
+private:
+    QExplicitlySharedDataPointer<QPdfTextRunPrivate> d;
+};
+
+Q_DECLARE_SHARED(QPdfTextRun)
+
+class Q_PDF_EXPORT QPdfTextSink
+{
+public:
+    virtual ~QPdfTextSink();
+
+    virtual void beginPage(int page, QSizeF pageSize);
+    virtual void addRun(const QPdfTextRun &run) = 0;
+    virtual void endPage(int page);
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFTEXTRUN_H
@@ -0,0 +1,168 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdftilecache_p.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(QPdfTileCache, sharedTileCache)
+
+QPdfTileCache::QPdfTileCache(qint64 maxBytes)
+{
+    m_cache.setMaxCost(maxBytes);
+}
+
+QPdfTileCache *QPdfTileCache::instance()
+{
+    return sharedTileCache();
+}
+
+QImage QPdfTileCache::find(const Key &key)
+{
+    const QMutexLocker locker(&m_mutex);
+    const QImage *image = m_cache.object(key);
+    return image ? *image : QImage();
+}
+
+bool QPdfTileCache::contains(const Key &key) const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_cache.contains(key);
+}
+
+bool QPdfTileCache::insert(const Key &key, const QImage &image)
+{
+    if (image.isNull())
+        return false;
+    const QMutexLocker locker(&m_mutex);
+    return m_cache.insert(key, new QImage(image), image.sizeInBytes());
+}
+
+void QPdfTileCache::removeDocument(quint64 document)
+{
+    const QMutexLocker locker(&m_mutex);
+    const QList<Key> keys = m_cache.keys();
+    for (const Key &key : keys) {
+        if (key.document == document)
+            m_cache.remove(key);
+    }
+}
+
+void QPdfTileCache::clear()
+{
+    const QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+qint64 QPdfTileCache::maxBytes() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+void QPdfTileCache::setMaxBytes(qint64 maxBytes)
+{
+    const QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(maxBytes);
+}
+
+qint64 QPdfTileCache::bytes() const
+{
+    const QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}
+
+// The smallest level that is at least as sharp as pixelsPerPoint.
+int QPdfTileCache::levelForScale(qreal pixelsPerPoint)
+{
+    if (pixelsPerPoint <= 0)
+        return MinimumLevel;
+    // Allow for rounding, so that a scale of exactly 2 doesn't pick level 2.
+    const int level = qCeil(std::log2(pixelsPerPoint) - 0.01);
+    return qBound(int(MinimumLevel), level, int(MaximumLevel));
+}
+
+// The sharpest level at which the whole page fits into one tile.
+int QPdfTileCache::previewLevel(QSizeF pagePointSize)
+{
+    const qreal extent = qMax(pagePointSize.width(), pagePointSize.height());
+    if (extent <= 0)
+        return MinimumLevel;
+    const int level = qFloor(std::log2(TileSize / extent));
+    return qBound(int(MinimumLevel), level, int(MaximumLevel));
+}
+
+qreal QPdfTileCache::scaleForLevel(int level)
+{
+    return std::ldexp(1.0, level);
+}
+
+QSize QPdfTileCache::pageSizeAtLevel(QSizeF pagePointSize, int level)
+{
+    return (pagePointSize * scaleForLevel(level)).toSize().expandedTo(QSize(1, 1));
+}
+
+QRect QPdfTileCache::tileRect(QSize levelPageSize, QPoint tile)
+{
+    return QRect(tile * TileSize, QSize(TileSize, TileSize)) & QRect(QPoint(), levelPageSize);
+}
+
+// Returns the range of tiles, in tile coordinates, covering levelRect.
+QRect QPdfTileCache::tilesIntersecting(QSize levelPageSize, const QRectF &levelRect)
+{
+    const QRectF bounded = levelRect & QRectF(QPointF(), QSizeF(levelPageSize));
+    if (bounded.isEmpty())
+        return QRect();
+    return QRect(QPoint(qFloor(bounded.left() / TileSize), qFloor(bounded.top() / TileSize)),
+                 QPoint(qCeil(bounded.right() / TileSize) - 1, qCeil(bounded.bottom() / TileSize) - 1));
+}
+
+QPdfDocumentRenderOptions QPdfTileCache::renderOptions(QSize levelPageSize, QPoint tile)
+{
+    QPdfDocumentRenderOptions options;
+    options.setScaledSize(levelPageSize);
+    options.setScaledClipRect(tileRect(levelPageSize, tile));
+    // Tiles are always drawn over the white page background, so they might as
+    // well be rendered opaque, which is cheaper to draw and upload.
+    options.setRenderFlags(QPdf::RenderOpaque);
+    return options;
+}
+
+QT_END_NAMESPACE
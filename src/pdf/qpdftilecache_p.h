@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFTILECACHE_P_H
+#define QPDFTILECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qtpdfglobal.h"
+#include "qpdfdocumentrenderoptions.h"
+
+#include <QtCore/qcache.h>
+#include <QtCore/qhashfunctions.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrect.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+// Pages are rendered in square tiles at zoom levels that are powers of two:
+// at level n, a page point is 2^n pixels. Views pick the level just above
+// their scale and draw its tiles scaled down, so zooming in steps does not
+// re-render anything until the next level is reached. The cache is bounded
+// by the bytes of the images it holds, and evicts the least recently used.
+class Q_PDF_PRIVATE_EXPORT QPdfTileCache
+{
+public:
+    enum {
+        TileSize = 256,
+        MinimumLevel = -8,
+        MaximumLevel = 8
+    };
+
+    struct Key
+    {
+        quint64 document = 0;
+        int page = 0;
+        int level = 0;
+        QPoint tile;
+
+        friend bool operator==(const Key &lhs, const Key &rhs) noexcept
+        {
+            return lhs.document == rhs.document && lhs.page == rhs.page && lhs.level == rhs.level
+                    && lhs.tile == rhs.tile;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.document, key.page, key.level, key.tile.x(), key.tile.y());
+        }
+    };
+
+    explicit QPdfTileCache(qint64 maxBytes = 128 * 1024 * 1024);
+
+    // Shared by all views in the process.
+    static QPdfTileCache *instance();
+
+    QImage find(const Key &key);
+    bool contains(const Key &key) const;
+    // Returns false if the image is larger than the whole cache.
+    bool insert(const Key &key, const QImage &image);
+    void removeDocument(quint64 document);
+    void clear();
+
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+    qint64 bytes() const;
+
+    static int levelForScale(qreal pixelsPerPoint);
+    static int previewLevel(QSizeF pagePointSize);
+    static qreal scaleForLevel(int level);
+    static QSize pageSizeAtLevel(QSizeF pagePointSize, int level);
+    static QRect tileRect(QSize levelPageSize, QPoint tile);
+    static QRect tilesIntersecting(QSize levelPageSize, const QRectF &levelRect);
+    static QPdfDocumentRenderOptions renderOptions(QSize levelPageSize, QPoint tile);
+
+private:
+    mutable QMutex m_mutex;
+    QCache<Key, QImage> m_cache;
+};
+
+Q_DECLARE_TYPEINFO(QPdfTileCache::Key, Q_RELOCATABLE_TYPE);
+
+QT_END_NAMESPACE
+
+#endif // QPDFTILECACHE_P_H
@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qpdftilerenderer_p.h"
+#include "qpdfdocument.h"
+#include "qpdfdocument_p.h"
+
+QT_BEGIN_NAMESPACE
+
+QPdfTileRenderer::QPdfTileRenderer(QObject *parent)
+    : QObject(parent)
+    , m_cache(QPdfTileCache::instance())
+{
+    m_renderer.setRenderMode(QPdfPageRenderer::RenderMode::MultiThreaded);
+    connect(&m_renderer, &QPdfPageRenderer::pageRendered, this,
+            [this](int, QSize, const QImage &image, QPdfDocumentRenderOptions, quint64 requestId) {
+                onPageRendered(image, requestId);
+            });
+}
+
+QPdfTileRenderer::~QPdfTileRenderer() = default;
+
+QPdfDocument *QPdfTileRenderer::document() const
+{
+    return m_document;
+}
+
+void QPdfTileRenderer::setDocument(QPdfDocument *document)
+{
+    if (m_document == document)
+        return;
+
+    if (m_document)
+        m_document->disconnect(this);
+    m_document = document;
+    m_renderer.setDocument(document);
+    clearPending();
+    if (m_document) {
+        connect(m_document, &QPdfDocument::statusChanged, this, &QPdfTileRenderer::clearPending);
+        connect(m_document, &QPdfDocument::pageAvailable, this, &QPdfTileRenderer::pageAvailable);
+    }
+}
+
+QPdfTileCache *QPdfTileRenderer::cache() const
+{
+    return m_cache;
+}
+
+void QPdfTileRenderer::setCache(QPdfTileCache *cache)
+{
+    m_cache = cache ? cache : QPdfTileCache::instance();
+}
+
+bool QPdfTileRenderer::hasTile(int page, int level, QPoint tile) const
+{
+    const quint64 document = documentKey();
+    return document && m_cache->contains({document, page, level, tile});
+}
+
+QImage QPdfTileRenderer::tile(int page, int level, QPoint tile, bool request, int priority,
+                              const QObject *requester)
+{
+    const quint64 document = documentKey();
+    if (!document || page < 0 || page >= m_document->pageCount())
+        return QImage();
+
+    const QPdfTileCache::Key key{document, page, level, tile};
+    QImage image = m_cache->find(key);
+    if (!image.isNull() || !request)
+        return image;
+    // Until the page has arrived, its size is only a guess; pageAvailable()
+    // says when to ask again.
+    if (!m_document->isPageAvailable(page)) {
+        m_document->d->requestPage(page);
+        return image;
+    }
+
+    const QSize levelSize = QPdfTileCache::pageSizeAtLevel(m_document->pageSize(page), level);
+    const QRect rect = QPdfTileCache::tileRect(levelSize, tile);
+    if (rect.isEmpty())
+        return image;
+
+    // Asking again for a queued tile returns the same request, with its
+    // priority raised if need be.
+    const quint64 requestId = m_renderer.requestPage(page, rect.size(),
+                                                     QPdfTileCache::renderOptions(levelSize, tile),
+                                                     priority);
+    if (requestId) {
+        PendingTile &pending = m_pending[requestId];
+        pending.key = key;
+        pending.requesters.insert(requester);
+    }
+    return image;
+}
+
+void QPdfTileRenderer::cancelRequests(int page, const QObject *requester)
+{
+    cancelRequestsIf(requester, [page](int pendingPage) { return pendingPage == page; });
+}
+
+void QPdfTileRenderer::cancelRequestsExcept(const QSet<int> &pages, const QObject *requester)
+{
+    cancelRequestsIf(requester, [&pages](int pendingPage) { return !pages.contains(pendingPage); });
+}
+
+// A tile being rendered already is left alone: it goes into the cache anyway.
+template <typename Predicate>
+void QPdfTileRenderer::cancelRequestsIf(const QObject *requester, Predicate cancelPage)
+{
+    for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+        if (cancelPage(it->key.page) && it->requesters.remove(requester)
+                && it->requesters.isEmpty() && m_renderer.cancelRequest(it.key())) {
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+quint64 QPdfTileRenderer::documentKey() const
+{
+    if (!m_document || m_document->status() != QPdfDocument::Ready)
+        return 0;
+    return m_document->d->tileCacheKey;
+}
+
+void QPdfTileRenderer::onPageRendered(const QImage &image, quint64 requestId)
+{
+    const auto it = m_pending.constFind(requestId);
+    if (it == m_pending.constEnd())
+        return;
+    const QPdfTileCache::Key key = it->key;
+    m_pending.erase(it);
+
+    // The document may have been closed or reloaded in the meantime.
+    if (key.document != documentKey() || image.isNull())
+        return;
+
+    // With a cache too small for the tile, announcing it would only make
+    // views ask for it again.
+    if (m_cache->insert(key, image))
+        emit tileRendered(key.page, key.level, key.tile);
+}
+
+void QPdfTileRenderer::clearPending()
+{
+    m_renderer.cancelAllRequests();
+    m_pending.clear();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qpdftilerenderer_p.cpp"
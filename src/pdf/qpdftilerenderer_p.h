@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QPDFTILERENDERER_P_H
+#define QPDFTILERENDERER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qpdfpagerenderer.h"
+#include "qpdftilecache_p.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qset.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPdfDocument;
+
+// Looks up tiles of a document in a QPdfTileCache, and renders the missing
+// ones in the background: those with higher priority first, otherwise in the
+// order they are asked for.
+class Q_PDF_PRIVATE_EXPORT QPdfTileRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        TilePriority = 0,
+        // A coarse tile of the whole page, shown until the sharp ones are ready.
+        PreviewPriority = 1
+    };
+
+    explicit QPdfTileRenderer(QObject *parent = nullptr);
+    ~QPdfTileRenderer() override;
+
+    QPdfDocument *document() const;
+    void setDocument(QPdfDocument *document);
+
+    QPdfTileCache *cache() const;
+    void setCache(QPdfTileCache *cache);
+
+    // Identifies the tiles of the document in the cache; 0 until it is ready.
+    quint64 documentKey() const;
+    bool hasTile(int page, int level, QPoint tile) const;
+
+    // Returns the cached tile, or a null image after queuing it for
+    // rendering if request is true. Several views can share a renderer:
+    // requester identifies the one asking, for cancelling its requests.
+    QImage tile(int page, int level, QPoint tile, bool request = true,
+                int priority = TilePriority, const QObject *requester = nullptr);
+
+    // Withdraws the requests of requester for tiles of pages that went out of
+    // view. A tile stays queued while another requester still wants it.
+    void cancelRequests(int page, const QObject *requester = nullptr);
+    void cancelRequestsExcept(const QSet<int> &pages, const QObject *requester = nullptr);
+
+Q_SIGNALS:
+    void tileRendered(int page, int level, QPoint tile);
+    // The data of a progressively loaded page has arrived: its tiles can be
+    // asked for, and its size may have changed.
+    void pageAvailable(int page);
+
+private:
+    void onPageRendered(const QImage &image, quint64 requestId);
+    void clearPending();
+    template <typename Predicate>
+    void cancelRequestsIf(const QObject *requester, Predicate cancelPage);
+
+    struct PendingTile
+    {
+        QPdfTileCache::Key key;
+        QSet<const QObject *> requesters;
+    };
+
+    QPdfPageRenderer m_renderer;
+    QPointer<QPdfDocument> m_document;
+    QPdfTileCache *m_cache;
+    QHash<quint64, PendingTile> m_pending;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPDFTILERENDERER_P_H
@@ -0,0 +1,174 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+// Renders documents for QPdfRenderProcessPool. Reads requests from stdin
+// and writes replies to stdout until stdin is closed.
+
+#include <QtPdf/qpdfdocument.h>
+#include <QtPdf/private/qpdfrenderprocesspool_p.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QtEndian>
+
+#include <memory>
+#include <unordered_map>
+
+#if defined(Q_OS_WIN)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+QT_USE_NAMESPACE
+
+static bool readFully(QFile *file, char *data, qint64 size)
+{
+    while (size > 0) {
+        const qint64 read = file->read(data, size);
+        if (read <= 0)
+            return false;
+        data += read;
+        size -= read;
+    }
+    return true;
+}
+
+static bool readMessage(QFile *file, QByteArray *message)
+{
+    quint32 size;
+    if (!readFully(file, reinterpret_cast<char *>(&size), sizeof(size)))
+        return false;
+    size = qFromBigEndian(size);
+    if (size > QPdfRenderProtocol::MaxMessageSize) {
+        qWarning("QtPdfRenderProcess: message of %u bytes is too large", size);
+        return false;
+    }
+    message->resize(size);
+    return readFully(file, message->data(), message->size());
+}
+
+static bool writeMessage(QFile *file, const QByteArray &head, const char *tail = nullptr, qint64 tailSize = 0)
+{
+    const quint32 size = qToBigEndian(quint32(head.size() + tailSize));
+    return file->write(reinterpret_cast<const char *>(&size), sizeof(size)) == sizeof(size)
+            && file->write(head) == head.size()
+            && (!tailSize || file->write(tail, tailSize) == tailSize);
+}
+
+int main(int argc, char **argv)
+{
+#if defined(Q_OS_WIN)
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    QCoreApplication app(argc, argv);
+
+    QFile input;
+    QFile output;
+    if (!input.open(stdin, QIODevice::ReadOnly | QIODevice::Unbuffered)
+            || !output.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered))
+        return 1;
+
+    using namespace QPdfRenderProtocol;
+    std::unordered_map<quint64, std::unique_ptr<QPdfDocument>> documents;
+    QByteArray message;
+    while (readMessage(&input, &message)) {
+        QDataStream in(message);
+        in.setVersion(StreamVersion);
+        quint8 command;
+        quint64 documentId;
+        in >> command >> documentId;
+
+        switch (command) {
+        case OpenDocument: {
+            QString fileName;
+            QByteArray data;
+            QByteArray password;
+            in >> fileName >> data >> password;
+            auto document = std::make_unique<QPdfDocument>();
+            document->setPassword(QString::fromUtf8(password));
+            if (!fileName.isEmpty()) {
+                document->load(fileName);
+            } else {
+                auto buffer = new QBuffer(document.get());
+                buffer->setData(data);
+                buffer->open(QIODevice::ReadOnly);
+                document->load(buffer);
+            }
+
+            QByteArray reply;
+            QDataStream out(&reply, QIODevice::WriteOnly);
+            out.setVersion(StreamVersion);
+            out << (document->status() == QPdfDocument::Ready);
+            if (document->status() == QPdfDocument::Ready)
+                documents[documentId] = std::move(document);
+            if (!writeMessage(&output, reply))
+                return 1;
+            break;
+        }
+        case CloseDocument:
+            documents.erase(documentId);
+            break;
+        case RenderPage: {
+            qint32 page;
+            QSize imageSize;
+            QPdfDocumentRenderOptions options;
+            in >> page >> imageSize >> options;
+            const auto it = documents.find(documentId);
+            const QImage image = it != documents.end() ? it->second->render(page, imageSize, options) : QImage();
+
+            ImageHeader header;
+            if (!image.isNull()) {
+                header.width = image.width();
+                header.height = image.height();
+                header.bytesPerLine = image.bytesPerLine();
+                header.format = image.format();
+            }
+            const QByteArray head(reinterpret_cast<const char *>(&header), sizeof(header));
+            if (!writeMessage(&output, head, reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()))
+                return 1;
+            break;
+        }
+        default:
+            qWarning("QtPdfRenderProcess: unknown command %d", int(command));
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -41,8 +41,10 @@
 #include "qquickpdfdocument_p.h"
 #include "qquickpdflinkmodel_p.h"
 #include "qquickpdfnavigationstack_p.h"
+#include "qquickpdfpageimageprovider_p.h"
 #include "qquickpdfsearchmodel_p.h"
 #include "qquickpdfselection_p.h"
+#include "qquickpdftiledpage_p.h"
 #include "qquicktableviewextra_p.h"
 
 QT_BEGIN_NAMESPACE
@@ -72,11 +74,10 @@ public:
 
     void initializeEngine(QQmlEngine *engine, const char *uri) override {
         Q_UNUSED(uri);
-#ifdef QT_STATIC
-        Q_UNUSED(engine);
-#else
+#ifndef QT_STATIC
         engine->addImportPath(QStringLiteral("qrc:/"));
 #endif
+        engine->addImageProvider(QQuickPdfPageImageProvider::providerId(), new QQuickPdfPageImageProvider);
     }
 
     void registerTypes(const char *uri) override {
@@ -91,6 +92,7 @@ public:
         qmlRegisterType<QQuickPdfSearchModel>(uri, 5, 15, "PdfSearchModel");
         qmlRegisterType<QQuickPdfSelection>(uri, 5, 15, "PdfSelection");
         qmlRegisterType<QQuickTableViewExtra>(uri, 5, 15, "TableViewExtra");
+        qmlRegisterType<QQuickPdfTiledPage>(uri, 6, 3, "PdfTiledPage");
     }
 };
 
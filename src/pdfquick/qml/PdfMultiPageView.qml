@@ -36,7 +36,7 @@
 import QtQuick 2.14
 import QtQuick.Controls 2.14
 import QtQuick.Layouts 1.14
-import QtQuick.Pdf 5.15
+import QtQuick.Pdf
 import QtQuick.Shapes 1.14
 import QtQuick.Window 2.14
 
@@ -120,6 +120,7 @@ Item {
         id: tableView
         anchors.fill: parent
         anchors.leftMargin: 2
+        clip: true // PdfTiledPage renders only the tiles inside the viewport
         model: modelInUse && root.document !== undefined ? root.document.pageCount : 0
         // workaround to make TableView do scheduleRebuildTable(RebuildOption::All) in cases when forceLayout() doesn't
         property bool modelInUse: true
@@ -160,20 +161,15 @@ Item {
                 rotation: root.pageRotation
                 anchors.centerIn: pinch.active ? undefined : parent
                 property size pagePointSize: document.pagePointSize(index)
-                property real pageScale: image.paintedWidth / pagePointSize.width
-                Image {
+                property real pageScale: image.width / pagePointSize.width
+                PdfTiledPage {
                     id: image
-                    source: document.source
-                    currentFrame: index
-                    asynchronous: true
-                    fillMode: Image.PreserveAspectFit
+                    document: root.document
+                    page: index
                     width: paper.pagePointSize.width * root.renderScale
                     height: paper.pagePointSize.height * root.renderScale
                     property real renderScale: root.renderScale
-                    property real oldRenderScale: 1
                     onRenderScaleChanged: {
-                        image.sourceSize.width = paper.pagePointSize.width * renderScale
-                        image.sourceSize.height = 0
                         paper.scale = 1
                         searchHighlights.update()
                     }
@@ -232,7 +228,7 @@ Item {
                     maximumScale: root.renderScale < 4 ? 2 : 1
                     minimumRotation: root.pageRotation
                     maximumRotation: root.pageRotation
-                    enabled: image.sourceSize.width < 5000
+                    enabled: image.width < 50000
                     onActiveChanged:
                         if (active) {
                             paper.z = 10
@@ -241,8 +237,7 @@ Item {
                             var centroidInPoints = Qt.point(pinch.centroid.position.x / root.renderScale,
                                                             pinch.centroid.position.y / root.renderScale)
                             var centroidInFlickable = tableView.mapFromItem(paper, pinch.centroid.position.x, pinch.centroid.position.y)
-                            var newSourceWidth = image.sourceSize.width * paper.scale
-                            var ratio = newSourceWidth / image.sourceSize.width
+                            var ratio = paper.scale
                             if (root.debug)
                                 console.log("pinch ended on page", index, "with centroid", pinch.centroid.position, centroidInPoints, "wrt flickable", centroidInFlickable,
                                             "page at", pageHolder.x.toFixed(2), pageHolder.y.toFixed(2),
@@ -295,7 +290,7 @@ Item {
                     model: PdfLinkModel {
                         id: linkModel
                         document: root.document
-                        page: image.currentFrame
+                        page: image.page
                     }
                     delegate: Shape {
                         x: rect.x * paper.pageScale
@@ -337,7 +332,7 @@ Item {
                     id: selection
                     anchors.fill: parent
                     document: root.document
-                    page: image.currentFrame
+                    page: image.page
                     renderScale: image.renderScale
                     fromPoint: textSelectionDrag.centroid.pressPosition
                     toPoint: textSelectionDrag.centroid.position
@@ -148,9 +148,7 @@ Rectangle {
 
     Image {
         id: image
-        currentFrame: navigationStack.currentPage
-        source: document.status === PdfDocument.Ready ? document.source : ""
-        asynchronous: true
+        source: document.status === PdfDocument.Ready ? document.pageImageSource(navigationStack.currentPage) : ""
         fillMode: Image.PreserveAspectFit
         property bool centerOnLoad: false
         property bool vCenterOnLoad: false
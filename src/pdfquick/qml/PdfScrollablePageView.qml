@@ -169,9 +169,7 @@ Flickable {
 
         Image {
             id: image
-            currentFrame: navigationStack.currentPage
-            source: document.status === PdfDocument.Ready ? document.source : ""
-            asynchronous: true
+            source: document.status === PdfDocument.Ready ? document.pageImageSource(navigationStack.currentPage) : ""
             fillMode: Image.PreserveAspectFit
             rotation: root.pageRotation
             anchors.centerIn: parent
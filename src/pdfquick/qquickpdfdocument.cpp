@@ -35,6 +35,8 @@
 ****************************************************************************/
 
 #include "qquickpdfdocument_p.h"
+#include "qquickpdfpageimageprovider_p.h"
+#include <QtPdf/private/qpdftilerenderer_p.h>
 #include <QQuickItem>
 #include <QQmlEngine>
 #include <QStandardPaths>
@@ -63,6 +65,14 @@ QQuickPdfDocument::QQuickPdfDocument(QObject *parent)
     connect(&m_doc, &QPdfDocument::passwordChanged, this, &QQuickPdfDocument::passwordChanged);
     connect(&m_doc, &QPdfDocument::passwordRequired, this, &QQuickPdfDocument::passwordRequired);
     connect(&m_doc, &QPdfDocument::statusChanged, [=] (QPdfDocument::Status status) {
+        // Give each load a new id, so that pages of a previous document
+        // aren't taken from the image cache.
+        if (m_imageProviderId) {
+            QQuickPdfPageImageProvider::unregisterDocument(m_imageProviderId);
+            m_imageProviderId = 0;
+        }
+        if (status == QPdfDocument::Ready)
+            m_imageProviderId = QQuickPdfPageImageProvider::registerDocument(this);
         emit statusChanged();
         if (status == QPdfDocument::Ready)
             emit metaDataChanged();
@@ -70,6 +80,12 @@ QQuickPdfDocument::QQuickPdfDocument(QObject *parent)
     connect(&m_doc, &QPdfDocument::pageCountChanged, this, &QQuickPdfDocument::pageCountChanged);
 }
 
+QQuickPdfDocument::~QQuickPdfDocument()
+{
+    if (m_imageProviderId)
+        QQuickPdfPageImageProvider::unregisterDocument(m_imageProviderId);
+}
+
 void QQuickPdfDocument::componentComplete()
 {
     if (m_doc.error() == QPdfDocument::IncorrectPasswordError)
@@ -91,6 +107,11 @@ void QQuickPdfDocument::setSource(QUrl source)
     m_source = source;
     m_maxPageWidthHeight = QSizeF();
     emit sourceChanged();
+    // Pages must not be rendered while the document is reloaded.
+    if (m_imageProviderId) {
+        QQuickPdfPageImageProvider::unregisterDocument(m_imageProviderId);
+        m_imageProviderId = 0;
+    }
     if (source.scheme() == QLatin1String("qrc"))
         m_doc.load(QLatin1Char(':') + source.path());
     else
@@ -172,6 +193,32 @@ QSizeF QQuickPdfDocument::pagePointSize(int page) const
     return m_doc.pageSize(page);
 }
 
+/*!
+    \qmlmethod url PdfDocument::pageImageSource(int page)
+    \since 6.3
+
+    Returns a URL to use as the \l {Image::source}{source} of an \l Image
+    that shows the given \a page, or an empty URL if the document is not
+    loaded. Unlike setting the Image source to the document \l source, the
+    page is rendered from this document, in the background, without opening
+    and parsing the file again; set \l {Image::sourceSize}{sourceSize} to
+    choose the resolution.
+
+    \code
+    Image {
+        source: doc.pageImageSource(0)
+        sourceSize.width: 600
+    }
+    \endcode
+*/
+QUrl QQuickPdfDocument::pageImageSource(int page) const
+{
+    if (!m_imageProviderId)
+        return QUrl();
+    return QUrl(QLatin1String("image://%1/%2/%3").arg(QQuickPdfPageImageProvider::providerId())
+                .arg(m_imageProviderId).arg(page));
+}
+
 qreal QQuickPdfDocument::maxPageWidth() const
 {
     const_cast<QQuickPdfDocument *>(this)->updateMaxPageSize();
@@ -210,6 +257,20 @@ qreal QQuickPdfDocument::heightSumBeforePage(int page, qreal spacing, int facing
     return ret;
 }
 
+/*!
+    \internal
+    Returns the renderer that all PdfTiledPage items showing this document
+    share, so that they don't render the same tiles twice.
+*/
+QPdfTileRenderer *QQuickPdfDocument::tileRenderer()
+{
+    if (!m_tileRenderer) {
+        m_tileRenderer = new QPdfTileRenderer(this);
+        m_tileRenderer->setDocument(&m_doc);
+    }
+    return m_tileRenderer;
+}
+
 void QQuickPdfDocument::updateMaxPageSize()
 {
     if (m_maxPageWidthHeight.isValid())
@@ -58,6 +58,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QPdfTileRenderer;
+
 class Q_PDFQUICK_EXPORT QQuickPdfDocument : public QObject, public QQmlParserStatus
 {
     Q_OBJECT
@@ -80,6 +82,7 @@ class Q_PDFQUICK_EXPORT QQuickPdfDocument : public QObject, public QQmlParserSta
 
 public:
     explicit QQuickPdfDocument(QObject *parent = nullptr);
+    ~QQuickPdfDocument() override;
 
     void classBegin() override {}
     void componentComplete() override;
@@ -105,6 +108,7 @@ public:
     QDateTime modificationDate() { return m_doc.metaData(QPdfDocument::ModificationDate).toDateTime(); }
 
     Q_INVOKABLE QSizeF pagePointSize(int page) const;
+    Q_INVOKABLE QUrl pageImageSource(int page) const;
     qreal maxPageWidth() const;
     qreal maxPageHeight() const;
     Q_INVOKABLE qreal heightSumBeforePage(int page, qreal spacing = 0, int facingPages = 1) const;
@@ -119,16 +123,21 @@ Q_SIGNALS:
 
 private:
     QPdfDocument &document() { return m_doc; }
+    QPdfTileRenderer *tileRenderer();
     void updateMaxPageSize();
 
 private:
     QUrl m_source;
     QPdfDocument m_doc;
     QSizeF m_maxPageWidthHeight;
+    QPdfTileRenderer *m_tileRenderer = nullptr;
+    // The id of this document in QQuickPdfPageImageProvider while it is Ready.
+    quint64 m_imageProviderId = 0;
 
     friend class QQuickPdfLinkModel;
     friend class QQuickPdfSearchModel;
     friend class QQuickPdfSelection;
+    friend class QQuickPdfTiledPage;
 
     Q_DISABLE_COPY(QQuickPdfDocument)
 };
@@ -0,0 +1,280 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qquickpdfpageimageprovider_p.h"
+#include "qquickpdfdocument_p.h"
+#include <QAtomicInteger>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QRunnable>
+#include <QSharedPointer>
+
+Q_LOGGING_CATEGORY(qLcImageProvider, "qt.pdf.imageprovider")
+
+QT_BEGIN_NAMESPACE
+
+// A document that pages can be requested from. Rendering holds the lock for
+// reading, so the document can't be unregistered, and destroyed, while one of
+// its pages is being rendered on a worker thread.
+struct RegisteredDocument
+{
+    QReadWriteLock lock;
+    QQuickPdfDocument *document = nullptr;
+};
+
+// The registered documents by id. The lock only guards the map: renders look
+// their document up and let go of it before rendering.
+struct DocumentRegistry
+{
+    QMutex lock;
+    QHash<quint64, QSharedPointer<RegisteredDocument>> documents;
+    quint64 nextId = 0;
+};
+
+Q_GLOBAL_STATIC(DocumentRegistry, documentRegistry)
+
+class QQuickPdfPageImageResponse;
+
+// Shared by a response and the runnable rendering for it. The runnable may
+// outlive the response, and the response may be gone before the runnable
+// starts; the mutex orders the two.
+struct QQuickPdfPageRenderJob
+{
+    QMutex mutex;
+    QQuickPdfPageImageResponse *response = nullptr;
+    bool started = false;
+};
+
+class QQuickPdfPageImageResponse : public QQuickImageResponse
+{
+public:
+    QQuickPdfPageImageResponse(QThreadPool *pool, quint64 document, int page, QSize requestedSize);
+    ~QQuickPdfPageImageResponse() override;
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+    QString errorString() const override { return m_error; }
+
+    void cancel() override;
+
+    void deliver(const QImage &image, const QString &error)
+    {
+        if (m_finished)
+            return;
+        m_image = image;
+        m_error = error;
+        m_finished = true;
+        emit finished();
+    }
+
+private:
+    QThreadPool *m_pool;
+    QSharedPointer<QQuickPdfPageRenderJob> m_job;
+    QRunnable *m_runnable;
+    QImage m_image;
+    QString m_error;
+    bool m_finished = false;
+};
+
+class QQuickPdfPageRenderRunnable : public QRunnable
+{
+public:
+    QQuickPdfPageRenderRunnable(const QSharedPointer<QQuickPdfPageRenderJob> &job, quint64 document,
+                                int page, QSize requestedSize)
+        : m_job(job), m_document(document), m_page(page), m_requestedSize(requestedSize)
+    {
+    }
+
+    void run() override
+    {
+        {
+            const QMutexLocker locker(&m_job->mutex);
+            if (!m_job->response)
+                return;
+            m_job->started = true;
+        }
+
+        QSharedPointer<RegisteredDocument> registered;
+        {
+            DocumentRegistry *registry = documentRegistry();
+            const QMutexLocker locker(&registry->lock);
+            registered = registry->documents.value(m_document);
+        }
+
+        QImage image;
+        QString error;
+        if (registered) {
+            const QReadLocker locker(&registered->lock);
+            render(registered->document, &image, &error);
+        } else {
+            error = QStringLiteral("document is not loaded");
+        }
+        qCDebug(qLcImageProvider) << "rendered page" << m_page << "of document" << m_document << image.size() << error;
+
+        const QMutexLocker locker(&m_job->mutex);
+        if (QQuickPdfPageImageResponse *response = m_job->response) {
+            QMetaObject::invokeMethod(response, [response, image, error] {
+                response->deliver(image, error);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+private:
+    void render(QQuickPdfDocument *document, QImage *image, QString *error) const
+    {
+        if (!document) {
+            *error = QStringLiteral("document is not loaded");
+            return;
+        }
+        if (m_page < 0 || m_page >= document->pageCount()) {
+            *error = QStringLiteral("page %1 out of range").arg(m_page);
+            return;
+        }
+        const QSizeF pointSize = document->pagePointSize(m_page);
+        QSizeF size = pointSize;
+        if (m_requestedSize.width() > 0 && m_requestedSize.height() > 0)
+            size.scale(m_requestedSize, Qt::KeepAspectRatio);
+        else if (m_requestedSize.width() > 0)
+            size = QSizeF(m_requestedSize.width(), pointSize.height() * m_requestedSize.width() / pointSize.width());
+        else if (m_requestedSize.height() > 0)
+            size = QSizeF(pointSize.width() * m_requestedSize.height() / pointSize.height(), m_requestedSize.height());
+        // Opaque pages come from the image pool in a format that the
+        // scene graph uploads to a texture without converting it.
+        QPdfDocumentRenderOptions options;
+        options.setRenderFlags(QPdf::RenderOpaque);
+        *image = document->document().render(m_page, size.toSize(), options);
+        if (image->isNull())
+            *error = QStringLiteral("failed to render page %1").arg(m_page);
+    }
+
+    const QSharedPointer<QQuickPdfPageRenderJob> m_job;
+    const quint64 m_document;
+    const int m_page;
+    const QSize m_requestedSize;
+};
+
+QQuickPdfPageImageResponse::QQuickPdfPageImageResponse(QThreadPool *pool, quint64 document, int page,
+                                                       QSize requestedSize)
+    : m_pool(pool), m_job(QSharedPointer<QQuickPdfPageRenderJob>::create())
+{
+    m_job->response = this;
+    m_runnable = new QQuickPdfPageRenderRunnable(m_job, document, page, requestedSize);
+
+    // The most recent requests are for the pages that have just scrolled
+    // into view, so they go first; requests for pages that scrolled out
+    // again are cancelled before they are rendered.
+    static QAtomicInt nextPriority = 0;
+    pool->start(m_runnable, nextPriority.fetchAndAddRelaxed(1) & 0x3fffffff);
+}
+
+QQuickPdfPageImageResponse::~QQuickPdfPageImageResponse()
+{
+    const QMutexLocker locker(&m_job->mutex);
+    m_job->response = nullptr;
+    if (!m_job->started && m_pool->tryTake(m_runnable))
+        delete m_runnable;
+}
+
+void QQuickPdfPageImageResponse::cancel()
+{
+    if (m_finished)
+        return;
+    {
+        const QMutexLocker locker(&m_job->mutex);
+        if (m_job->started || !m_pool->tryTake(m_runnable))
+            return;
+        m_job->response = nullptr;
+    }
+    delete m_runnable;
+    deliver(QImage(), QStringLiteral("cancelled"));
+}
+
+QQuickPdfPageImageProvider::QQuickPdfPageImageProvider()
+{
+    m_pool.setObjectName(QStringLiteral("QQuickPdfPageImageProvider"));
+}
+
+QQuickPdfPageImageProvider::~QQuickPdfPageImageProvider()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse *QQuickPdfPageImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    const QStringList parts = id.split(QLatin1Char('/'));
+    bool documentOk = false;
+    bool pageOk = false;
+    const quint64 document = parts.value(0).toULongLong(&documentOk);
+    const int page = parts.value(1).toInt(&pageOk);
+    if (parts.size() != 2 || !documentOk || !pageOk)
+        qCWarning(qLcImageProvider) << "invalid image id" << id;
+    return new QQuickPdfPageImageResponse(&m_pool, document, page, requestedSize);
+}
+
+quint64 QQuickPdfPageImageProvider::registerDocument(QQuickPdfDocument *document)
+{
+    auto registered = QSharedPointer<RegisteredDocument>::create();
+    registered->document = document;
+    DocumentRegistry *registry = documentRegistry();
+    const QMutexLocker locker(&registry->lock);
+    const quint64 id = ++registry->nextId;
+    registry->documents.insert(id, registered);
+    return id;
+}
+
+void QQuickPdfPageImageProvider::unregisterDocument(quint64 id)
+{
+    QSharedPointer<RegisteredDocument> registered;
+    {
+        DocumentRegistry *registry = documentRegistry();
+        const QMutexLocker locker(&registry->lock);
+        registered = registry->documents.take(id);
+    }
+    if (!registered)
+        return;
+    // Waits for the pages of this document that are being rendered; renders
+    // that start later find the document gone.
+    const QWriteLocker locker(&registered->lock);
+    registered->document = nullptr;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,324 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qquickpdftiledpage_p.h"
+#include "qquickpdfdocument_p.h"
+#include <QHash>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSGTexture>
+#include <QtMath>
+#include <QtPdf/private/qpdftilerenderer_p.h>
+#include <QtQuick/private/qquickitem_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickPdfTiledPagePrivate : public QQuickItemPrivate
+{
+    Q_DECLARE_PUBLIC(QQuickPdfTiledPage)
+
+public:
+    // Called when this item or one of its ancestors, such as the Flickable
+    // it is in, moves or scales: other tiles may have become visible.
+    bool transformChanged(QQuickItem *transformedItem) override
+    {
+        Q_Q(QQuickPdfTiledPage);
+        q->polish();
+        return QQuickItemPrivate::transformChanged(transformedItem);
+    }
+};
+
+// Keeps the textures of the tiles that were shown in the previous frame, so
+// that scrolling only uploads the tiles that have just become visible.
+class QQuickPdfTiledPageNode : public QSGNode
+{
+public:
+    ~QQuickPdfTiledPageNode() override { qDeleteAll(textures); }
+
+    QHash<QPdfTileCache::Key, QSGTexture *> textures;
+};
+
+/*!
+    \qmltype PdfTiledPage
+    \instantiates QQuickPdfTiledPage
+    \inqmlmodule QtQuick.Pdf
+    \ingroup pdf
+    \brief Shows one page of a PDF document, rendered in tiles.
+    \since 6.3
+
+    PdfTiledPage renders only the part of the page that is visible in the
+    window, in square tiles at the resolution that the page is shown at. The
+    tiles are cached, so scrolling back to a part of the page or zooming in
+    and out does not render it again. Until the tiles at the current
+    resolution are available, a low-resolution rendering of the whole page is
+    shown instead.
+
+    Unlike an \l Image with a PDF as its source, PdfTiledPage does not need
+    a \c sourceSize: it follows its size and any scaling applied to it or to
+    its parents.
+*/
+
+/*!
+    Constructs a PdfTiledPage.
+*/
+QQuickPdfTiledPage::QQuickPdfTiledPage(QQuickItem *parent)
+    : QQuickItem(*(new QQuickPdfTiledPagePrivate), parent)
+{
+    setFlags(ItemHasContents | ItemObservesViewport);
+}
+
+QQuickPdfTiledPage::~QQuickPdfTiledPage()
+{
+    if (m_document)
+        m_document->tileRenderer()->cancelRequests(m_page, this);
+}
+
+/*!
+    \qmlproperty PdfDocument PdfTiledPage::document
+
+    This property holds the PDF document in which to show the page.
+*/
+QQuickPdfDocument *QQuickPdfTiledPage::document() const
+{
+    return m_document;
+}
+
+void QQuickPdfTiledPage::setDocument(QQuickPdfDocument *document)
+{
+    if (m_document == document)
+        return;
+
+    if (m_document) {
+        m_document->tileRenderer()->cancelRequests(m_page, this);
+        disconnect(m_document, nullptr, this, nullptr);
+        disconnect(m_document->tileRenderer(), nullptr, this, nullptr);
+    }
+    m_document = document;
+    if (m_document) {
+        connect(m_document, &QQuickPdfDocument::statusChanged, this, &QQuickPdfTiledPage::invalidate);
+        connect(m_document->tileRenderer(), &QPdfTileRenderer::tileRendered, this,
+                [this](int page) {
+                    if (page == m_page)
+                        polish();
+                });
+        connect(m_document->tileRenderer(), &QPdfTileRenderer::pageAvailable, this,
+                [this](int page) {
+                    if (page == m_page)
+                        invalidate();
+                });
+    }
+    emit documentChanged();
+    invalidate();
+}
+
+/*!
+    \qmlproperty int PdfTiledPage::page
+
+    This property holds the zero-based number of the page to show.
+*/
+int QQuickPdfTiledPage::page() const
+{
+    return m_page;
+}
+
+void QQuickPdfTiledPage::setPage(int page)
+{
+    if (m_page == page)
+        return;
+
+    if (m_document)
+        m_document->tileRenderer()->cancelRequests(m_page, this);
+    m_page = page;
+    emit pageChanged();
+    invalidate();
+}
+
+/*!
+    \qmlproperty enumeration PdfTiledPage::status
+
+    This property holds whether the page can be shown. It takes the same
+    values as \l {Image::status}{Image.status}:
+
+    \value Image.Null No page is shown.
+    \value Image.Ready The page is shown, possibly at a lower resolution
+           while sharper tiles are being rendered.
+    \value Image.Loading Nothing has been rendered yet.
+*/
+QQuickPdfTiledPage::Status QQuickPdfTiledPage::status() const
+{
+    return m_status;
+}
+
+void QQuickPdfTiledPage::setStatus(Status status)
+{
+    if (m_status == status)
+        return;
+
+    m_status = status;
+    emit statusChanged();
+}
+
+void QQuickPdfTiledPage::invalidate()
+{
+    ++m_generation;
+    polish();
+}
+
+void QQuickPdfTiledPage::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size())
+        polish();
+}
+
+void QQuickPdfTiledPage::itemChange(ItemChange change, const ItemChangeData &data)
+{
+    QQuickItem::itemChange(change, data);
+    if (change == ItemSceneChange || change == ItemDevicePixelRatioHasChanged
+            || change == ItemVisibleHasChanged)
+        polish();
+}
+
+// Decides which tiles to show, on the GUI thread, and queues the missing ones
+// for rendering. updatePaintNode() only turns the result into textures.
+void QQuickPdfTiledPage::updatePolish()
+{
+    m_tiles.clear();
+    update();
+
+    QPdfDocument *document = m_document ? &m_document->document() : nullptr;
+    if (!document || document->status() != QPdfDocument::Ready
+            || m_page < 0 || m_page >= document->pageCount() || width() <= 0 || !window()) {
+        setStatus(Null);
+        return;
+    }
+
+    const QSizeF pointSize = document->pageSize(m_page);
+    if (pointSize.isEmpty()) {
+        setStatus(Null);
+        return;
+    }
+
+    // The length of the top edge in device pixels, whatever the rotation.
+    const QPointF topEdge = mapToScene(QPointF(width(), 0)) - mapToScene(QPointF(0, 0));
+    const qreal devicePixels = qSqrt(QPointF::dotProduct(topEdge, topEdge))
+            * window()->effectiveDevicePixelRatio();
+    const int level = QPdfTileCache::levelForScale(devicePixels / pointSize.width());
+    const QSize levelSize = QPdfTileCache::pageSizeAtLevel(pointSize, level);
+    const QSizeF levelToItem(width() / levelSize.width(), height() / levelSize.height());
+
+    const QRectF visible = clipRect() & boundingRect();
+    const QRectF levelVisible(visible.x() / levelToItem.width(), visible.y() / levelToItem.height(),
+                              visible.width() / levelToItem.width(), visible.height() / levelToItem.height());
+    const QRect tiles = QPdfTileCache::tilesIntersecting(levelSize, levelVisible);
+
+    QPdfTileRenderer *renderer = m_document->tileRenderer();
+    if (tiles.isEmpty()) {
+        // Scrolled out of view: don't render what was asked for before.
+        renderer->cancelRequests(m_page, this);
+        return;
+    }
+    bool complete = true;
+    for (int y = tiles.top(); y <= tiles.bottom() && complete; ++y) {
+        for (int x = tiles.left(); x <= tiles.right() && complete; ++x)
+            complete = renderer->hasTile(m_page, level, QPoint(x, y));
+    }
+
+    // Until the sharp tiles arrive, stretch one coarse tile over the page.
+    // It has priority over the sharp ones, so it is rendered first.
+    bool previewShown = false;
+    if (!complete) {
+        const int preview = qMin(level, QPdfTileCache::previewLevel(pointSize));
+        const QImage image = renderer->tile(m_page, preview, QPoint(0, 0), true,
+                                            QPdfTileRenderer::PreviewPriority, this);
+        if (!image.isNull()) {
+            m_tiles.append({{m_generation, m_page, preview, QPoint(0, 0)}, boundingRect(), image});
+            previewShown = true;
+        }
+    }
+
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y) {
+        for (int x = tiles.left(); x <= tiles.right(); ++x) {
+            const QPoint tile(x, y);
+            const QImage image = renderer->tile(m_page, level, tile, true,
+                                                QPdfTileRenderer::TilePriority, this);
+            if (image.isNull())
+                continue;
+            const QRect rect = QPdfTileCache::tileRect(levelSize, tile);
+            const QRectF target(rect.x() * levelToItem.width(), rect.y() * levelToItem.height(),
+                                rect.width() * levelToItem.width(), rect.height() * levelToItem.height());
+            m_tiles.append({{m_generation, m_page, level, tile}, target, image});
+        }
+    }
+
+    setStatus(complete || previewShown ? Ready : Loading);
+}
+
+QSGNode *QQuickPdfTiledPage::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *node = static_cast<QQuickPdfTiledPageNode *>(oldNode);
+    if (m_tiles.isEmpty()) {
+        delete node;
+        return nullptr;
+    }
+    if (!node)
+        node = new QQuickPdfTiledPageNode;
+
+    while (QSGNode *child = node->firstChild()) {
+        node->removeChildNode(child);
+        delete child;
+    }
+
+    QHash<QPdfTileCache::Key, QSGTexture *> textures;
+    for (const Tile &tile : qAsConst(m_tiles)) {
+        QSGTexture *texture = node->textures.take(tile.key);
+        if (!texture)
+            texture = window()->createTextureFromImage(tile.image);
+        textures.insert(tile.key, texture);
+
+        QSGImageNode *imageNode = window()->createImageNode();
+        imageNode->setTexture(texture);
+        imageNode->setRect(tile.target);
+        imageNode->setFiltering(QSGTexture::Linear);
+        node->appendChildNode(imageNode);
+    }
+    qDeleteAll(node->textures);
+    node->textures = textures;
+
+    return node;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QQUICKPDFTILEDPAGE_P_H
+#define QQUICKPDFTILEDPAGE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtPdfQuick/private/qtpdfquickglobal_p.h>
+#include <QtPdfQuick/private/qquickpdfdocument_p.h>
+#include <QtPdf/private/qpdftilecache_p.h>
+#include <QImage>
+#include <QPointer>
+#include <QtQml/qqml.h>
+#include <QtQuick/qquickitem.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickPdfTiledPagePrivate;
+
+class Q_PDFQUICK_EXPORT QQuickPdfTiledPage : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QQuickPdfDocument *document READ document WRITE setDocument NOTIFY documentChanged)
+    Q_PROPERTY(int page READ page WRITE setPage NOTIFY pageChanged)
+    Q_PROPERTY(Status status READ status NOTIFY statusChanged)
+
+public:
+    // Same values as Image.Status, so that views can treat both alike.
+    enum Status { Null, Ready, Loading, Error };
+    Q_ENUM(Status)
+
+    explicit QQuickPdfTiledPage(QQuickItem *parent = nullptr);
+    ~QQuickPdfTiledPage() override;
+
+    QQuickPdfDocument *document() const;
+    void setDocument(QQuickPdfDocument *document);
+    int page() const;
+    void setPage(int page);
+    Status status() const;
+
+signals:
+    void documentChanged();
+    void pageChanged();
+    void statusChanged();
+
+protected:
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &data) override;
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override;
+
+private:
+    void invalidate();
+    void setStatus(Status status);
+
+    struct Tile {
+        QPdfTileCache::Key key;
+        QRectF target;
+        QImage image;
+    };
+
+    QPointer<QQuickPdfDocument> m_document;
+    int m_page = 0;
+    Status m_status = Null;
+    // Changes whenever previously rendered tiles stop being valid.
+    quint64 m_generation = 0;
+    QList<Tile> m_tiles;
+
+    Q_DECLARE_PRIVATE(QQuickPdfTiledPage)
+    Q_DISABLE_COPY(QQuickPdfTiledPage)
+};
+
+QT_END_NAMESPACE
+
+QML_DECLARE_TYPE(QQuickPdfTiledPage)
+
+#endif // QQUICKPDFTILEDPAGE_P_H
@@ -37,7 +37,7 @@
 #include "qpdfview.h"
 #include "qpdfview_p.h"
 
-#include "qpdfpagerenderer.h"
+#include <QtPdf/private/qpdftilerenderer_p.h>
 
 #include <QGuiApplication>
 #include <QPainter>
@@ -47,6 +47,7 @@
 #include <QScreen>
 #include <QScrollBar>
 #include <QScroller>
+#include <QSet>
 
 QT_BEGIN_NAMESPACE
 
@@ -54,14 +55,15 @@ QPdfViewPrivate::QPdfViewPrivate(QPdfView *q)
     : q_ptr(q)
     , m_document(nullptr)
     , m_pageNavigation(nullptr)
-    , m_pageRenderer(nullptr)
+    , m_tileRenderer(nullptr)
+    , m_tileCache(64 * 1024 * 1024)
     , m_pageMode(QPdfView::SinglePage)
     , m_zoomMode(QPdfView::CustomZoom)
     , m_zoomFactor(1.0)
     , m_pageSpacing(3)
     , m_documentMargins(6, 6, 6, 6)
     , m_blockPageScrolling(false)
-    , m_pageCacheLimit(20)
+    , m_documentLayoutScheduled(false)
     , m_screenResolution(QGuiApplication::primaryScreen()->logicalDotsPerInch() / 72.0)
 {
 }
@@ -71,12 +73,15 @@ void QPdfViewPrivate::init()
     Q_Q(QPdfView);
 
     m_pageNavigation = new QPdfPageNavigation(q);
-    m_pageRenderer = new QPdfPageRenderer(q);
-    m_pageRenderer->setRenderMode(QPdfPageRenderer::RenderMode::MultiThreaded);
+    m_tileRenderer = new QPdfTileRenderer(q);
+    m_tileRenderer->setCache(&m_tileCache);
 }
 
 void QPdfViewPrivate::documentStatusChanged()
 {
+    // The tiles of a document that was closed or reloaded can't be shown again.
+    if (!m_document || m_document->status() != QPdfDocument::Ready)
+        m_tileCache.clear();
     updateDocumentLayout();
     invalidatePageCache();
 }
@@ -159,23 +164,97 @@ void QPdfViewPrivate::updateScrollBars()
     q->verticalScrollBar()->setPageStep(p.height());
 }
 
-void QPdfViewPrivate::pageRendered(int pageNumber, QSize imageSize, const QImage &image, quint64 requestId)
+static QRectF scaledRect(const QRectF &rect, qreal factor)
+{
+    return QRectF(rect.topLeft() * factor, rect.size() * factor);
+}
+
+void QPdfViewPrivate::paintPage(QPainter *painter, int page, QRect pageGeometry, QRect exposed)
 {
     Q_Q(QPdfView);
 
-    Q_UNUSED(imageSize);
-    Q_UNUSED(requestId);
+    painter->fillRect(pageGeometry, Qt::white);
 
-    if (!m_cachedPagesLRU.contains(pageNumber)) {
-        if (m_cachedPagesLRU.length() > m_pageCacheLimit)
-            m_pageCache.remove(m_cachedPagesLRU.takeFirst());
+    const QSizeF pointSize = m_document->pageSize(page);
+    if (pointSize.isEmpty())
+        return;
 
-        m_cachedPagesLRU.append(pageNumber);
+    // Pick the tile level that is at least as sharp as the device pixels of
+    // the page, and draw its tiles scaled down to the page geometry.
+    const qreal dpr = q->devicePixelRatioF();
+    const int level = QPdfTileCache::levelForScale(pageGeometry.width() * dpr / pointSize.width());
+    const QSize levelSize = QPdfTileCache::pageSizeAtLevel(pointSize, level);
+    const qreal levelToView = qreal(pageGeometry.width()) / levelSize.width();
+    const QRectF levelExposed = scaledRect(exposed.translated(-pageGeometry.topLeft()), 1 / levelToView);
+    const QRect tiles = QPdfTileCache::tilesIntersecting(levelSize, levelExposed);
+
+    QList<QPoint> missing;
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y) {
+        for (int x = tiles.left(); x <= tiles.right(); ++x) {
+            if (!m_tileRenderer->hasTile(page, level, QPoint(x, y)))
+                missing.append(QPoint(x, y));
+        }
     }
 
-    m_pageCache.insert(pageNumber, image);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // While sharp tiles are missing, show what is already cached at other
+    // levels in their place: the whole page from a single coarse tile, which
+    // has priority over the sharp ones so that it arrives first, then the
+    // tiles of the levels in between, and the finer tiles left from before
+    // zooming out.
+    if (!missing.isEmpty()) {
+        const int preview = qMin(level, QPdfTileCache::previewLevel(pointSize));
+        const QImage image = m_tileRenderer->tile(page, preview, QPoint(0, 0), true,
+                                                  QPdfTileRenderer::PreviewPriority);
+        if (!image.isNull())
+            painter->drawImage(QRectF(pageGeometry), image);
+
+        for (const QPoint &tile : qAsConst(missing)) {
+            const QRectF levelRect = QPdfTileCache::tileRect(levelSize, tile);
+            for (int sourceLevel = qMax(preview + 1, level - 3); sourceLevel < level; ++sourceLevel)
+                paintPlaceholder(painter, page, pageGeometry, level, levelRect, sourceLevel);
+            if (level < QPdfTileCache::MaximumLevel)
+                paintPlaceholder(painter, page, pageGeometry, level, levelRect, level + 1);
+        }
+    }
 
-    q->viewport()->update();
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y) {
+        for (int x = tiles.left(); x <= tiles.right(); ++x) {
+            const QImage image = m_tileRenderer->tile(page, level, QPoint(x, y));
+            if (image.isNull())
+                continue;
+            const QRectF target(QRectF(QPdfTileCache::tileRect(levelSize, QPoint(x, y))).topLeft() * levelToView,
+                                QSizeF(image.size()) * levelToView);
+            painter->drawImage(target.translated(pageGeometry.topLeft()), image);
+        }
+    }
+}
+
+// Draws levelRect, given in pixels of the page at level, from the tiles of
+// sourceLevel that are in the cache, without requesting any.
+void QPdfViewPrivate::paintPlaceholder(QPainter *painter, int page, QRect pageGeometry, int level,
+                                       QRectF levelRect, int sourceLevel)
+{
+    const QSizeF pointSize = m_document->pageSize(page);
+    const QSize levelSize = QPdfTileCache::pageSizeAtLevel(pointSize, level);
+    const QSize sourceSize = QPdfTileCache::pageSizeAtLevel(pointSize, sourceLevel);
+    const qreal levelToSource = qreal(sourceSize.width()) / levelSize.width();
+    const qreal sourceToView = qreal(pageGeometry.width()) / sourceSize.width();
+
+    const QRectF sourceRect = scaledRect(levelRect, levelToSource);
+    const QRect tiles = QPdfTileCache::tilesIntersecting(sourceSize, sourceRect);
+    for (int y = tiles.top(); y <= tiles.bottom(); ++y) {
+        for (int x = tiles.left(); x <= tiles.right(); ++x) {
+            const QImage image = m_tileRenderer->tile(page, sourceLevel, QPoint(x, y), false);
+            if (image.isNull())
+                continue;
+            const QRect tileRect = QPdfTileCache::tileRect(sourceSize, QPoint(x, y));
+            const QRectF part = sourceRect & QRectF(tileRect);
+            painter->drawImage(scaledRect(part, sourceToView).translated(pageGeometry.topLeft()), image,
+                               part.translated(-tileRect.topLeft()));
+        }
+    }
 }
 
 void QPdfViewPrivate::invalidateDocumentLayout()
@@ -184,11 +263,26 @@ void QPdfViewPrivate::invalidateDocumentLayout()
     invalidatePageCache();
 }
 
+// While a document is fetched, its pages arrive one by one; they are laid
+// out together once control returns to the event loop.
+void QPdfViewPrivate::scheduleDocumentLayout()
+{
+    Q_Q(QPdfView);
+
+    if (m_documentLayoutScheduled)
+        return;
+    m_documentLayoutScheduled = true;
+    QMetaObject::invokeMethod(q, [this]() {
+        if (m_documentLayoutScheduled)
+            invalidateDocumentLayout();
+    }, Qt::QueuedConnection);
+}
+
 void QPdfViewPrivate::invalidatePageCache()
 {
     Q_Q(QPdfView);
 
-    m_pageCache.clear();
+    // Tiles are keyed by zoom level, so there is nothing to throw away here.
     q->viewport()->update();
 }
 
@@ -272,6 +366,7 @@ qreal QPdfViewPrivate::yPositionForPage(int pageNumber) const
 
 void QPdfViewPrivate::updateDocumentLayout()
 {
+    m_documentLayoutScheduled = false;
     m_documentLayout = calculateDocumentLayout();
 
     updateScrollBars();
@@ -288,8 +383,8 @@ QPdfView::QPdfView(QWidget *parent)
 
     connect(d->m_pageNavigation, &QPdfPageNavigation::currentPageChanged, this, [d](int page){ d->currentPageChanged(page); });
 
-    connect(d->m_pageRenderer, &QPdfPageRenderer::pageRendered,
-            this, [d](int pageNumber, QSize imageSize, const QImage &image, QPdfDocumentRenderOptions, quint64 requestId){ d->pageRendered(pageNumber, imageSize, image, requestId); });
+    connect(d->m_tileRenderer, &QPdfTileRenderer::tileRendered, viewport(), qOverload<>(&QWidget::update));
+    connect(d->m_tileRenderer, &QPdfTileRenderer::pageAvailable, this, [d](){ d->scheduleDocumentLayout(); });
 
     verticalScrollBar()->setSingleStep(20);
     horizontalScrollBar()->setSingleStep(20);
@@ -320,7 +415,7 @@ void QPdfView::setDocument(QPdfDocument *document)
         d->m_documentStatusChangedConnection = connect(d->m_document.data(), &QPdfDocument::statusChanged, this, [d](){ d->documentStatusChanged(); });
 
     d->m_pageNavigation->setDocument(d->m_document);
-    d->m_pageRenderer->setDocument(d->m_document);
+    d->m_tileRenderer->setDocument(d->m_document);
 
     d->documentStatusChanged();
 }
@@ -439,6 +534,30 @@ void QPdfView::setDocumentMargins(QMargins margins)
     emit documentMarginsChanged(d->m_documentMargins);
 }
 
+qint64 QPdfView::pageCacheLimit() const
+{
+    Q_D(const QPdfView);
+
+    return d->m_tileCache.maxBytes();
+}
+
+void QPdfView::setPageCacheLimit(qint64 bytes)
+{
+    Q_D(QPdfView);
+
+    if (bytes < 0) {
+        qWarning("QPdfView::setPageCacheLimit: Negative limit %lld, using 0", bytes);
+        bytes = 0;
+    }
+    if (d->m_tileCache.maxBytes() == bytes)
+        return;
+
+    d->m_tileCache.setMaxBytes(bytes);
+    viewport()->update();
+
+    emit pageCacheLimitChanged(bytes);
+}
+
 void QPdfView::paintEvent(QPaintEvent *event)
 {
     Q_D(QPdfView);
@@ -447,21 +566,18 @@ void QPdfView::paintEvent(QPaintEvent *event)
     painter.fillRect(event->rect(), palette().brush(QPalette::Dark));
     painter.translate(-d->m_viewport.x(), -d->m_viewport.y());
 
+    QSet<int> visiblePages;
     for (auto it = d->m_documentLayout.pageGeometries.cbegin(); it != d->m_documentLayout.pageGeometries.cend(); ++it) {
         const QRect pageGeometry = it.value();
-        if (pageGeometry.intersects(d->m_viewport)) { // page needs to be painted
-            painter.fillRect(pageGeometry, Qt::white);
-
-            const int page = it.key();
-            const auto pageIt = d->m_pageCache.constFind(page);
-            if (pageIt != d->m_pageCache.cend()) {
-                const QImage &img = pageIt.value();
-                painter.drawImage(pageGeometry.topLeft(), img);
-            } else {
-                d->m_pageRenderer->requestPage(page, pageGeometry.size());
-            }
-        }
+        if (pageGeometry.intersects(d->m_viewport))
+            visiblePages.insert(it.key());
+        const QRect exposed = pageGeometry & event->rect().translated(d->m_viewport.topLeft());
+        if (!exposed.isEmpty()) // page needs to be painted
+            d->paintPage(&painter, it.key(), pageGeometry, exposed);
     }
+
+    // Don't render tiles of pages that were scrolled past before they were done.
+    d->m_tileRenderer->cancelRequestsExcept(visiblePages);
 }
 
 void QPdfView::resizeEvent(QResizeEvent *event)
@@ -58,6 +58,7 @@ class Q_PDF_WIDGETS_EXPORT QPdfView : public QAbstractScrollArea
 
     Q_PROPERTY(int pageSpacing READ pageSpacing WRITE setPageSpacing NOTIFY pageSpacingChanged)
     Q_PROPERTY(QMargins documentMargins READ documentMargins WRITE setDocumentMargins NOTIFY documentMarginsChanged)
+    Q_PROPERTY(qint64 pageCacheLimit READ pageCacheLimit WRITE setPageCacheLimit NOTIFY pageCacheLimitChanged)
 
 public:
     enum PageMode
@@ -93,6 +94,9 @@ public:
     QMargins documentMargins() const;
     void setDocumentMargins(QMargins margins);
 
+    qint64 pageCacheLimit() const;
+    void setPageCacheLimit(qint64 bytes);
+
 public Q_SLOTS:
     void setPageMode(PageMode mode);
     void setZoomMode(ZoomMode mode);
@@ -105,6 +109,7 @@ Q_SIGNALS:
     void zoomFactorChanged(qreal zoomFactor);
     void pageSpacingChanged(int pageSpacing);
     void documentMarginsChanged(QMargins documentMargins);
+    void pageCacheLimitChanged(qint64 pageCacheLimit);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -52,10 +52,12 @@
 
 #include <QHash>
 #include <QPointer>
+#include <QtPdf/private/qpdftilecache_p.h>
 
 QT_BEGIN_NAMESPACE
 
-class QPdfPageRenderer;
+class QPainter;
+class QPdfTileRenderer;
 
 class QPdfViewPrivate
 {
@@ -65,14 +67,19 @@ public:
     QPdfViewPrivate(QPdfView *q);
     void init();
 
+    static QPdfViewPrivate *get(QPdfView *q) { return q->d_func(); }
+
     void documentStatusChanged();
     void currentPageChanged(int currentPage);
     void calculateViewport();
     void setViewport(QRect viewport);
     void updateScrollBars();
 
-    void pageRendered(int pageNumber, QSize imageSize, const QImage &image, quint64 requestId);
+    void paintPage(QPainter *painter, int page, QRect pageGeometry, QRect exposed);
+    void paintPlaceholder(QPainter *painter, int page, QRect pageGeometry, int level,
+                          QRectF levelRect, int sourceLevel);
     void invalidateDocumentLayout();
+    void scheduleDocumentLayout();
     void invalidatePageCache();
 
     qreal yPositionForPage(int page) const;
@@ -89,7 +96,8 @@ public:
     QPdfView *q_ptr;
     QPointer<QPdfDocument> m_document;
     QPdfPageNavigation* m_pageNavigation;
-    QPdfPageRenderer *m_pageRenderer;
+    QPdfTileRenderer *m_tileRenderer;
+    QPdfTileCache m_tileCache;
 
     QPdfView::PageMode m_pageMode;
     QPdfView::ZoomMode m_zoomMode;
@@ -99,15 +107,12 @@ public:
     QMargins m_documentMargins;
 
     bool m_blockPageScrolling;
+    bool m_documentLayoutScheduled;
 
     QMetaObject::Connection m_documentStatusChangedConnection;
 
     QRect m_viewport;
 
-    QHash<int, QImage> m_pageCache;
-    QList<int> m_cachedPagesLRU;
-    int m_pageCacheLimit;
-
     DocumentLayout m_documentLayout;
 
     qreal m_screenResolution; // pixels per point
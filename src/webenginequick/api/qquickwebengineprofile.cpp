@@ -176,6 +176,7 @@ QQuickWebEngineProfilePrivate::~QQuickWebEngineProfilePrivate()
         // In the case the user sets this profile as the parent of the interceptor
         // it can be deleted before the browser-context still referencing it is.
         m_profileAdapter->setRequestInterceptor(nullptr);
+        m_profileAdapter->setBackgroundRequestInterceptor(nullptr);
         m_profileAdapter->removeClient(this);
     }
 
@@ -878,6 +879,23 @@ void QQuickWebEngineProfile::setUrlRequestInterceptor(QWebEngineUrlRequestInterc
     d->profileAdapter()->setRequestInterceptor(interceptor);
 }
 
+/*!
+    Registers a request interceptor singleton \a interceptor that intercepts URL
+    requests on a background thread, before the interceptors set with
+    setUrlRequestInterceptor() are run.
+
+    The interceptor must not access objects that live in the main thread.
+    The profile does not take ownership of the pointer.
+
+    \since 6.3
+    \sa QWebEngineProfile::setBackgroundUrlRequestInterceptor()
+*/
+void QQuickWebEngineProfile::setBackgroundUrlRequestInterceptor(QWebEngineUrlRequestInterceptor *interceptor)
+{
+    Q_D(QQuickWebEngineProfile);
+    d->profileAdapter()->setBackgroundRequestInterceptor(interceptor);
+}
+
 
 /*!
     Returns the custom URL scheme handler register for the URL scheme \a scheme.
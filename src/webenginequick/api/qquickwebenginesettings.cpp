@@ -454,6 +454,21 @@ bool QQuickWebEngineSettings::pdfViewerEnabled() const
     return d_ptr->testAttribute(QWebEngineSettings::PdfViewerEnabled);
 }
 
+/*!
+    \qmlproperty bool WebEngineSettings::binaryWebChannelTransportEnabled
+    \since QtWebEngine 6.3
+
+    Specifies that WebChannel messages sent to the page are encoded as CBOR
+    instead of JSON text, and delivered to the page as decoded objects.
+    Messages sent by the page are not affected.
+
+    Disabled by default.
+*/
+bool QQuickWebEngineSettings::binaryWebChannelTransportEnabled() const
+{
+    return d_ptr->testAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled);
+}
+
 /*!
     \qmlproperty string WebEngineSettings::defaultTextEncoding
     \since QtWebEngine 1.2
@@ -729,6 +744,14 @@ void QQuickWebEngineSettings::setPdfViewerEnabled(bool on)
         Q_EMIT pdfViewerEnabledChanged();
 }
 
+void QQuickWebEngineSettings::setBinaryWebChannelTransportEnabled(bool on)
+{
+    bool wasOn = d_ptr->testAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled);
+    d_ptr->setAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled, on);
+    if (wasOn != on)
+        Q_EMIT binaryWebChannelTransportEnabledChanged();
+}
+
 void QQuickWebEngineSettings::setUnknownUrlSchemePolicy(QQuickWebEngineSettings::UnknownUrlSchemePolicy policy)
 {
     QWebEngineSettings::UnknownUrlSchemePolicy oldPolicy = d_ptr->unknownUrlSchemePolicy();
@@ -1169,7 +1169,9 @@ void QQuickWebEngineViewPrivate::didPrintPage(quint64 requestId, QSharedPointer<
     Q_Q(QQuickWebEngineView);
     QJSValue callback = m_callbacks.take(requestId);
     QJSValueList args;
-    args.append(qmlEngine(q)->toScriptValue(*(result.data())));
+    // The result maps shared memory that goes away with it.
+    const QByteArray data = result ? QByteArray(result->constData(), result->size()) : QByteArray();
+    args.append(qmlEngine(q)->toScriptValue(data));
     callback.call(args);
 }
 
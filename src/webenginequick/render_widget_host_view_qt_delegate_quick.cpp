@@ -39,6 +39,7 @@
 
 #include "render_widget_host_view_qt_delegate_quick.h"
 
+#include "compositor/software_frame_texture.h"
 #include "render_widget_host_view_qt_delegate_client.h"
 
 #include "qquickwebengineview_p.h"
@@ -69,6 +70,7 @@ RenderWidgetHostViewQtDelegateQuick::RenderWidgetHostViewQtDelegateQuick(RenderW
 
 RenderWidgetHostViewQtDelegateQuick::~RenderWidgetHostViewQtDelegateQuick()
 {
+    releaseAcquiredFrame(compositor());
     unbind();
     QQuickWebEngineViewPrivate::bindViewAndWidget(nullptr, this);
 }
@@ -319,11 +321,41 @@ void RenderWidgetHostViewQtDelegateQuick::itemChange(ItemChange change, const It
 QSGNode *RenderWidgetHostViewQtDelegateQuick::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     auto comp = compositor();
+
+    // The previous frame has been uploaded by now, hand it back to the
+    // compositor's buffer ring.
+    releaseAcquiredFrame(comp);
+
     if (!comp)
         return nullptr;
 
     QQuickWindow *win = QQuickItem::window();
 
+    if (comp->type() != Compositor::Type::OpenGL
+        && QSGRendererInterface::isApiRhiBased(win->rendererInterface()->graphicsApi())) {
+        // Keep node and texture across frames, so that only the damaged
+        // part of the frame gets uploaded.
+        QSGImageNode *node = m_hasFrameTextureNode ? static_cast<QSGImageNode *>(oldNode) : nullptr;
+        if (!node) {
+            delete oldNode;
+            node = win->createImageNode();
+            node->setOwnsTexture(true);
+            node->setTexture(new SoftwareFrameTexture);
+            m_hasFrameTextureNode = true;
+        }
+
+        comp->swapFrame();
+        m_acquiredFrame = comp->acquireImage();
+        m_acquiredFrameCompositor = &*comp;
+
+        QSizeF texSizeInDips = QSizeF(comp->size()) / comp->devicePixelRatio();
+        node->setRect(QRectF(QPointF(0, 0), texSizeInDips));
+        static_cast<SoftwareFrameTexture *>(node->texture())->setFrame(m_acquiredFrame, comp->damageRect());
+        node->markDirty(QSGNode::DirtyMaterial);
+        return node;
+    }
+    m_hasFrameTextureNode = false;
+
     // Delete old node before swapFrame to decrement refcount of
     // QImage in software mode.
     delete oldNode;
@@ -336,7 +368,7 @@ QSGNode *RenderWidgetHostViewQtDelegateQuick::updatePaintNode(QSGNode *oldNode,
     QSizeF texSizeInDips = QSizeF(texSize) / comp->devicePixelRatio();
     node->setRect(QRectF(QPointF(0, 0), texSizeInDips));
 
-    if (comp->type() == Compositor::Type::Software) {
+    if (comp->type() == Compositor::Type::Software || comp->type() == Compositor::Type::Headless) {
         QImage image = comp->image();
         node->setTexture(win->createTextureFromImage(image));
     } else if (comp->type() == Compositor::Type::OpenGL) {
@@ -357,6 +389,19 @@ QSGNode *RenderWidgetHostViewQtDelegateQuick::updatePaintNode(QSGNode *oldNode,
     return node;
 }
 
+// A frame acquired from a compositor that has since been replaced is only
+// dropped: the old compositor is gone, and the new one cannot be holding
+// the same buffer while the frame still references it.
+void RenderWidgetHostViewQtDelegateQuick::releaseAcquiredFrame(const Compositor::Handle<Compositor> &comp)
+{
+    if (m_acquiredFrame.isNull())
+        return;
+    if (comp && &*comp == m_acquiredFrameCompositor)
+        comp->releaseImage(m_acquiredFrame);
+    m_acquiredFrame = QImage();
+    m_acquiredFrameCompositor = nullptr;
+}
+
 void RenderWidgetHostViewQtDelegateQuick::onBeforeRendering()
 {
     auto comp = compositor();
@@ -44,6 +44,7 @@
 #include "render_widget_host_view_qt_delegate.h"
 
 #include <QtGui/qaccessibleobject.h>
+#include <QtGui/qimage.h>
 #include <QtQuick/qquickitem.h>
 
 QT_BEGIN_NAMESPACE
@@ -113,9 +114,14 @@ private Q_SLOTS:
 private:
     friend QQuickWebEngineViewPrivate;
 
+    void releaseAcquiredFrame(const Compositor::Handle<Compositor> &comp);
+
     RenderWidgetHostViewQtDelegateClient *m_client;
     QList<QMetaObject::Connection> m_windowConnections;
     bool m_isPopup;
+    bool m_hasFrameTextureNode = false;
+    QImage m_acquiredFrame;
+    Compositor *m_acquiredFrameCompositor = nullptr;
     QQuickWebEngineView *m_view = nullptr;
 };
 
@@ -536,6 +536,12 @@ void QWebEngineViewPrivate::didPrintPage(QPrinter *&currentPrinter, QSharedPoint
     printerWorker->m_firstPageFirst = currentPrinter->pageOrder() == QPrinter::FirstPageFirst;
     printerWorker->m_documentCopies = currentPrinter->copyCount();
     printerWorker->m_collateCopies = currentPrinter->collateCopies();
+    // Chromium's PDF has none of the printer's document settings, so it can
+    // only be written as it is when the printer asks for none of them.
+    if (currentPrinter->outputFormat() == QPrinter::PdfFormat
+            && currentPrinter->pdfVersion() == QPrinter::PdfVersion_1_4
+            && currentPrinter->docName().isEmpty() && currentPrinter->creator().isEmpty())
+        printerWorker->m_pdfFileName = currentPrinter->outputFileName();
 
     QObject::connect(printerWorker, &QtWebEngineCore::PrinterWorker::resultReady, q, [q, &currentPrinter](bool success) {
         currentPrinter = nullptr;
@@ -0,0 +1,169 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <QtWebEngineCore/private/qwebenginemessagepumpscheduler_p.h>
+
+#include <QThread>
+
+class tst_QWebEngineMessagePumpScheduler : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void coalescesWakeUps();
+    void eventPerWakeUp();
+    void scheduleFromCallback();
+    void scheduleFromOtherThread();
+    void delayedWork();
+    void workSlice();
+};
+
+void tst_QWebEngineMessagePumpScheduler::coalescesWakeUps()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler scheduler([&]() { ++calls; });
+    QCOMPARE(scheduler.mode(), QWebEngineMessagePumpScheduler::Mode::Coalesced);
+    for (int i = 0; i < 100; ++i)
+        scheduler.scheduleWork();
+    QCoreApplication::processEvents();
+    QCOMPARE(calls, 1);
+    QCOMPARE(scheduler.statistics().workRequests, 100u);
+    QCOMPARE(scheduler.statistics().wakeUps, 1u);
+
+    scheduler.scheduleWork();
+    QCoreApplication::processEvents();
+    QCOMPARE(calls, 2);
+}
+
+void tst_QWebEngineMessagePumpScheduler::eventPerWakeUp()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler scheduler([&]() { ++calls; },
+                                             QWebEngineMessagePumpScheduler::Mode::EventPerWakeUp);
+    for (int i = 0; i < 10; ++i)
+        scheduler.scheduleWork();
+    QCoreApplication::processEvents();
+    QCOMPARE(calls, 10);
+    QCOMPARE(scheduler.statistics().wakeUps, 10u);
+}
+
+void tst_QWebEngineMessagePumpScheduler::scheduleFromCallback()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler *self = nullptr;
+    QWebEngineMessagePumpScheduler scheduler([&]() {
+        // more work came in while this round was running
+        if (++calls < 3)
+            self->scheduleWork();
+    });
+    self = &scheduler;
+    scheduler.scheduleWork();
+    QTRY_COMPARE(calls, 3);
+    QCoreApplication::processEvents();
+    QCOMPARE(calls, 3);
+}
+
+void tst_QWebEngineMessagePumpScheduler::scheduleFromOtherThread()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler scheduler([&]() { ++calls; });
+    QScopedPointer<QThread> thread(QThread::create([&]() {
+        for (int i = 0; i < 1000; ++i)
+            scheduler.scheduleWork();
+    }));
+    // This thread doesn't process events until all the work has been
+    // scheduled, so the first wake-up is still pending for all of it.
+    thread->start();
+    QVERIFY(thread->wait());
+    QCOMPARE(calls, 0);
+    QCoreApplication::processEvents();
+    const auto statistics = scheduler.statistics();
+    QCOMPARE(statistics.workRequests, 1000u);
+    QVERIFY(statistics.wakeUps < statistics.workRequests / 10);
+    QCOMPARE(statistics.wakeUps, 1u);
+    QCOMPARE(quint64(calls), statistics.wakeUps);
+}
+
+void tst_QWebEngineMessagePumpScheduler::delayedWork()
+{
+    int calls = 0;
+    QWebEngineMessagePumpScheduler scheduler([&]() { ++calls; });
+    scheduler.scheduleDelayedWork(10);
+    QTRY_COMPARE(calls, 1);
+
+    // immediate work also covers the delayed work
+    scheduler.scheduleDelayedWork(50);
+    scheduler.scheduleWork();
+    QCoreApplication::processEvents();
+    QCOMPARE(calls, 2);
+    QTest::qWait(100);
+    QCOMPARE(calls, 2);
+}
+
+void tst_QWebEngineMessagePumpScheduler::workSlice()
+{
+    using SliceEnd = QWebEngineMessagePumpScheduler::SliceEnd;
+    const auto noInput = []() { return false; };
+    int calls = 0;
+
+    // Runs until the work is done...
+    auto work = [&]() { return ++calls < 5; };
+    QCOMPARE(QWebEngineMessagePumpScheduler::runWorkSlice(work, QDeadlineTimer::Forever, noInput),
+             SliceEnd::NoImmediateWork);
+    QCOMPARE(calls, 5);
+
+    // ...or a single batch, when there is no time to run more...
+    calls = 0;
+    auto endless = [&]() { ++calls; return true; };
+    QCOMPARE(QWebEngineMessagePumpScheduler::runWorkSlice(endless, QDeadlineTimer(0), noInput),
+             SliceEnd::BudgetExhausted);
+    QCOMPARE(calls, 1);
+
+    // ...or as many as fit in the budget...
+    calls = 0;
+    QElapsedTimer timer;
+    timer.start();
+    auto slow = [&]() { ++calls; QThread::msleep(1); return true; };
+    QCOMPARE(QWebEngineMessagePumpScheduler::runWorkSlice(slow, QDeadlineTimer(20, Qt::PreciseTimer), noInput),
+             SliceEnd::BudgetExhausted);
+    QVERIFY(timer.elapsed() >= 20);
+    QVERIFY(calls > 1);
+
+    // ...but not past waiting input.
+    calls = 0;
+    QCOMPARE(QWebEngineMessagePumpScheduler::runWorkSlice(endless, QDeadlineTimer::Forever,
+                                                          [&]() { return calls == 3; }),
+             SliceEnd::InputPending);
+    QCOMPARE(calls, 3);
+}
+
+QTEST_MAIN(tst_QWebEngineMessagePumpScheduler)
+#include "tst_qwebenginemessagepumpscheduler.moc"
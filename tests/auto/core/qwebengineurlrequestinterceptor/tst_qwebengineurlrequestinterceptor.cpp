@@ -30,9 +30,11 @@
 #include <QtTest/QtTest>
 #include <QtWebEngineCore/qwebengineurlrequestinfo.h>
 #include <QtWebEngineCore/qwebengineurlrequestinterceptor.h>
+#include <QtWebEngineCore/qwebengineurlrequestrule.h>
 #include <QtWebEngineCore/qwebenginesettings.h>
 #include <QtWebEngineCore/qwebengineprofile.h>
 #include <QtWebEngineCore/qwebenginepage.h>
+#include <QtWebEngineCore/private/qwebengineurlrequestrule_p.h>
 
 #include <httpserver.h>
 #include <httpreqrep.h>
@@ -70,6 +72,10 @@ private Q_SLOTS:
     void replaceInterceptor_data();
     void replaceInterceptor();
     void replaceOnIntercept();
+    void backgroundInterceptor();
+    void urlRequestRules();
+    void urlRequestRuleMatcher_data();
+    void urlRequestRuleMatcher();
 };
 
 tst_QWebEngineUrlRequestInterceptor::tst_QWebEngineUrlRequestInterceptor()
@@ -869,5 +875,184 @@ void tst_QWebEngineUrlRequestInterceptor::replaceOnIntercept()
     QCOMPARE(profileInterceptor.requestInfos.size(), pageInterceptor2.requestInfos.size());
 }
 
+class BackgroundInterceptor : public QWebEngineUrlRequestInterceptor
+{
+public:
+    void interceptRequest(QWebEngineUrlRequestInfo &info) override
+    {
+        QMutexLocker locker(&mutex);
+        if (QThread::currentThread() == QCoreApplication::instance()->thread())
+            ++mainThreadCalls;
+        if (info.requestUrl().fileName() == QLatin1String("blocked.html"))
+            info.block(true);
+        requestedUrls.append(info.requestUrl());
+    }
+
+    QList<QUrl> urls()
+    {
+        QMutexLocker locker(&mutex);
+        return requestedUrls;
+    }
+
+    QMutex mutex;
+    QList<QUrl> requestedUrls;
+    int mainThreadCalls = 0;
+};
+
+void tst_QWebEngineUrlRequestInterceptor::backgroundInterceptor()
+{
+    QWebEngineProfile profile;
+    profile.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    BackgroundInterceptor backgroundInterceptor;
+    TestRequestInterceptor interceptor(/* intercept */ false);
+    profile.setBackgroundUrlRequestInterceptor(&backgroundInterceptor);
+    profile.setUrlRequestInterceptor(&interceptor);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+
+    const QUrl url("qrc:///resources/index.html");
+    page.load(url);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    QVERIFY(backgroundInterceptor.urls().contains(url));
+    // Unchanged requests are passed on to the main thread interceptors.
+    QVERIFY(std::any_of(interceptor.requestInfos.cbegin(), interceptor.requestInfos.cend(),
+                        [&] (const RequestInfo &info) { return info.requestUrl == url; }));
+
+    const QUrl blockedUrl("qrc:///resources/blocked.html");
+    page.load(blockedUrl);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(!loadSpy.takeFirst().takeFirst().toBool());
+    QVERIFY(backgroundInterceptor.urls().contains(blockedUrl));
+    QVERIFY(std::none_of(interceptor.requestInfos.cbegin(), interceptor.requestInfos.cend(),
+                         [&] (const RequestInfo &info) { return info.requestUrl == blockedUrl; }));
+
+    QCOMPARE(backgroundInterceptor.mainThreadCalls, 0);
+    profile.setBackgroundUrlRequestInterceptor(nullptr);
+}
+
+void tst_QWebEngineUrlRequestInterceptor::urlRequestRules()
+{
+    QWebEngineProfile profile;
+    profile.settings()->setAttribute(QWebEngineSettings::ErrorPageEnabled, false);
+    TestRequestInterceptor interceptor(/* intercept */ false);
+    profile.setUrlRequestInterceptor(&interceptor);
+
+    QWebEngineUrlRequestRule blockRule("/blocked.html|");
+    QWebEngineUrlRequestRule redirectRule("|qrc:*/index.html^", QWebEngineUrlRequestRule::Redirect);
+    redirectRule.setRedirectUrl(kRedirectUrl);
+    QWebEngineUrlRequestRule imageRule("/*.png", QWebEngineUrlRequestRule::Block);
+    imageRule.setResourceTypes({ QWebEngineUrlRequestInfo::ResourceTypeImage });
+    const QList<QWebEngineUrlRequestRule> rules = { blockRule, redirectRule, imageRule };
+    profile.setUrlRequestRules(rules);
+    QCOMPARE(profile.urlRequestRules(), rules);
+
+    QWebEnginePage page(&profile);
+    QSignalSpy loadSpy(&page, SIGNAL(loadFinished(bool)));
+
+    const QUrl blockedUrl("qrc:///resources/blocked.html");
+    page.load(blockedUrl);
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(!loadSpy.takeFirst().takeFirst().toBool());
+    // Blocked requests never reach the interceptors.
+    QVERIFY(std::none_of(interceptor.requestInfos.cbegin(), interceptor.requestInfos.cend(),
+                         [&] (const RequestInfo &info) { return info.requestUrl == blockedUrl; }));
+
+    page.load(QUrl("qrc:///resources/index.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    QCOMPARE(page.url(), kRedirectUrl);
+    QVERIFY(std::any_of(interceptor.requestInfos.cbegin(), interceptor.requestInfos.cend(),
+                        [&] (const RequestInfo &info) { return info.requestUrl == kRedirectUrl; }));
+
+    profile.setUrlRequestRules({});
+    QVERIFY(profile.urlRequestRules().isEmpty());
+    page.load(QUrl("qrc:///resources/index.html"));
+    QTRY_COMPARE(loadSpy.count(), 1);
+    QVERIFY(loadSpy.takeFirst().takeFirst().toBool());
+    QCOMPARE(page.url(), QUrl("qrc:///resources/index.html"));
+}
+
+void tst_QWebEngineUrlRequestInterceptor::urlRequestRuleMatcher_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<int>("ruleResourceType"); // -1 for any
+    QTest::addColumn<QStringList>("firstPartyDomains");
+    QTest::addColumn<QByteArray>("url");
+    QTest::addColumn<QByteArray>("firstPartyHost");
+    QTest::addColumn<int>("resourceType");
+    QTest::addColumn<bool>("matches");
+
+    const int script = QWebEngineUrlRequestInfo::ResourceTypeScript;
+    const int image = QWebEngineUrlRequestInfo::ResourceTypeImage;
+
+    QTest::newRow("domain") << QStringLiteral("||example.com^") << -1 << QStringList()
+                            << QByteArray("https://example.com/a") << QByteArray() << script << true;
+    QTest::newRow("domain/subdomain") << QStringLiteral("||example.com^") << -1 << QStringList()
+                                      << QByteArray("https://sub.example.com/") << QByteArray() << script << true;
+    QTest::newRow("domain/case") << QStringLiteral("||EXAMPLE.com^") << -1 << QStringList()
+                                 << QByteArray("https://example.com/") << QByteArray() << script << true;
+    QTest::newRow("domain/suffix") << QStringLiteral("||example.com^") << -1 << QStringList()
+                                   << QByteArray("https://notexample.com/") << QByteArray() << script << false;
+    QTest::newRow("domain/prefix") << QStringLiteral("||example.com^") << -1 << QStringList()
+                                   << QByteArray("https://example.com.evil.org/") << QByteArray() << script << false;
+    QTest::newRow("domain/query") << QStringLiteral("||example.com^") << -1 << QStringList()
+                                  << QByteArray("https://other.org/?u=example.com") << QByteArray() << script << false;
+    QTest::newRow("start") << QStringLiteral("|https://example.org/") << -1 << QStringList()
+                           << QByteArray("https://example.org/x") << QByteArray() << script << true;
+    QTest::newRow("start/middle") << QStringLiteral("|https://example.org/") << -1 << QStringList()
+                                  << QByteArray("http://x.org/https://example.org/") << QByteArray() << script << false;
+    QTest::newRow("end") << QStringLiteral("/ads/*.gif|") << -1 << QStringList()
+                         << QByteArray("https://a.org/ads/banner.gif") << QByteArray() << image << true;
+    QTest::newRow("end/query") << QStringLiteral("/ads/*.gif|") << -1 << QStringList()
+                               << QByteArray("https://a.org/ads/banner.gif?x") << QByteArray() << image << false;
+    QTest::newRow("separator/port") << QStringLiteral("example.com^") << -1 << QStringList()
+                                    << QByteArray("https://example.com:8080/") << QByteArray() << script << true;
+    QTest::newRow("separator/letter") << QStringLiteral("example.com^") << -1 << QStringList()
+                                      << QByteArray("https://example.community/") << QByteArray() << script << false;
+    QTest::newRow("separator/end") << QStringLiteral("^ad^") << -1 << QStringList()
+                                   << QByteArray("https://a.org/ad") << QByteArray() << script << true;
+    QTest::newRow("separator/token") << QStringLiteral("^ad^") << -1 << QStringList()
+                                     << QByteArray("https://a.org/adx") << QByteArray() << script << false;
+    QTest::newRow("wildcard") << QStringLiteral("*tracker*") << -1 << QStringList()
+                              << QByteArray("https://cdn.org/tracker.js") << QByteArray() << script << true;
+    QTest::newRow("type") << QStringLiteral("/script.js") << script << QStringList()
+                          << QByteArray("https://a.org/script.js") << QByteArray() << script << true;
+    QTest::newRow("type/other") << QStringLiteral("/script.js") << script << QStringList()
+                                << QByteArray("https://a.org/script.js") << QByteArray() << image << false;
+    QTest::newRow("firstparty") << QStringLiteral("||cdn.org^") << -1 << QStringList { QStringLiteral("example.com") }
+                                << QByteArray("https://cdn.org/x") << QByteArray("www.example.com") << script << true;
+    QTest::newRow("firstparty/other") << QStringLiteral("||cdn.org^") << -1 << QStringList { QStringLiteral("example.com") }
+                                      << QByteArray("https://cdn.org/x") << QByteArray("example.org") << script << false;
+    QTest::newRow("firstparty/suffix") << QStringLiteral("||cdn.org^") << -1 << QStringList { QStringLiteral("example.com") }
+                                       << QByteArray("https://cdn.org/x") << QByteArray("badexample.com") << script << false;
+    QTest::newRow("idn/domain") << QString::fromUtf8("||b\xc3\xbc" "cher.de^") << -1 << QStringList()
+                                << QByteArray("https://xn--bcher-kva.de/") << QByteArray() << script << true;
+    QTest::newRow("idn/path") << QString::fromUtf8("/stra\xc3\x9f" "e") << -1 << QStringList()
+                              << QByteArray("https://a.org/stra%C3%9Fe") << QByteArray() << script << true;
+    QTest::newRow("idn/firstparty") << QStringLiteral("||cdn.org^") << -1 << QStringList { QString::fromUtf8("b\xc3\xbc" "cher.de") }
+                                    << QByteArray("https://cdn.org/x") << QByteArray("xn--bcher-kva.de") << script << true;
+}
+
+void tst_QWebEngineUrlRequestInterceptor::urlRequestRuleMatcher()
+{
+    QFETCH(QString, pattern);
+    QFETCH(int, ruleResourceType);
+    QFETCH(QStringList, firstPartyDomains);
+    QFETCH(QByteArray, url);
+    QFETCH(QByteArray, firstPartyHost);
+    QFETCH(int, resourceType);
+    QFETCH(bool, matches);
+
+    QWebEngineUrlRequestRule rule(pattern);
+    if (ruleResourceType >= 0)
+        rule.setResourceTypes({ QWebEngineUrlRequestInfo::ResourceType(ruleResourceType) });
+    rule.setFirstPartyDomains(firstPartyDomains);
+    // An unrelated rule makes sure the index doesn't hide the one under test.
+    const QWebEngineUrlRequestRuleMatcher matcher({ QWebEngineUrlRequestRule("||unrelated.net^"), rule });
+    QCOMPARE(matcher.match(url, firstPartyHost, QWebEngineUrlRequestInfo::ResourceType(resourceType)).block,
+             matches);
+}
+
 QTEST_MAIN(tst_QWebEngineUrlRequestInterceptor)
 #include "tst_qwebengineurlrequestinterceptor.moc"
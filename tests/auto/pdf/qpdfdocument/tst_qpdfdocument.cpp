@@ -44,6 +44,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QtPdf/private/qpdfdocument_p.h>
 
 class tst_QPdfDocument: public QObject
 {
@@ -66,6 +67,10 @@ private slots:
     void status();
     void passwordClearedOnClose();
     void metaData();
+    void extractText_data();
+    void extractText();
+    void renderIntoImage();
+    void loadedPagesCache();
 };
 
 struct TemporaryPdf: public QTemporaryFile
@@ -380,7 +385,169 @@ void tst_QPdfDocument::metaData()
     QCOMPARE(doc.metaData(QPdfDocument::ModificationDate).toDateTime(), QDateTime(QDate(2016, 8, 8), QTime(8, 3, 6), Qt::UTC));
 }
 
+class TextCollector : public QPdfTextSink
+{
+public:
+    void beginPage(int page, QSizeF pageSize) override
+    {
+        pages << page;
+        pageSizes << pageSize;
+        threadsOk &= (QThread::currentThread() == thread);
+    }
+    void addRun(const QPdfTextRun &run) override
+    {
+        runs << run;
+        threadsOk &= (QThread::currentThread() == thread);
+    }
+
+    QThread *thread = QThread::currentThread();
+    bool threadsOk = true;
+    QList<int> pages;
+    QList<QSizeF> pageSizes;
+    QList<QPdfTextRun> runs;
+};
+
+void tst_QPdfDocument::extractText_data()
+{
+    QTest::addColumn<QPdfDocument::TextExtractionOptions>("options");
+
+    QTest::newRow("sequential") << QPdfDocument::TextExtractionOptions();
+    QTest::newRow("parallel") << QPdfDocument::TextExtractionOptions(QPdfDocument::ExtractInParallel);
+}
+
+void tst_QPdfDocument::extractText()
+{
+    QFETCH(QPdfDocument::TextExtractionOptions, options);
+    TemporaryPdf tempPdf;
+    QPdfDocument doc;
+
+    TextCollector notReady;
+    QVERIFY(!doc.extractText(&notReady));
+    QVERIFY(notReady.pages.isEmpty());
+
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+    QVERIFY(!doc.extractText(&notReady, 0, 2, options));
+    QVERIFY(!doc.extractText(&notReady, 1, 0, options));
+
+    TextCollector collector;
+    QVERIFY(doc.extractText(&collector, 0, -1, options));
+    QVERIFY(collector.threadsOk);
+    QCOMPARE(collector.pages, QList<int>({0, 1}));
+    QCOMPARE(collector.pageSizes.first().toSize(), tempPdf.pageLayout.fullRectPoints().size());
+    QCOMPARE(collector.runs.count(), 2);
+    for (int page = 0; page < 2; ++page) {
+        const QPdfTextRun &run = collector.runs.at(page);
+        QCOMPARE(run.page(), page);
+        QCOMPARE(run.text(), QStringLiteral("Hello Page %1").arg(page + 1));
+        QCOMPARE(run.startIndex(), 0);
+        QVERIFY(run.fontSize() > 0);
+        QVERIFY(!run.fontName().isEmpty());
+        QVERIFY(!run.boundingRectangle().isEmpty());
+        QCOMPARE(run.text(), doc.getAllText(page).text());
+    }
+
+    TextCollector secondPage;
+    QVERIFY(doc.extractText(&secondPage, 1, 1, options));
+    QCOMPARE(secondPage.pages, QList<int>{1});
+    QCOMPARE(secondPage.runs.count(), 1);
+}
+
+void tst_QPdfDocument::renderIntoImage()
+{
+    TemporaryPdf tempPdf;
+    QPdfDocument doc;
+    QCOMPARE(doc.load(tempPdf.fileName()), QPdfDocument::NoError);
+
+    QImage image(100, 140, QImage::Format_RGB32);
+    image.fill(Qt::black);
+    const uchar *bits = image.constBits();
+    QVERIFY(doc.render(0, &image));
+    QCOMPARE(image.constBits(), bits);
+    QCOMPARE(image.size(), QSize(100, 140));
+    // the page has no content in its top left corner
+    QCOMPARE(image.pixel(1, 1), qRgb(255, 255, 255));
+
+    QImage transparent(100, 140, QImage::Format_ARGB32);
+    transparent.fill(Qt::red);
+    QVERIFY(doc.render(0, &transparent));
+    QCOMPARE(qAlpha(transparent.pixel(1, 1)), 0);
+
+    QPdfDocumentRenderOptions opaque;
+    opaque.setRenderFlags(QPdf::RenderOpaque);
+    QVERIFY(doc.render(0, &transparent, opaque));
+    QCOMPARE(transparent.pixel(1, 1), qRgb(255, 255, 255));
+
+    const QImage rendered = doc.render(0, QSize(100, 140), opaque);
+    QCOMPARE(rendered.format(), QImage::Format_RGB32);
+    QCOMPARE(rendered.pixel(1, 1), qRgb(255, 255, 255));
+
+    QImage unsupported(100, 140, QImage::Format_Grayscale8);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("cannot render into an image"));
+    QVERIFY(!doc.render(0, &unsupported));
+    QVERIFY(!doc.render(2, &image));
+    QVERIFY(!doc.render(0, nullptr));
+}
+
+// Text queries keep the pages they load, most recently used first.
+void tst_QPdfDocument::loadedPagesCache()
+{
+    const int pageCount = QPdfDocumentPrivate::MaxLoadedPages + 4;
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    {
+        QPrinter printer;
+        printer.setOutputFormat(QPrinter::PdfFormat);
+        printer.setOutputFileName(file.fileName());
+        QPainter painter(&printer);
+        for (int page = 0; page < pageCount; ++page) {
+            if (page > 0)
+                printer.newPage();
+            painter.drawText(100, 100, QStringLiteral("Page %1").arg(page));
+        }
+    }
+
+    QPdfDocument doc;
+    QCOMPARE(doc.load(file.fileName()), QPdfDocument::NoError);
+    QCOMPARE(doc.pageCount(), pageCount);
+    const QPdfDocumentPrivate *d = QPdfDocumentPrivate::get(&doc);
+    QVERIFY(d->loadedPages.isEmpty());
+
+    // Selecting on the same page again and again uses the same handles.
+    const QRectF textRect = doc.getAllText(0).boundingRectangle();
+    QVERIFY(!textRect.isEmpty());
+    const QPointF start(textRect.left() + 1, textRect.center().y());
+    const QPointF end(textRect.right() - 1, textRect.center().y());
+    QCOMPARE(doc.getSelection(0, start, end).text(), QStringLiteral("Page 0"));
+    QCOMPARE(d->loadedPages.count(), 1);
+    const FPDF_PAGE pdfPage = d->loadedPages.first().pdfPage;
+    const FPDF_TEXTPAGE textPage = d->loadedPages.first().textPage;
+    QVERIFY(pdfPage);
+    QVERIFY(textPage);
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(doc.getSelection(0, start, end).text(), QStringLiteral("Page 0"));
+        QCOMPARE(doc.getSelectionAtIndex(0, 0, 100).text(), QStringLiteral("Page 0"));
+    }
+    QCOMPARE(d->loadedPages.count(), 1);
+    QCOMPARE(d->loadedPages.first().pdfPage, pdfPage);
+    QCOMPARE(d->loadedPages.first().textPage, textPage);
+
+    // Going through more pages than are kept closes the least recently used
+    // ones, which are loaded again when they are needed.
+    for (int page = 0; page < pageCount; ++page)
+        QCOMPARE(doc.getAllText(page).text(), QStringLiteral("Page %1").arg(page));
+    QCOMPARE(d->loadedPages.count(), QPdfDocumentPrivate::MaxLoadedPages);
+    QCOMPARE(d->loadedPages.first().page, pageCount - 1);
+    QCOMPARE(d->loadedPages.last().page, pageCount - QPdfDocumentPrivate::MaxLoadedPages);
+    for (int page = 0; page < pageCount; ++page) {
+        QCOMPARE(doc.getSelectionAtIndex(page, 0, 100).text(), QStringLiteral("Page %1").arg(page));
+        QCOMPARE(d->loadedPages.first().page, page);
+    }
+    QCOMPARE(d->loadedPages.count(), QPdfDocumentPrivate::MaxLoadedPages);
+
+    doc.close();
+    QVERIFY(d->loadedPages.isEmpty());
+}
+
 QTEST_MAIN(tst_QPdfDocument)
 
 #include "tst_qpdfdocument.moc"
-
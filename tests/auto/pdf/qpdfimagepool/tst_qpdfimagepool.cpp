@@ -0,0 +1,113 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QtPdf/private/qpdfimagepool_p.h>
+
+class tst_QPdfImagePool: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void reusesBuffers();
+    void boundsIdleBytes();
+    void imageOutlivesPool();
+};
+
+void tst_QPdfImagePool::reusesBuffers()
+{
+    QPdfImagePool pool;
+    QImage image = pool.image(QSize(64, 32), QImage::Format_ARGB32);
+    QCOMPARE(image.size(), QSize(64, 32));
+    QCOMPARE(image.format(), QImage::Format_ARGB32);
+    QCOMPARE(image.bytesPerLine(), 64 * 4);
+    const uchar *bits = image.constBits();
+    QCOMPARE(pool.idleBytes(), 0);
+
+    // a copy shares the buffer, which is only recycled with the last copy
+    QImage copy = image;
+    image = QImage();
+    QCOMPARE(pool.idleBytes(), 0);
+    copy = QImage();
+    QCOMPARE(pool.idleBytes(), 64 * 32 * 4);
+
+    // the same number of bytes is enough, whatever the shape and format
+    const QImage reused = pool.image(QSize(32, 64), QImage::Format_RGB32);
+    QCOMPARE(reused.constBits(), bits);
+    QCOMPARE(pool.idleBytes(), 0);
+
+    const QImage other = pool.image(QSize(16, 16), QImage::Format_RGB32);
+    QVERIFY(other.constBits() != bits);
+
+    QVERIFY(pool.image(QSize(), QImage::Format_RGB32).isNull());
+}
+
+void tst_QPdfImagePool::boundsIdleBytes()
+{
+    const qint64 bytes = 32 * 32 * 4;
+    QPdfImagePool pool(2 * bytes);
+    QList<QImage> images;
+    for (int i = 0; i < 4; ++i)
+        images.append(pool.image(QSize(32, 32), QImage::Format_ARGB32));
+    images.clear();
+    QCOMPARE(pool.idleBytes(), 2 * bytes);
+
+    pool.setMaxIdleBytes(bytes);
+    QCOMPARE(pool.idleBytes(), bytes);
+
+    { const QImage tooLarge = pool.image(QSize(64, 64), QImage::Format_ARGB32); }
+    QCOMPARE(pool.idleBytes(), bytes);
+
+    pool.clear();
+    QCOMPARE(pool.idleBytes(), 0);
+}
+
+void tst_QPdfImagePool::imageOutlivesPool()
+{
+    QImage image;
+    {
+        QPdfImagePool pool;
+        image = pool.image(QSize(8, 8), QImage::Format_ARGB32);
+    }
+    image.fill(Qt::red);
+    QCOMPARE(image.pixel(7, 7), qRgb(255, 0, 0));
+    image = QImage();
+}
+
+QTEST_MAIN(tst_QPdfImagePool)
+
+#include "tst_qpdfimagepool.moc"
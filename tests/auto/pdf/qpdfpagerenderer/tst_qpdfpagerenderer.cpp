@@ -50,6 +50,9 @@ private slots:
     void withLoadedDocumentSingleThreaded();
     void withLoadedDocumentMultiThreaded();
     void switchingRenderMode();
+    void prioritiesAndCancellation();
+    void multipleWorkers();
+    void changingWorkersWhileRendering();
 };
 
 void tst_QPdfPageRenderer::defaultValues()
@@ -58,6 +61,7 @@ void tst_QPdfPageRenderer::defaultValues()
 
     QCOMPARE(pageRenderer.document(), nullptr);
     QCOMPARE(pageRenderer.renderMode(), QPdfPageRenderer::RenderMode::SingleThreaded);
+    QCOMPARE(pageRenderer.workerCount(), 1);
 }
 
 void tst_QPdfPageRenderer::withNoDocument()
@@ -179,6 +183,119 @@ void tst_QPdfPageRenderer::switchingRenderMode()
     QCOMPARE(pageRenderedSpy[0][4].toULongLong(), thirdRequestId);
 }
 
+void tst_QPdfPageRenderer::prioritiesAndCancellation()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    // The first request goes to the worker right away, the others wait in the queue.
+    const quint64 firstRequestId = pageRenderer.requestPage(0, QSize(100, 100));
+    const quint64 lowRequestId = pageRenderer.requestPage(0, QSize(110, 110), QPdfDocumentRenderOptions(), 0);
+    const quint64 highRequestId = pageRenderer.requestPage(0, QSize(120, 120), QPdfDocumentRenderOptions(), 5);
+    const quint64 cancelledRequestId = pageRenderer.requestPage(0, QSize(130, 130));
+
+    // identical requests are merged
+    QCOMPARE(pageRenderer.requestPage(0, QSize(120, 120), QPdfDocumentRenderOptions(), 0), highRequestId);
+    QCOMPARE(pageRenderer.requestPage(0, QSize(100, 100)), firstRequestId);
+
+    QVERIFY(pageRenderer.cancelRequest(cancelledRequestId));
+    QVERIFY(!pageRenderer.cancelRequest(cancelledRequestId));
+    QVERIFY(!pageRenderer.cancelRequest(firstRequestId));
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 3);
+    QCOMPARE(pageRenderedSpy[0][4].toULongLong(), firstRequestId);
+    QCOMPARE(pageRenderedSpy[1][4].toULongLong(), highRequestId);
+    QCOMPARE(pageRenderedSpy[2][4].toULongLong(), lowRequestId);
+    QTest::qWait(50);
+    QCOMPARE(pageRenderedSpy.count(), 3);
+
+    // reprioritizing and cancelling everything
+    pageRenderedSpy.clear();
+    pageRenderer.requestPage(0, QSize(100, 100));
+    const quint64 secondId = pageRenderer.requestPage(0, QSize(110, 110));
+    const quint64 thirdId = pageRenderer.requestPage(0, QSize(120, 120));
+    QVERIFY(pageRenderer.setRequestPriority(thirdId, 1));
+    QTRY_COMPARE(pageRenderedSpy.count(), 3);
+    QCOMPARE(pageRenderedSpy[1][4].toULongLong(), thirdId);
+    QCOMPARE(pageRenderedSpy[2][4].toULongLong(), secondId);
+    QVERIFY(!pageRenderer.setRequestPriority(thirdId, 2));
+
+    pageRenderedSpy.clear();
+    pageRenderer.requestPage(0, QSize(100, 100));
+    pageRenderer.requestPage(0, QSize(110, 110));
+    pageRenderer.cancelAllRequests();
+    QTRY_COMPARE(pageRenderedSpy.count(), 1);
+    QTest::qWait(50);
+    QCOMPARE(pageRenderedSpy.count(), 1);
+}
+
+void tst_QPdfPageRenderer::multipleWorkers()
+{
+    QPdfDocument document;
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::RenderMode::MultiThreaded);
+
+    QSignalSpy workerCountChangedSpy(&pageRenderer, &QPdfPageRenderer::workerCountChanged);
+    pageRenderer.setWorkerCount(3);
+    QCOMPARE(pageRenderer.workerCount(), 3);
+    QCOMPARE(workerCountChangedSpy.count(), 1);
+    pageRenderer.setWorkerCount(0);
+    QCOMPARE(pageRenderer.workerCount(), 1);
+    pageRenderer.setWorkerCount(3);
+
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    QSet<quint64> requestIds;
+    for (int i = 0; i < 8; ++i)
+        requestIds.insert(pageRenderer.requestPage(0, QSize(100 + i, 100 + i)));
+    QCOMPARE(requestIds.size(), 8);
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 8);
+    QSet<quint64> renderedIds;
+    for (const auto &arguments : qAsConst(pageRenderedSpy)) {
+        QCOMPARE(arguments[2].value<QImage>().size(), arguments[1].toSize());
+        renderedIds.insert(arguments[4].toULongLong());
+    }
+    QCOMPARE(renderedIds, requestIds);
+}
+
+void tst_QPdfPageRenderer::changingWorkersWhileRendering()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("pdf-sample.pagerenderer.pdf")), QPdfDocument::NoError);
+    QPdfPageRenderer pageRenderer;
+    pageRenderer.setDocument(&document);
+    pageRenderer.setRenderMode(QPdfPageRenderer::RenderMode::MultiThreaded);
+    QSignalSpy pageRenderedSpy(&pageRenderer, &QPdfPageRenderer::pageRendered);
+
+    QSet<quint64> requestIds;
+    for (int i = 0; i < 8; ++i)
+        requestIds.insert(pageRenderer.requestPage(0, QSize(200 + i, 200 + i)));
+
+    // Replacing the workers catches some of them before and some after they
+    // got to their request. Either way, each request is rendered once.
+    for (int i = 0; i < 6; ++i) {
+        pageRenderer.setWorkerCount(i % 2 ? 1 : 2);
+        QTest::qWait(i);
+    }
+
+    QTRY_COMPARE(pageRenderedSpy.count(), 8);
+    QTest::qWait(100);
+    QCOMPARE(pageRenderedSpy.count(), 8);
+    QSet<quint64> renderedIds;
+    for (const auto &arguments : qAsConst(pageRenderedSpy))
+        renderedIds.insert(arguments[4].toULongLong());
+    QCOMPARE(renderedIds, requestIds);
+}
+
 QTEST_MAIN(tst_QPdfPageRenderer)
 
 #include "tst_qpdfpagerenderer.moc"
@@ -0,0 +1,272 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QBuffer>
+#include <QFile>
+#include <QPainter>
+#include <QPdfDocument>
+#include <QPdfRangeFetcher>
+#include <QPdfWriter>
+#include <QtPdf/private/qpdfrangefetcher_p.h>
+
+#include <QtTest/QtTest>
+
+using Range = QPdfByteRangeSet::Range;
+
+// Serves a document from memory, one event loop iteration after each fetch.
+class MemoryFetcher : public QPdfRangeFetcher
+{
+public:
+    explicit MemoryFetcher(const QByteArray &data) : m_data(data) { }
+
+    qint64 size() const override { return m_data.size(); }
+    void fetch(qint64 offset, qint64 length) override
+    {
+        fetches.append({offset, length});
+        QTimer::singleShot(0, this, [this, offset, length]() {
+            emit dataFetched(offset, m_data.mid(offset, length));
+        });
+    }
+
+    QList<Range> fetches;
+
+private:
+    QByteArray m_data;
+};
+
+// Serves a document from memory like MemoryFetcher, except for the bytes in
+// a range of it, which only arrive once release() is called.
+class WithholdingFetcher : public QPdfRangeFetcher
+{
+public:
+    WithholdingFetcher(const QByteArray &data, Range withheld)
+        : m_data(data), m_withheld(withheld) { }
+
+    qint64 size() const override { return m_data.size(); }
+    void fetch(qint64 offset, qint64 length) override
+    {
+        const qint64 end = offset + length;
+        const qint64 withheldEnd = m_withheld.start + m_withheld.length;
+        deliver(offset, qMin(end, m_withheld.start) - offset);
+        deliver(qMax(offset, withheldEnd), end - qMax(offset, withheldEnd));
+        const qint64 heldStart = qMax(offset, m_withheld.start);
+        const qint64 heldEnd = qMin(end, withheldEnd);
+        if (heldStart < heldEnd)
+            m_held.append({heldStart, heldEnd - heldStart});
+    }
+
+    void release()
+    {
+        for (const Range &range : std::exchange(m_held, {}))
+            deliver(range.start, range.length);
+    }
+
+    int inFlight() const { return m_inFlight; }
+
+private:
+    void deliver(qint64 offset, qint64 length)
+    {
+        if (length <= 0)
+            return;
+        ++m_inFlight;
+        QTimer::singleShot(0, this, [this, offset, length]() {
+            --m_inFlight;
+            emit dataFetched(offset, m_data.mid(offset, length));
+        });
+    }
+
+    QByteArray m_data;
+    Range m_withheld;
+    QList<Range> m_held;
+    int m_inFlight = 0;
+};
+
+class tst_QPdfRangeFetcher: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void byteRangeSet();
+    void progressiveLoad();
+    void renderBeforeDownloadCompletes();
+    void closeWhileLoading();
+};
+
+static QByteArray createPdf(int pageCount)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QPdfWriter writer(&buffer);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        QPainter painter(&writer);
+        for (int page = 0; page < pageCount; ++page) {
+            if (page)
+                writer.newPage();
+            painter.drawText(100, 100, QStringLiteral("Hello Page %1").arg(page + 1));
+        }
+    }
+    return data;
+}
+
+void tst_QPdfRangeFetcher::byteRangeSet()
+{
+    QPdfByteRangeSet set;
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.contains(0, 1));
+    QCOMPARE(set.gaps(0, 10), QList<Range>{Range{0, 10}});
+
+    set.add(10, 10);
+    set.add(30, 10);
+    QVERIFY(set.contains(10, 10));
+    QVERIFY(set.contains(12, 5));
+    QVERIFY(!set.contains(15, 10));
+    QCOMPARE(set.gaps(0, 50), QList<Range>({Range{0, 10}, Range{20, 10}, Range{40, 10}}));
+    QCOMPARE(set.gaps(15, 20), QList<Range>{Range{20, 10}});
+
+    // Touching ranges are merged.
+    set.add(20, 10);
+    QVERIFY(set.contains(10, 30));
+    QCOMPARE(set.gaps(0, 50), QList<Range>({Range{0, 10}, Range{40, 10}}));
+
+    set.remove(15, 10);
+    QVERIFY(set.contains(10, 5));
+    QVERIFY(set.contains(25, 15));
+    QVERIFY(!set.contains(14, 2));
+    QCOMPARE(set.gaps(10, 30), QList<Range>{Range{15, 10}});
+
+    set.remove(0, 100);
+    QVERIFY(set.isEmpty());
+}
+
+void tst_QPdfRangeFetcher::progressiveLoad()
+{
+    const QByteArray data = createPdf(3);
+    MemoryFetcher fetcher(data);
+    QPdfDocument document;
+    QSignalSpy pageAvailableSpy(&document, &QPdfDocument::pageAvailable);
+
+    document.load(&fetcher);
+    QCOMPARE(document.status(), QPdfDocument::Loading);
+    QVERIFY(!fetcher.fetches.isEmpty());
+    QTRY_COMPARE(document.status(), QPdfDocument::Ready);
+    QCOMPARE(document.pageCount(), 3);
+    QVERIFY(!document.pageSize(2).isEmpty());
+
+    // Each page is reported once, and the whole document arrives in the end.
+    QTRY_COMPARE(pageAvailableSpy.count(), 3);
+    QList<int> pages;
+    for (const QList<QVariant> &arguments : qAsConst(pageAvailableSpy))
+        pages.append(arguments.first().toInt());
+    std::sort(pages.begin(), pages.end());
+    QCOMPARE(pages, QList<int>({0, 1, 2}));
+
+    QPdfByteRangeSet fetched;
+    for (const Range &range : qAsConst(fetcher.fetches)) {
+        QVERIFY(!fetched.contains(range.start, range.length));
+        fetched.add(range.start, range.length);
+    }
+    QVERIFY(fetched.contains(0, data.size()));
+
+    for (int page = 0; page < 3; ++page) {
+        QVERIFY(document.isPageAvailable(page));
+        QVERIFY(!document.render(page, QSize(100, 141)).isNull());
+        QCOMPARE(document.getAllText(page).text(), QStringLiteral("Hello Page %1").arg(page + 1));
+    }
+    QVERIFY(!document.isPageAvailable(3));
+}
+
+void tst_QPdfRangeFetcher::renderBeforeDownloadCompletes()
+{
+    // A linearized document of four pages, the content of whose last page
+    // is held back.
+    QFile file(QFINDTESTDATA("linearized.pdf"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    const QByteArray lastPageText("(Last page)");
+    const qsizetype withheld = data.indexOf(lastPageText);
+    QVERIFY(withheld > 0);
+    WithholdingFetcher fetcher(data, Range{withheld, lastPageText.size()});
+    QPdfDocument document;
+    QSignalSpy pageAvailableSpy(&document, &QPdfDocument::pageAvailable);
+
+    document.load(&fetcher);
+    QTRY_COMPARE(document.status(), QPdfDocument::Ready);
+    QCOMPARE(document.pageCount(), 4);
+    QTRY_COMPARE(fetcher.inFlight(), 0);
+
+    // Asking whether a page is there, or for its size, doesn't request it.
+    QVERIFY(!document.isPageAvailable(1));
+    QVERIFY(!document.pageSize(1).isEmpty());
+    QTest::qWait(20);
+    QVERIFY(!document.isPageAvailable(1));
+
+    // Rendering it does, and it can be shown while the download goes on.
+    QVERIFY(document.render(1, QSize(100, 141)).isNull());
+    QTRY_VERIFY(document.isPageAvailable(1));
+    QVERIFY(!document.render(1, QSize(100, 141)).isNull());
+    QCOMPARE(document.getAllText(1).text(), QStringLiteral("Page 2"));
+
+    QVERIFY(document.render(3, QSize(100, 141)).isNull());
+    QTest::qWait(20);
+    QVERIFY(!document.isPageAvailable(3));
+    for (const QList<QVariant> &arguments : qAsConst(pageAvailableSpy))
+        QVERIFY(arguments.first().toInt() != 3);
+
+    // The last page follows with the rest of the document.
+    fetcher.release();
+    QTRY_VERIFY(document.isPageAvailable(3));
+    QVERIFY(!document.render(3, QSize(100, 141)).isNull());
+    QCOMPARE(document.getAllText(3).text(), QStringLiteral("Last page"));
+}
+
+void tst_QPdfRangeFetcher::closeWhileLoading()
+{
+    MemoryFetcher fetcher(createPdf(1));
+    QPdfDocument document;
+    document.load(&fetcher);
+    document.close();
+    QCOMPARE(document.status(), QPdfDocument::Null);
+
+    // Data that was on its way is ignored.
+    QTest::qWait(50);
+    QCOMPARE(document.status(), QPdfDocument::Null);
+    QCOMPARE(document.pageCount(), 0);
+}
+
+QTEST_MAIN(tst_QPdfRangeFetcher)
+#include "tst_qpdfrangefetcher.moc"
@@ -0,0 +1,178 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QLibraryInfo>
+#include <QPainter>
+#include <QPdfDocument>
+#include <QPdfWriter>
+#include <QtPdf/private/qpdfrenderprocesspool_p.h>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfRenderProcessPool: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void matchesInProcess_data();
+    void matchesInProcess();
+    void openFailureIsRemembered();
+
+private:
+    QTemporaryFile m_file;
+};
+
+static QString renderProcessPath()
+{
+    const QString fromEnv = qEnvironmentVariable("QTPDF_RENDERPROCESS_PATH");
+    if (!fromEnv.isEmpty())
+        return fromEnv;
+#if defined(Q_OS_WIN)
+    return QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + QLatin1String("/QtPdfRenderProcess.exe");
+#else
+    return QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + QLatin1String("/QtPdfRenderProcess");
+#endif
+}
+
+void tst_QPdfRenderProcessPool::initTestCase()
+{
+    if (!QFileInfo::exists(renderProcessPath()))
+        QSKIP("The render process is not available");
+
+    m_file.setFileTemplate(QDir::tempPath() + QLatin1String("/tst_qpdfrenderprocesspool-XXXXXX.pdf"));
+    QVERIFY(m_file.open());
+    {
+        QPdfWriter writer(&m_file);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        QPainter painter(&writer);
+        painter.fillRect(QRect(0, 0, writer.width() / 2, writer.height() / 3), Qt::red);
+        painter.setFont(QFont(QStringLiteral("Sans"), 24));
+        painter.drawText(QRect(0, writer.height() / 2, writer.width(), writer.height() / 4),
+                         Qt::AlignCenter, QStringLiteral("Rendered out of process"));
+        writer.newPage();
+        painter.drawEllipse(QRect(0, 0, writer.width(), writer.width()));
+    }
+    m_file.close();
+}
+
+void tst_QPdfRenderProcessPool::cleanup()
+{
+    QPdfRenderProcessPool::instance()->setProcessCount(0);
+}
+
+void tst_QPdfRenderProcessPool::matchesInProcess_data()
+{
+    QTest::addColumn<bool>("byFileName");
+    QTest::addColumn<int>("page");
+    QTest::addColumn<int>("rotation");
+
+    QTest::newRow("file") << true << 0 << int(QPdf::Rotate0);
+    QTest::newRow("file/second page") << true << 1 << int(QPdf::Rotate0);
+    QTest::newRow("data") << false << 0 << int(QPdf::Rotate0);
+    QTest::newRow("data/rotated") << false << 0 << int(QPdf::Rotate90);
+}
+
+void tst_QPdfRenderProcessPool::matchesInProcess()
+{
+    QFETCH(bool, byFileName);
+    QFETCH(int, page);
+    QFETCH(int, rotation);
+
+    QFile file(m_file.fileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray data = file.readAll();
+    file.close();
+
+    QPdfDocumentRenderOptions options;
+    options.setRotation(QPdf::Rotation(rotation));
+    const QSize imageSize(298, 421);
+
+    QPdfRenderProcessPool *pool = QPdfRenderProcessPool::instance();
+    pool->setProcessCount(1);
+    const quint64 documentId = byFileName ? pool->attachDocument(m_file.fileName(), QByteArray(), QByteArray())
+                                          : pool->attachDocument(QString(), data, QByteArray());
+    QVERIFY(documentId);
+    const QImage outOfProcess = pool->render(documentId, page, imageSize, options);
+    pool->detachDocument(documentId);
+    QVERIFY(!outOfProcess.isNull());
+
+    // Without processes in the pool, the document renders itself.
+    pool->setProcessCount(0);
+    QPdfDocument document;
+    QCOMPARE(document.load(m_file.fileName()), QPdfDocument::NoError);
+    const QImage inProcess = document.render(page, imageSize, options);
+    QVERIFY(!inProcess.isNull());
+
+    QCOMPARE(outOfProcess, inProcess);
+}
+
+static int openFailures = 0;
+static QtMessageHandler previousHandler = nullptr;
+
+static void countOpenFailures(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (message.contains(QLatin1String("could not open document")))
+        ++openFailures;
+    else
+        previousHandler(type, context, message);
+}
+
+void tst_QPdfRenderProcessPool::openFailureIsRemembered()
+{
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.pdf.renderprocess.debug=true"));
+    previousHandler = qInstallMessageHandler(countOpenFailures);
+    auto restore = qScopeGuard([] {
+        qInstallMessageHandler(previousHandler);
+        QLoggingCategory::setFilterRules(QString());
+    });
+
+    QPdfRenderProcessPool *pool = QPdfRenderProcessPool::instance();
+    pool->setProcessCount(1);
+    const quint64 documentId = pool->attachDocument(QString(), QByteArrayLiteral("not a PDF"), QByteArray());
+    QVERIFY(documentId);
+
+    // The document is sent to the process once; later renders fall back
+    // without asking it again.
+    QVERIFY(pool->render(documentId, 0, QSize(100, 100), QPdfDocumentRenderOptions()).isNull());
+    QVERIFY(pool->render(documentId, 0, QSize(100, 100), QPdfDocumentRenderOptions()).isNull());
+    pool->detachDocument(documentId);
+    QCOMPARE(openFailures, 1);
+}
+
+QTEST_MAIN(tst_QPdfRenderProcessPool)
+#include "tst_qpdfrenderprocesspool.moc"
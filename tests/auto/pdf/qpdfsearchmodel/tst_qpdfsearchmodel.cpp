@@ -39,6 +39,8 @@
 
 #include <QPdfDocument>
 #include <QPdfSearchModel>
+#include <QtPdf/private/qpdfsearchmodel_p.h>
+#include <QtPdf/private/qpdftextindex_p.h>
 
 class tst_QPdfSearchModel: public QObject
 {
@@ -49,8 +51,15 @@ public:
 
 private slots:
     void findText();
+    void indexedSearchMatchesPdfium_data();
+    void indexedSearchMatchesPdfium();
 };
 
+static QPdfSearchModelPrivate *searchModelPrivate(QPdfSearchModel *model)
+{
+    return static_cast<QPdfSearchModelPrivate *>(QObjectPrivate::get(model));
+}
+
 void tst_QPdfSearchModel::findText()
 {
     QPdfDocument document;
@@ -58,10 +67,62 @@ void tst_QPdfSearchModel::findText()
 
     QPdfSearchModel model;
     model.setDocument(&document);
-    QList<QRectF> matches = model.matches(1, "ai");
+    model.setSearchString(QLatin1String("ai"));
+    const QList<QPdfSearchResult> results = model.resultsOnPage(1);
+
+    qDebug() << results;
+    QCOMPARE(results.count(), 3);
+}
+
+void tst_QPdfSearchModel::indexedSearchMatchesPdfium_data()
+{
+    QTest::addColumn<QString>("searchString");
+    QTest::newRow("ai") << QStringLiteral("ai");
+    QTest::newRow("the") << QStringLiteral("the");
+    QTest::newRow("e") << QStringLiteral("e");
+}
+
+// Pages are searched in the text index once it has them, and through PDFium
+// before that, so the two must give the same results.
+void tst_QPdfSearchModel::indexedSearchMatchesPdfium()
+{
+    QFETCH(QString, searchString);
+    QPdfDocument document;
+    QCOMPARE(document.load(QFINDTESTDATA("test.pdf")), QPdfDocument::NoError);
+
+    QPdfSearchModel indexed;
+    indexed.setDocument(&document);
+    QPdfSearchModelPrivate *indexedPrivate = searchModelPrivate(&indexed);
+    QVERIFY(indexedPrivate->textIndex);
+    QTRY_VERIFY(indexedPrivate->textIndex->isFinished());
+    indexed.setSearchString(searchString);
+
+    // Without the index, every page goes through PDFium.
+    QPdfSearchModel unindexed;
+    unindexed.setDocument(&document);
+    unindexed.setSearchString(searchString);
+    searchModelPrivate(&unindexed)->textIndex.clear();
+
+    QTRY_VERIFY(indexedPrivate->updateTimerId < 0);
+    QTRY_VERIFY(searchModelPrivate(&unindexed)->updateTimerId < 0);
+    QVERIFY(indexed.rowCount(QModelIndex()) > 0);
+    QCOMPARE(indexed.rowCount(QModelIndex()), unindexed.rowCount(QModelIndex()));
 
-    qDebug() << matches;
-    QCOMPARE(matches.count(), 3);
+    const int roles[] = {
+        int(QPdfSearchModel::Role::Page),
+        int(QPdfSearchModel::Role::IndexOnPage),
+        int(QPdfSearchModel::Role::Location),
+        int(QPdfSearchModel::Role::ContextBefore),
+        int(QPdfSearchModel::Role::ContextAfter),
+        int(Qt::DisplayRole)
+    };
+    for (int row = 0; row < indexed.rowCount(QModelIndex()); ++row) {
+        for (int role : roles) {
+            QCOMPARE(indexed.data(indexed.index(row), role),
+                     unindexed.data(unindexed.index(row), role));
+        }
+        QCOMPARE(indexed.resultAtIndex(row).rectangles(), unindexed.resultAtIndex(row).rectangles());
+    }
 }
 
 QTEST_MAIN(tst_QPdfSearchModel)
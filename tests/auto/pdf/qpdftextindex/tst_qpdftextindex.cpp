@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtPdf/private/qpdftextindex_p.h>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfTextIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void find_data();
+    void find();
+    void refine();
+    void rectsForRange();
+};
+
+void tst_QPdfTextIndex::find_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("needle");
+    QTest::addColumn<QList<int>>("positions");
+
+    QTest::newRow("none") << QStringLiteral("Lorem ipsum") << QStringLiteral("dolor") << QList<int>();
+    QTest::newRow("case-insensitive") << QStringLiteral("Ipsum ipsum IPSUM") << QStringLiteral("ipsum")
+                                      << QList<int>{0, 6, 12};
+    QTest::newRow("overlapping") << QStringLiteral("aaaa") << QStringLiteral("aa") << QList<int>{0, 1, 2};
+    QTest::newRow("empty needle") << QStringLiteral("abc") << QString() << QList<int>();
+}
+
+void tst_QPdfTextIndex::find()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, needle);
+    QFETCH(QList<int>, positions);
+
+    QCOMPARE(QPdfTextIndex::find(text, needle), positions);
+}
+
+void tst_QPdfTextIndex::refine()
+{
+    const QString text = QStringLiteral("the theory of the thermos");
+    const QList<int> the = QPdfTextIndex::find(text, QStringLiteral("the"));
+    QCOMPARE(the, QList<int>({0, 4, 14, 18}));
+
+    // Typing ahead gives the same matches as searching from scratch.
+    for (const QString &longer : {QStringLiteral("ther"), QStringLiteral("THEO"), QStringLiteral("the ")})
+        QCOMPARE(QPdfTextIndex::refine(text, the, longer), QPdfTextIndex::find(text, longer));
+}
+
+void tst_QPdfTextIndex::rectsForRange()
+{
+    // "ab\ncd": two characters on each of two lines, with a generated line break.
+    QPdfTextIndex::PageText pageText;
+    pageText.text = QStringLiteral("ab\ncd");
+    pageText.charBoxes = { QRectF(10, 10, 5, 10), QRectF(15, 10, 5, 10), QRectF(),
+                           QRectF(10, 30, 5, 10), QRectF(15, 30, 5, 10) };
+
+    QCOMPARE(QPdfTextIndex::rectsForRange(pageText, 0, 2), QList<QRectF>{QRectF(10, 10, 10, 10)});
+    QCOMPARE(QPdfTextIndex::rectsForRange(pageText, 1, 3),
+             QList<QRectF>({QRectF(15, 10, 5, 10), QRectF(10, 30, 5, 10)}));
+    QCOMPARE(QPdfTextIndex::rectsForRange(pageText, 3, 10), QList<QRectF>{QRectF(10, 30, 10, 10)});
+    QVERIFY(QPdfTextIndex::rectsForRange(pageText, 2, 1).isEmpty());
+}
+
+QTEST_MAIN(tst_QPdfTextIndex)
+#include "tst_qpdftextindex.moc"
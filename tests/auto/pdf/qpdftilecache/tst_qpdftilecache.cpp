@@ -0,0 +1,243 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QPainter>
+#include <QPdfDocument>
+#include <QPdfWriter>
+#include <QtPdf/private/qpdftilecache_p.h>
+#include <QtPdf/private/qpdftilerenderer_p.h>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfTileCache: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void levelForScale_data();
+    void levelForScale();
+    void previewLevel();
+    void tileGeometry();
+    void evictsByBytes();
+    void removeDocument();
+    void rendersTiles();
+    void cancelsPerRequester();
+};
+
+void tst_QPdfTileCache::levelForScale_data()
+{
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<int>("level");
+
+    QTest::newRow("1") << qreal(1) << 0;
+    QTest::newRow("1.5") << qreal(1.5) << 1;
+    QTest::newRow("2") << qreal(2) << 1;
+    QTest::newRow("2.5") << qreal(2.5) << 2;
+    QTest::newRow("0.5") << qreal(0.5) << -1;
+    QTest::newRow("0.3") << qreal(0.3) << -1;
+    QTest::newRow("huge") << qreal(100000) << int(QPdfTileCache::MaximumLevel);
+    QTest::newRow("zero") << qreal(0) << int(QPdfTileCache::MinimumLevel);
+}
+
+void tst_QPdfTileCache::levelForScale()
+{
+    QFETCH(qreal, scale);
+    QFETCH(int, level);
+
+    QCOMPARE(QPdfTileCache::levelForScale(scale), level);
+    QVERIFY(QPdfTileCache::scaleForLevel(level) >= qMin(scale, QPdfTileCache::scaleForLevel(QPdfTileCache::MaximumLevel)));
+}
+
+void tst_QPdfTileCache::previewLevel()
+{
+    // A4 in points: the whole page must fit into one tile.
+    const QSizeF a4(595, 842);
+    const int level = QPdfTileCache::previewLevel(a4);
+    const QSize size = QPdfTileCache::pageSizeAtLevel(a4, level);
+    QVERIFY(size.width() <= QPdfTileCache::TileSize);
+    QVERIFY(size.height() <= QPdfTileCache::TileSize);
+    QVERIFY(QPdfTileCache::pageSizeAtLevel(a4, level + 1).height() > QPdfTileCache::TileSize);
+}
+
+void tst_QPdfTileCache::tileGeometry()
+{
+    const QSize levelSize(600, 300);
+
+    QCOMPARE(QPdfTileCache::tileRect(levelSize, QPoint(0, 0)), QRect(0, 0, 256, 256));
+    QCOMPARE(QPdfTileCache::tileRect(levelSize, QPoint(2, 1)), QRect(512, 256, 88, 44));
+    QVERIFY(QPdfTileCache::tileRect(levelSize, QPoint(3, 0)).isEmpty());
+
+    QCOMPARE(QPdfTileCache::tilesIntersecting(levelSize, QRectF(0, 0, 600, 300)), QRect(0, 0, 3, 2));
+    QCOMPARE(QPdfTileCache::tilesIntersecting(levelSize, QRectF(300, 10, 10, 10)), QRect(1, 0, 1, 1));
+    QCOMPARE(QPdfTileCache::tilesIntersecting(levelSize, QRectF(-100, -100, 1000, 1000)), QRect(0, 0, 3, 2));
+    QVERIFY(QPdfTileCache::tilesIntersecting(levelSize, QRectF(700, 0, 10, 10)).isEmpty());
+
+    const QPdfDocumentRenderOptions options = QPdfTileCache::renderOptions(levelSize, QPoint(2, 1));
+    QCOMPARE(options.scaledSize(), levelSize);
+    QCOMPARE(options.scaledClipRect(), QRect(512, 256, 88, 44));
+    QCOMPARE(options.renderFlags(), QPdf::RenderFlags(QPdf::RenderOpaque));
+}
+
+void tst_QPdfTileCache::evictsByBytes()
+{
+    QImage tile(QPdfTileCache::TileSize, QPdfTileCache::TileSize, QImage::Format_ARGB32);
+    tile.fill(Qt::white);
+
+    QPdfTileCache cache(tile.sizeInBytes() * 2);
+    cache.insert({1, 0, 0, QPoint(0, 0)}, tile);
+    cache.insert({1, 0, 0, QPoint(1, 0)}, tile);
+    QCOMPARE(cache.bytes(), tile.sizeInBytes() * 2);
+
+    // Touch the first tile, so that the second one is the least recently used.
+    QVERIFY(!cache.find({1, 0, 0, QPoint(0, 0)}).isNull());
+    cache.insert({1, 0, 0, QPoint(2, 0)}, tile);
+    QVERIFY(cache.contains({1, 0, 0, QPoint(0, 0)}));
+    QVERIFY(!cache.contains({1, 0, 0, QPoint(1, 0)}));
+    QVERIFY(cache.contains({1, 0, 0, QPoint(2, 0)}));
+    QCOMPARE(cache.bytes(), tile.sizeInBytes() * 2);
+
+    cache.setMaxBytes(tile.sizeInBytes());
+    QVERIFY(cache.bytes() <= tile.sizeInBytes());
+
+    // A tile larger than the whole cache is not kept.
+    cache.setMaxBytes(tile.sizeInBytes() - 1);
+    QVERIFY(!cache.insert({1, 0, 0, QPoint(3, 0)}, tile));
+    QVERIFY(!cache.contains({1, 0, 0, QPoint(3, 0)}));
+}
+
+void tst_QPdfTileCache::removeDocument()
+{
+    QImage tile(16, 16, QImage::Format_ARGB32);
+    tile.fill(Qt::white);
+
+    QPdfTileCache cache;
+    cache.insert({1, 0, 0, QPoint(0, 0)}, tile);
+    cache.insert({2, 0, 0, QPoint(0, 0)}, tile);
+    cache.removeDocument(1);
+    QVERIFY(!cache.contains({1, 0, 0, QPoint(0, 0)}));
+    QVERIFY(cache.contains({2, 0, 0, QPoint(0, 0)}));
+}
+
+void tst_QPdfTileCache::rendersTiles()
+{
+    QTemporaryFile file(QDir::tempPath() + QLatin1String("/tst_qpdftilecache-XXXXXX.pdf"));
+    QVERIFY(file.open());
+    {
+        QPdfWriter writer(&file);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        QPainter painter(&writer);
+        painter.fillRect(QRect(0, 0, writer.width() / 2, writer.height() / 2), Qt::red);
+    }
+    file.close();
+
+    QPdfDocument document;
+    QCOMPARE(document.load(file.fileName()), QPdfDocument::NoError);
+
+    QPdfTileCache cache;
+    QPdfTileRenderer renderer;
+    renderer.setCache(&cache);
+    renderer.setDocument(&document);
+    QSignalSpy tileRenderedSpy(&renderer, &QPdfTileRenderer::tileRendered);
+
+    // Level 1 of an A4 page is five tiles wide: tile (4, 0) is blank and
+    // tile (0, 0) is covered by the red rectangle.
+    QVERIFY(renderer.tile(0, 1, QPoint(0, 0)).isNull());
+    QVERIFY(renderer.tile(0, 1, QPoint(4, 0)).isNull());
+    // A second request for a pending tile must not render it again.
+    QVERIFY(renderer.tile(0, 1, QPoint(0, 0)).isNull());
+    QTRY_COMPARE(tileRenderedSpy.count(), 2);
+    QTest::qWait(50);
+    QCOMPARE(tileRenderedSpy.count(), 2);
+
+    QVERIFY(renderer.hasTile(0, 1, QPoint(0, 0)));
+    const QImage red = renderer.tile(0, 1, QPoint(0, 0), false);
+    QCOMPARE(red.size(), QSize(QPdfTileCache::TileSize, QPdfTileCache::TileSize));
+    QCOMPARE(QColor(red.pixel(200, 200)), QColor(Qt::red));
+    const QImage blank = renderer.tile(0, 1, QPoint(4, 0), false);
+    QCOMPARE(blank.size(), QPdfTileCache::tileRect(QPdfTileCache::pageSizeAtLevel(document.pageSize(0), 1), QPoint(4, 0)).size());
+    QVERIFY(QColor(blank.pixel(10, 10)) != QColor(Qt::red));
+
+    document.close();
+    QVERIFY(!renderer.hasTile(0, 1, QPoint(0, 0)));
+}
+
+void tst_QPdfTileCache::cancelsPerRequester()
+{
+    QTemporaryFile file(QDir::tempPath() + QLatin1String("/tst_qpdftilecache-XXXXXX.pdf"));
+    QVERIFY(file.open());
+    {
+        QPdfWriter writer(&file);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        QPainter painter(&writer);
+        painter.fillRect(QRect(0, 0, writer.width() / 2, writer.height() / 2), Qt::red);
+    }
+    file.close();
+
+    QPdfDocument document;
+    QCOMPARE(document.load(file.fileName()), QPdfDocument::NoError);
+    QPdfTileCache cache;
+    QPdfTileRenderer renderer;
+    renderer.setCache(&cache);
+    renderer.setDocument(&document);
+    QSignalSpy tileRenderedSpy(&renderer, &QPdfTileRenderer::tileRendered);
+
+    // The first tile goes to the worker at once; the others are queued.
+    QObject first, second;
+    renderer.tile(0, 1, QPoint(0, 0), true, QPdfTileRenderer::TilePriority, &first);
+    renderer.tile(0, 1, QPoint(1, 0), true, QPdfTileRenderer::TilePriority, &first);
+    renderer.tile(0, 1, QPoint(2, 0), true, QPdfTileRenderer::TilePriority, &first);
+    renderer.tile(0, 1, QPoint(2, 0), true, QPdfTileRenderer::TilePriority, &second);
+
+    // Only the tile that no one else asked for is dropped.
+    renderer.cancelRequests(0, &first);
+    QTRY_COMPARE(tileRenderedSpy.count(), 2);
+    QTest::qWait(50);
+    QCOMPARE(tileRenderedSpy.count(), 2);
+    QVERIFY(renderer.hasTile(0, 1, QPoint(0, 0)));
+    QVERIFY(!renderer.hasTile(0, 1, QPoint(1, 0)));
+    QVERIFY(renderer.hasTile(0, 1, QPoint(2, 0)));
+
+    // Cancelling for pages that are still in view leaves their tiles queued.
+    renderer.tile(0, 1, QPoint(3, 0), true, QPdfTileRenderer::TilePriority, &second);
+    renderer.tile(0, 1, QPoint(4, 0), true, QPdfTileRenderer::TilePriority, &second);
+    renderer.cancelRequestsExcept({ 0 }, &second);
+    renderer.cancelRequests(0, &first);
+    QTRY_COMPARE(tileRenderedSpy.count(), 4);
+}
+
+QTEST_MAIN(tst_QPdfTileCache)
+
+#include "tst_qpdftilecache.moc"
@@ -0,0 +1,211 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QPainter>
+#include <QPdfWriter>
+#include <QtPdfQuick/private/qquickpdfdocument_p.h>
+#include <QtPdfQuick/private/qquickpdfpageimageprovider_p.h>
+#include <QtQuick/qquickimageprovider.h>
+
+#include <QtTest/QtTest>
+
+#include <memory>
+#include <vector>
+
+class tst_QQuickPdfPageImageProvider: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void pageImageSource();
+    void rendersPage();
+    void errors_data();
+    void errors();
+    void destroyPendingResponses();
+
+private:
+    QTemporaryFile m_file;
+};
+
+static QString imageId(const QUrl &source)
+{
+    const QString prefix = QLatin1String("image://") + QQuickPdfPageImageProvider::providerId() + QLatin1Char('/');
+    return source.toString().mid(prefix.size());
+}
+
+static QImage waitForImage(QQuickImageResponse *response, QString *error = nullptr)
+{
+    QSignalSpy finishedSpy(response, &QQuickImageResponse::finished);
+    if (!finishedSpy.wait())
+        return QImage();
+    if (error)
+        *error = response->errorString();
+    QScopedPointer<QQuickTextureFactory> factory(response->textureFactory());
+    return factory ? factory->image() : QImage();
+}
+
+void tst_QQuickPdfPageImageProvider::initTestCase()
+{
+    m_file.setFileTemplate(QDir::tempPath() + QLatin1String("/tst_qquickpdfpageimageprovider-XXXXXX.pdf"));
+    QVERIFY(m_file.open());
+    {
+        QPdfWriter writer(&m_file);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        QPainter painter(&writer);
+        painter.fillRect(QRect(0, 0, writer.width() / 2, writer.height() / 2), Qt::red);
+        writer.newPage();
+        painter.fillRect(QRect(writer.width() / 2, 0, writer.width() / 2, writer.height() / 2), Qt::blue);
+    }
+    m_file.close();
+}
+
+void tst_QQuickPdfPageImageProvider::pageImageSource()
+{
+    QQuickPdfDocument document;
+    QVERIFY(document.pageImageSource(0).isEmpty());
+
+    document.setSource(QUrl::fromLocalFile(m_file.fileName()));
+    QCOMPARE(document.status(), QPdfDocument::Ready);
+    const QUrl source = document.pageImageSource(1);
+    QCOMPARE(source.scheme(), QStringLiteral("image"));
+    QCOMPARE(source.host(), QString(QQuickPdfPageImageProvider::providerId()));
+    QVERIFY(imageId(source).endsWith(QLatin1String("/1")));
+
+    // A new load of the document must not hit the images of the previous one.
+    document.setSource(QUrl());
+    QVERIFY(document.pageImageSource(1).isEmpty());
+    document.setSource(QUrl::fromLocalFile(m_file.fileName()));
+    QCOMPARE(document.status(), QPdfDocument::Ready);
+    QVERIFY(!document.pageImageSource(1).isEmpty());
+    QVERIFY(document.pageImageSource(1) != source);
+}
+
+void tst_QQuickPdfPageImageProvider::rendersPage()
+{
+    QQuickPdfDocument document;
+    document.setSource(QUrl::fromLocalFile(m_file.fileName()));
+    QCOMPARE(document.status(), QPdfDocument::Ready);
+
+    QQuickPdfPageImageProvider provider;
+    for (int page = 0; page < 2; ++page) {
+        QScopedPointer<QQuickImageResponse> response(
+                provider.requestImageResponse(imageId(document.pageImageSource(page)), QSize(200, 0)));
+        QString error;
+        const QImage image = waitForImage(response.data(), &error);
+        QVERIFY2(!image.isNull(), qPrintable(error));
+
+        // The width is given, and the height follows from the page size.
+        const QSizeF pointSize = document.pagePointSize(page);
+        const QSize expectedSize = QSizeF(200, pointSize.height() * 200 / pointSize.width()).toSize();
+        QCOMPARE(image.size(), expectedSize);
+
+        QPdfDocumentRenderOptions options;
+        options.setRenderFlags(QPdf::RenderOpaque);
+        const QImage expected = document.document().render(page, expectedSize, options);
+        QCOMPARE(image.convertToFormat(expected.format()), expected);
+    }
+}
+
+void tst_QQuickPdfPageImageProvider::errors_data()
+{
+    QTest::addColumn<bool>("knownDocument");
+    QTest::addColumn<int>("page");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("unknown document") << false << 0 << QStringLiteral("document is not loaded");
+    QTest::newRow("page out of range") << true << 5 << QStringLiteral("page 5 out of range");
+}
+
+void tst_QQuickPdfPageImageProvider::errors()
+{
+    QFETCH(bool, knownDocument);
+    QFETCH(int, page);
+    QFETCH(QString, error);
+
+    QQuickPdfDocument document;
+    document.setSource(QUrl::fromLocalFile(m_file.fileName()));
+    QCOMPARE(document.status(), QPdfDocument::Ready);
+    QString id = imageId(document.pageImageSource(page));
+    if (!knownDocument)
+        id = QStringLiteral("0/%1").arg(page);
+
+    QQuickPdfPageImageProvider provider;
+    QScopedPointer<QQuickImageResponse> response(provider.requestImageResponse(id, QSize(100, 100)));
+    QString actualError;
+    QVERIFY(waitForImage(response.data(), &actualError).isNull());
+    QCOMPARE(actualError, error);
+}
+
+void tst_QQuickPdfPageImageProvider::destroyPendingResponses()
+{
+    QQuickPdfDocument document;
+    document.setSource(QUrl::fromLocalFile(m_file.fileName()));
+    QCOMPARE(document.status(), QPdfDocument::Ready);
+
+    // Responses that go away before, while or after their page is rendered
+    // must neither crash nor deliver to the deleted response.
+    {
+        QQuickPdfPageImageProvider provider;
+        for (int i = 0; i < 50; ++i)
+            delete provider.requestImageResponse(imageId(document.pageImageSource(i % 2)), QSize(400, 0));
+        // A cancelled response finishes at once, unless its page is being
+        // rendered already; then it finishes with the image.
+        std::vector<std::unique_ptr<QQuickImageResponse>> cancelled;
+        std::vector<std::unique_ptr<QSignalSpy>> finishedSpies;
+        for (int i = 0; i < 50; ++i) {
+            cancelled.emplace_back(provider.requestImageResponse(imageId(document.pageImageSource(i % 2)),
+                                                                 QSize(400, 0)));
+            finishedSpies.emplace_back(new QSignalSpy(cancelled.back().get(), &QQuickImageResponse::finished));
+            cancelled.back()->cancel();
+        }
+        for (size_t i = 0; i < cancelled.size(); ++i) {
+            QTRY_COMPARE(finishedSpies[i]->count(), 1);
+            const QString error = cancelled[i]->errorString();
+            QVERIFY2(error.isEmpty() || error == QLatin1String("cancelled"), qPrintable(error));
+        }
+    }
+    QCoreApplication::processEvents();
+
+    // The document is still usable after all that.
+    QQuickPdfPageImageProvider provider;
+    QScopedPointer<QQuickImageResponse> response(
+            provider.requestImageResponse(imageId(document.pageImageSource(0)), QSize(100, 0)));
+    QVERIFY(!waitForImage(response.data()).isNull());
+}
+
+QTEST_MAIN(tst_QQuickPdfPageImageProvider)
+#include "tst_qquickpdfpageimageprovider.moc"
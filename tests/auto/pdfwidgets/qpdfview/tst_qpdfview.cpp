@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtPDF module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QPainter>
+#include <QPdfDocument>
+#include <QPdfView>
+#include <QPdfWriter>
+#include <QtPdf/private/qpdftilecache_p.h>
+#include <QtPdfWidgets/private/qpdfview_p.h>
+
+#include <QtTest/QtTest>
+
+class tst_QPdfView: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void pageCacheLimit();
+    void placeholderWhileRendering();
+
+private:
+    QTemporaryFile m_file;
+};
+
+// The top left quarter of the page is red, the rest white.
+static const QPointF redPoint(0.1, 0.1);
+static const QPointF edgePoint(0.5, 0.1);
+
+// offset is in view pixels, to get to either side of an edge.
+static QColor colorAt(QPdfView *view, QPointF relativePosition, QPoint offset = QPoint())
+{
+    const QPdfViewPrivate *d = QPdfViewPrivate::get(view);
+    const QRect page = d->m_documentLayout.pageGeometries.value(0).translated(-d->m_viewport.topLeft());
+    const QImage image = view->viewport()->grab().toImage();
+    const QPoint position(page.left() + qRound(page.width() * relativePosition.x()),
+                          page.top() + qRound(page.height() * relativePosition.y()));
+    return image.pixelColor((position + offset) * image.devicePixelRatio());
+}
+
+static int levelInView(QPdfView *view, const QSizeF &pointSize)
+{
+    const QPdfViewPrivate *d = QPdfViewPrivate::get(view);
+    return QPdfTileCache::levelForScale(d->m_documentLayout.pageGeometries.value(0).width()
+                                        * view->devicePixelRatioF() / pointSize.width());
+}
+
+void tst_QPdfView::initTestCase()
+{
+    m_file.setFileTemplate(QDir::tempPath() + QLatin1String("/tst_qpdfview-XXXXXX.pdf"));
+    QVERIFY(m_file.open());
+    {
+        QPdfWriter writer(&m_file);
+        writer.setPageSize(QPageSize(QPageSize::A4));
+        writer.setPageMargins(QMarginsF());
+        QPainter painter(&writer);
+        painter.fillRect(QRect(0, 0, writer.width() / 2, writer.height() / 2), Qt::red);
+    }
+    m_file.close();
+}
+
+void tst_QPdfView::pageCacheLimit()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(m_file.fileName()), QPdfDocument::NoError);
+    QPdfView view;
+    view.resize(600, 800);
+    view.setDocument(&document);
+    view.setZoomFactor(2);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    const QPdfTileCache &cache = QPdfViewPrivate::get(&view)->m_tileCache;
+    QTRY_COMPARE(colorAt(&view, redPoint), QColor(Qt::red));
+    const qint64 bytes = cache.bytes();
+    QVERIFY(bytes > 0);
+    QVERIFY(bytes <= view.pageCacheLimit());
+
+    QSignalSpy limitSpy(&view, &QPdfView::pageCacheLimitChanged);
+    view.setPageCacheLimit(bytes / 2);
+    QCOMPARE(view.pageCacheLimit(), bytes / 2);
+    QCOMPARE(limitSpy.count(), 1);
+    QCOMPARE(limitSpy.first().first().toLongLong(), bytes / 2);
+    // The tiles over the new limit are dropped at once.
+    QVERIFY(cache.bytes() <= bytes / 2);
+
+    view.setPageCacheLimit(bytes / 2);
+    QCOMPARE(limitSpy.count(), 1);
+
+    QTest::ignoreMessage(QtWarningMsg, "QPdfView::setPageCacheLimit: Negative limit -1, using 0");
+    view.setPageCacheLimit(-1);
+    QCOMPARE(view.pageCacheLimit(), qint64(0));
+    QCOMPARE(limitSpy.count(), 2);
+    QCOMPARE(limitSpy.last().first().toLongLong(), qint64(0));
+    QCOMPARE(cache.bytes(), qint64(0));
+}
+
+void tst_QPdfView::placeholderWhileRendering()
+{
+    QPdfDocument document;
+    QCOMPARE(document.load(m_file.fileName()), QPdfDocument::NoError);
+    QPdfView view;
+    view.resize(600, 800);
+    view.setDocument(&document);
+    view.setZoomFactor(0.5);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+
+    QPdfViewPrivate *d = QPdfViewPrivate::get(&view);
+    const QSizeF pointSize = document.pageSize(0);
+    const int oldLevel = levelInView(&view, pointSize);
+    const QSize oldLevelSize = QPdfTileCache::pageSizeAtLevel(pointSize, oldLevel);
+    const QRect oldTiles = QPdfTileCache::tilesIntersecting(oldLevelSize, QRectF(QPointF(), oldLevelSize));
+    const auto hasOldTiles = [&] {
+        for (int y = oldTiles.top(); y <= oldTiles.bottom(); ++y) {
+            for (int x = oldTiles.left(); x <= oldTiles.right(); ++x) {
+                if (!d->m_tileRenderer->hasTile(0, oldLevel, QPoint(x, y)))
+                    return false;
+            }
+        }
+        return true;
+    };
+    QTRY_VERIFY(hasOldTiles());
+
+    // The coarse preview of the whole page is drawn first. Make it blue, so
+    // that what shows of the page is what was drawn over it from the tiles
+    // of the previous level.
+    const int preview = QPdfTileCache::previewLevel(pointSize);
+    QVERIFY(oldLevel > preview);
+    QImage bluePreview(QPdfTileCache::pageSizeAtLevel(pointSize, preview), QImage::Format_ARGB32_Premultiplied);
+    bluePreview.fill(Qt::blue);
+    QVERIFY(d->m_tileCache.insert({d->m_tileRenderer->documentKey(), 0, preview, QPoint(0, 0)}, bluePreview));
+
+    // Painting right after zooming in requests the tiles of the sharper
+    // level, which can't have been rendered yet: they are only put into the
+    // cache from the event loop. The page is drawn from the tiles of the
+    // previous level meanwhile, sharp enough to tell the sides of the edge
+    // between red and white apart.
+    view.setZoomFactor(1);
+    const int level = levelInView(&view, pointSize);
+    QVERIFY(level > oldLevel);
+    QVERIFY(level - 3 <= oldLevel);
+    QCOMPARE(colorAt(&view, redPoint), QColor(Qt::red));
+    QCOMPARE(colorAt(&view, edgePoint, QPoint(-6, 0)), QColor(Qt::red));
+    QCOMPARE(colorAt(&view, edgePoint, QPoint(6, 0)), QColor(Qt::white));
+
+    // The sharp tiles replace the placeholder once they are there.
+    QTRY_VERIFY(d->m_tileRenderer->hasTile(0, level, QPoint(0, 0)));
+    QCOMPARE(colorAt(&view, redPoint), QColor(Qt::red));
+}
+
+QTEST_MAIN(tst_QPdfView)
+#include "tst_qpdfview.moc"
@@ -396,6 +396,8 @@ static const QStringList expectedAPI = QStringList()
     << "QQuickWebEngineSettings.autoLoadIconsForPageChanged() --> void"
     << "QQuickWebEngineSettings.autoLoadImages --> bool"
     << "QQuickWebEngineSettings.autoLoadImagesChanged() --> void"
+    << "QQuickWebEngineSettings.binaryWebChannelTransportEnabled --> bool"
+    << "QQuickWebEngineSettings.binaryWebChannelTransportEnabledChanged() --> void"
     << "QQuickWebEngineSettings.defaultTextEncoding --> QString"
     << "QQuickWebEngineSettings.defaultTextEncodingChanged() --> void"
     << "QQuickWebEngineSettings.dnsPrefetchEnabled --> bool"
@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the QtWebEngine module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <util.h>
+
+#include <QImage>
+#include <QTest>
+#include <QSignalSpy>
+#include <QWebEnginePage>
+#include <QWebEngineView>
+
+class tst_Headless : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void produceFrame();
+};
+
+static QImage produceFrameSync(QWebEnginePage *page)
+{
+    CallbackSpy<QImage> spy;
+    page->produceFrame(spy.ref());
+    return spy.waitForResult();
+}
+
+static QColor frameColor(QWebEnginePage *page)
+{
+    const QImage frame = produceFrameSync(page);
+    return frame.isNull() ? QColor() : frame.pixelColor(frame.width() / 2, frame.height() / 2);
+}
+
+void tst_Headless::produceFrame()
+{
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(view.page(), &QWebEnginePage::loadFinished);
+    view.resize(300, 200);
+    view.setHtml("<html><body style='background-color: #00ff00'></body></html>");
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    QTRY_COMPARE_WITH_TIMEOUT(loadFinishedSpy.count(), 1, 20000);
+    QVERIFY(loadFinishedSpy.takeFirst().at(0).toBool());
+
+    // The first frames may still be drawn before the page has been committed.
+    QTRY_COMPARE(frameColor(view.page()), QColor(Qt::green));
+
+    const QImage frame = produceFrameSync(view.page());
+    QCOMPARE(frame.size(), view.size() * view.devicePixelRatio());
+    QVERIFY(frame.format() == QImage::Format_ARGB32_Premultiplied
+            || frame.format() == QImage::Format_RGBA8888_Premultiplied);
+    QVERIFY(frame.bytesPerLine() >= frame.width() * 4);
+
+    // A change only shows up in frames produced after it.
+    CallbackSpy<QVariant> spy;
+    view.page()->runJavaScript("document.body.style.backgroundColor = '#0000ff'", spy.ref());
+    spy.waitForResult();
+    QTRY_COMPARE(frameColor(view.page()), QColor(Qt::blue));
+}
+
+QTEST_MAIN(tst_Headless)
+#include "tst_headless.moc"
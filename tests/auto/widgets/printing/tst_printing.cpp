@@ -28,11 +28,18 @@
 
 #include <QtWebEngineCore/private/qtwebenginecoreglobal_p.h>
 #include <QWebEngineView>
+#include <QBuffer>
+#include <QPrinter>
 #include <QTemporaryDir>
+#include <QTimer>
 #include <QTest>
 #include <QSignalSpy>
 #include <util.h>
 
+#if defined(QTPDF)
+#include <QPdfDocument>
+#endif
+
 #if defined(POPPLER_CPP)
 #include <poppler-document.h>
 #include <poppler-page.h>
@@ -44,6 +51,10 @@ class tst_Printing : public QObject
 private slots:
     void printToPdfBasic();
     void printRequest();
+    void printToPdfPrinter_data();
+    void printToPdfPrinter();
+    void printToPdfDevice();
+    void printToPdfSequentialDevice();
 #if defined(POPPLER_CPP) && defined(Q_OS_LINUX) && defined(__GLIBCXX__)
     void printToPdfPoppler();
 #endif
@@ -110,6 +121,182 @@ void tst_Printing::printRequest()
      QVERIFY(data.length() > 0);
 }
 
+void tst_Printing::printToPdfPrinter_data()
+{
+    QTest::addColumn<int>("copies");
+    QTest::addColumn<bool>("collate");
+    QTest::addColumn<QString>("docName");
+    // The color at the top of each printed page; the document has a red and a blue page.
+    QTest::addColumn<QList<QRgb>>("pageColors");
+    const QRgb red = qRgb(255, 0, 0);
+    const QRgb blue = qRgb(0, 0, 255);
+    QTest::newRow("document as is") << 1 << false << QString() << QList<QRgb>({ red, blue });
+    QTest::newRow("document with title") << 1 << false << QStringLiteral("Printed Document")
+                                         << QList<QRgb>({ red, blue });
+    QTest::newRow("collated copies") << 2 << true << QString() << QList<QRgb>({ red, red, blue, blue });
+    QTest::newRow("copies") << 2 << false << QString() << QList<QRgb>({ red, blue, red, blue });
+}
+
+#if defined(QTPDF)
+static bool similarColors(QRgb a, QRgb b)
+{
+    return qAbs(qRed(a) - qRed(b)) < 64 && qAbs(qGreen(a) - qGreen(b)) < 64
+            && qAbs(qBlue(a) - qBlue(b)) < 64;
+}
+#endif
+
+void tst_Printing::printToPdfPrinter()
+{
+    QFETCH(int, copies);
+    QFETCH(bool, collate);
+    QFETCH(QString, docName);
+    QFETCH(QList<QRgb>, pageColors);
+
+    QTemporaryDir tempDir(QDir::tempPath() + "/tst_printing-XXXXXX");
+    QVERIFY(tempDir.isValid());
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(&view, &QWebEngineView::loadFinished);
+    view.load(QUrl("qrc:///resources/colored_pages.html"));
+    QTRY_VERIFY(loadFinishedSpy.count() == 1);
+
+    QPrinter printer;
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setOutputFileName(tempDir.path() + "/printed.pdf");
+    printer.setResolution(150);
+    printer.setCopyCount(copies);
+    printer.setCollateCopies(collate);
+    printer.setDocName(docName);
+
+    QSignalSpy printFinishedSpy(&view, &QWebEngineView::printFinished);
+    view.print(&printer);
+    QTRY_COMPARE(printFinishedSpy.count(), 1);
+    QVERIFY(printFinishedSpy.first().at(0).toBool());
+
+    QFile file(printer.outputFileName());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.read(5) == "%PDF-");
+
+#if defined(QTPDF)
+    QPdfDocument pdf;
+    QCOMPARE(pdf.load(printer.outputFileName()), QPdfDocument::NoError);
+    QCOMPARE(pdf.pageCount(), int(pageColors.size()));
+    for (int page = 0; page < pageColors.size(); ++page) {
+        // The top of the colored block, below the page margin.
+        const QImage image = pdf.render(page, QSize(100, 141));
+        QVERIFY(!image.isNull());
+        const QRgb color = image.pixel(50, 14);
+        QVERIFY2(similarColors(color, pageColors.at(page)),
+                 qPrintable(QStringLiteral("page %1 is %2").arg(page).arg(color, 8, 16, QLatin1Char('0'))));
+    }
+    // The printer's title means the document was painted rather than written as it is.
+    if (!docName.isEmpty())
+        QCOMPARE(pdf.metaData(QPdfDocument::Title).toString(), docName);
+#endif
+}
+
+void tst_Printing::printToPdfDevice()
+{
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(&view, &QWebEngineView::loadFinished);
+    view.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(loadFinishedSpy.count() == 1);
+
+    QPageLayout layout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(0.0, 0.0, 0.0, 0.0));
+    CallbackSpy<QByteArray> dataSpy;
+    view.page()->printToPdf(dataSpy.ref(), layout);
+    const QByteArray data = dataSpy.waitForResult();
+    QVERIFY(data.startsWith("%PDF-"));
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    CallbackSpy<bool> resultSpy;
+    view.page()->printToPdf(&buffer, resultSpy.ref(), layout);
+    QVERIFY(resultSpy.waitForResult());
+    QVERIFY(buffer.data().startsWith("%PDF-"));
+    QVERIFY(buffer.size() > 0);
+
+    QBuffer readOnly;
+    QVERIFY(readOnly.open(QIODevice::ReadOnly));
+    CallbackSpy<bool> failedSpy;
+    QTest::ignoreMessage(QtWarningMsg, "Cannot print to PDF: the device is not open for writing.");
+    view.page()->printToPdf(&readOnly, failedSpy.ref(), layout);
+    QVERIFY(!failedSpy.waitForResult());
+
+    CallbackSpy<bool> invalidLayoutSpy;
+    view.page()->printToPdf(&buffer, invalidLayoutSpy.ref(), QPageLayout());
+    QVERIFY(!invalidLayoutSpy.waitForResult());
+}
+
+// Takes at most Capacity bytes until it has written them out, which it
+// does from the event loop, like a socket or a pipe.
+class ThrottledDevice : public QBuffer
+{
+public:
+    static constexpr qint64 Capacity = 1024;
+
+    bool isSequential() const override { return true; }
+    qint64 bytesToWrite() const override { return m_pending; }
+
+    int m_flushes = 0;
+
+protected:
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        const qint64 accepted = qMin(len, Capacity - m_pending);
+        if (accepted <= 0)
+            return 0;
+        if (!m_pending)
+            QTimer::singleShot(0, this, &ThrottledDevice::flush);
+        m_pending += accepted;
+        return QBuffer::writeData(data, accepted);
+    }
+
+private:
+    void flush()
+    {
+        ++m_flushes;
+        emit bytesWritten(std::exchange(m_pending, 0));
+    }
+
+    qint64 m_pending = 0;
+};
+
+// Never takes anything.
+class FullDevice : public QBuffer
+{
+protected:
+    qint64 writeData(const char *, qint64) override { return 0; }
+};
+
+void tst_Printing::printToPdfSequentialDevice()
+{
+    QWebEngineView view;
+    QSignalSpy loadFinishedSpy(&view, &QWebEngineView::loadFinished);
+    view.load(QUrl("qrc:///resources/basic_printing_page.html"));
+    QTRY_VERIFY(loadFinishedSpy.count() == 1);
+    QPageLayout layout(QPageSize(QPageSize::A4), QPageLayout::Portrait, QMarginsF(0.0, 0.0, 0.0, 0.0));
+
+    // The document is handed over in pieces, each once the device has
+    // written out the previous one.
+    ThrottledDevice throttled;
+    QVERIFY(throttled.open(QIODevice::WriteOnly));
+    CallbackSpy<bool> throttledSpy;
+    view.page()->printToPdf(&throttled, throttledSpy.ref(), layout);
+    QVERIFY(throttledSpy.waitForResult());
+    QVERIFY(throttled.data().startsWith("%PDF-"));
+    QVERIFY(throttled.data().trimmed().endsWith("%%EOF"));
+    QVERIFY(throttled.size() > ThrottledDevice::Capacity);
+    QVERIFY(throttled.m_flushes > 1);
+
+    // A device that takes nothing, and has nothing left to write, fails the
+    // print instead of being retried forever.
+    FullDevice full;
+    QVERIFY(full.open(QIODevice::WriteOnly));
+    CallbackSpy<bool> fullSpy;
+    view.page()->printToPdf(&full, fullSpy.ref(), layout);
+    QVERIFY(!fullSpy.waitForResult());
+}
+
 #if defined(POPPLER_CPP) && defined(Q_OS_LINUX) && defined(__GLIBCXX__)
 void tst_Printing::printToPdfPoppler()
 {
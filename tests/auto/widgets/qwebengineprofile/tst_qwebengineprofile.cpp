@@ -30,6 +30,7 @@
 #include <QtCore/qbuffer.h>
 #include <QtCore/qmimedatabase.h>
 #include <QtTest/QtTest>
+#include <QtWebEngineCore/qwebenginehttprequest.h>
 #include <QtWebEngineCore/qwebengineurlrequestinterceptor.h>
 #include <QtWebEngineCore/qwebengineurlrequestjob.h>
 #include <QtWebEngineCore/qwebenginecookiestore.h>
@@ -71,6 +72,12 @@ private Q_SLOTS:
     void urlSchemeHandlerXhrStatus();
     void urlSchemeHandlerScriptModule();
     void urlSchemeHandlerLongReply();
+    void urlSchemeHandlerDataReply();
+    void urlSchemeHandlerUnsatisfiableRange_data();
+    void urlSchemeHandlerUnsatisfiableRange();
+    void urlSchemeHandlerFileReply();
+    void urlSchemeHandlerFileReplyFromPosition();
+    void urlSchemeHandlerFileReplyRange();
     void customUserAgent();
     void httpAcceptLanguage();
     void downloadItem();
@@ -764,6 +771,201 @@ void tst_QWebEngineProfile::urlSchemeHandlerLongReply()
     QTRY_COMPARE(page.title(), QString("Minify this!"));
 }
 
+class DataReplyUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    DataReplyUrlSchemeHandler(QObject *parent = nullptr) : QWebEngineUrlSchemeHandler(parent) {}
+    ~DataReplyUrlSchemeHandler() {}
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        job->reply("text/html", QByteArray(4 * 1024 * 1024, ' ') +
+                   "<html><head><title>Streamed!</title></head></html>");
+    }
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerDataReply()
+{
+    DataReplyUrlSchemeHandler handler;
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("aviancarrier", &handler);
+    QWebEnginePage page(&profile);
+    page.load(QUrl("aviancarrier:/"));
+    QTRY_COMPARE(page.title(), QString("Streamed!"));
+}
+
+class FileReplyUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    FileReplyUrlSchemeHandler(const QString &fileName, qint64 position = -1, QObject *parent = nullptr)
+        : QWebEngineUrlSchemeHandler(parent), m_fileName(fileName), m_position(position) {}
+    ~FileReplyUrlSchemeHandler() {}
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        QFile *file = new QFile(m_fileName, job);
+        if (m_position >= 0) {
+            file->open(QIODevice::ReadOnly);
+            file->seek(m_position);
+        }
+        job->reply("text/html", file);
+    }
+
+private:
+    QString m_fileName;
+    qint64 m_position;
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerFileReply()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(QByteArray(1024 * 1024, ' ') + "<html><head><title>Mapped!</title></head></html>");
+    file.close();
+
+    FileReplyUrlSchemeHandler handler(file.fileName());
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("aviancarrier", &handler);
+    QWebEnginePage page(&profile);
+    page.load(QUrl("aviancarrier:/"));
+    QTRY_COMPARE(page.title(), QString("Mapped!"));
+}
+
+// The reply starts where the application left the file.
+void tst_QWebEngineProfile::urlSchemeHandlerFileReplyFromPosition()
+{
+    const QByteArray skipped = "<html><head><title>Skipped</title></head></html>";
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(skipped + "<html><head><title>Positioned</title></head></html>");
+    file.close();
+
+    FileReplyUrlSchemeHandler handler(file.fileName(), skipped.size());
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("aviancarrier", &handler);
+    QWebEnginePage page(&profile);
+    page.load(QUrl("aviancarrier:/"));
+    QTRY_COMPARE(page.title(), QString("Positioned"));
+}
+
+// Counts reads, to tell whether a reply was served from the device or from
+// a mapping of its file.
+class ReadCountingFile : public QFile
+{
+public:
+    ReadCountingFile(const QString &fileName, QObject *parent) : QFile(fileName, parent) {}
+    int m_reads = 0;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        ++m_reads;
+        return QFile::readData(data, maxSize);
+    }
+};
+
+class RangeFileReplyUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    RangeFileReplyUrlSchemeHandler(const QString &fileName) : m_fileName(fileName) {}
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        // Owned by the handler, so that it can be inspected after the job is gone.
+        m_file = new ReadCountingFile(m_fileName, this);
+        m_file->open(QIODevice::ReadOnly);
+        job->reply("text/plain", m_file);
+    }
+
+    QString m_fileName;
+    ReadCountingFile *m_file = nullptr;
+};
+
+// A byte range of a large file is served from the mapping, which releases
+// the application's device.
+void tst_QWebEngineProfile::urlSchemeHandlerFileReplyRange()
+{
+    QByteArray content;
+    for (int i = 0; content.size() < 4 * 1024 * 1024; ++i)
+        content += QByteArray::number(i).rightJustified(8, '0') + '\n';
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write(content);
+    file.close();
+
+    RangeFileReplyUrlSchemeHandler handler(file.fileName());
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("aviancarrier", &handler);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadFinishedSpy(&page, &QWebEnginePage::loadFinished);
+
+    const int first = 3 * 1024 * 1024 + 9 * 17;
+    const int last = first + 9 * 4 - 1;
+    QWebEngineHttpRequest request(QUrl("aviancarrier:/"));
+    request.setHeader("Range", "bytes=" + QByteArray::number(first) + '-' + QByteArray::number(last));
+    page.load(request);
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(loadFinishedSpy.takeFirst().at(0).toBool());
+
+    const QByteArray expected = content.mid(first, last - first + 1);
+    QCOMPARE(toPlainTextSync(&page).trimmed(), QString::fromLatin1(expected).trimmed());
+    QVERIFY(handler.m_file);
+    QVERIFY(!handler.m_file->isOpen());
+    QCOMPARE(handler.m_file->m_reads, 0);
+}
+
+class ShortReplyUrlSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+public:
+    ShortReplyUrlSchemeHandler(bool replyWithDevice) : m_replyWithDevice(replyWithDevice) {}
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override
+    {
+        const QByteArray data("<html><head><title>Short</title></head></html>");
+        if (m_replyWithDevice) {
+            QBuffer *buffer = new QBuffer(job);
+            buffer->setData(data);
+            job->reply("text/html", buffer);
+        } else {
+            job->reply("text/html", data);
+        }
+        ++m_replies;
+    }
+
+    bool m_replyWithDevice;
+    int m_replies = 0;
+};
+
+void tst_QWebEngineProfile::urlSchemeHandlerUnsatisfiableRange_data()
+{
+    QTest::addColumn<bool>("replyWithDevice");
+    QTest::newRow("data") << false;
+    QTest::newRow("device") << true;
+}
+
+// A range beyond the end of the reply fails the request while the reply
+// is being set up, which must not touch the request afterwards.
+void tst_QWebEngineProfile::urlSchemeHandlerUnsatisfiableRange()
+{
+    QFETCH(bool, replyWithDevice);
+    ShortReplyUrlSchemeHandler handler(replyWithDevice);
+    QWebEngineProfile profile;
+    profile.installUrlSchemeHandler("aviancarrier", &handler);
+    QWebEnginePage page(&profile);
+    QSignalSpy loadFinishedSpy(&page, &QWebEnginePage::loadFinished);
+
+    QWebEngineHttpRequest request(QUrl("aviancarrier:/"));
+    request.setHeader("Range", "bytes=100000-100010");
+    page.load(request);
+    QTRY_COMPARE(loadFinishedSpy.count(), 1);
+    QVERIFY(!loadFinishedSpy.takeFirst().at(0).toBool());
+    QCOMPARE(handler.m_replies, 1);
+
+    // The profile still serves requests normally.
+    page.load(QUrl("aviancarrier:/"));
+    QTRY_COMPARE(page.title(), QString("Short"));
+}
+
 void tst_QWebEngineProfile::customUserAgent()
 {
     QString defaultUserAgent = QWebEngineProfile::defaultProfile()->httpUserAgent();
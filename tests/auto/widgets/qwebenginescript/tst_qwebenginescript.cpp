@@ -66,6 +66,12 @@ private Q_SLOTS:
 #if QT_CONFIG(webengine_webchannel)
     void webChannel_data();
     void webChannel();
+    void webChannelBinaryTransport();
+    void webChannelBinaryTransportObjects();
+    void webChannelBinaryTransportJsonValues_data();
+    void webChannelBinaryTransportJsonValues();
+    void webChannelBatching_data();
+    void webChannelBatching();
     void webChannelResettingAndUnsetting();
     void webChannelWithExistingQtObject();
     void navigation();
@@ -76,6 +82,7 @@ private Q_SLOTS:
     void scriptsInNestedIframes();
     void matchQrcUrl();
     void injectionOrder();
+    void sameScriptIdInProfileAndPages();
 };
 
 void tst_QWebEngineScript::domEditing()
@@ -348,6 +355,7 @@ public:
 
 signals:
     void textChanged(const QString &text);
+    void ping(int value);
 
 private:
     QString m_text;
@@ -419,6 +427,185 @@ void tst_QWebEngineScript::webChannel()
     if (worldId != QWebEngineScript::MainWorld)
         QCOMPARE(evaluateJavaScriptSync(&page, "qt.webChannelTransport"), QVariant());
 }
+
+void tst_QWebEngineScript::webChannelBinaryTransport()
+{
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled, true);
+    TestObject testObject;
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    // The first reply arrives as CBOR, after which the page's messages are sent as CBOR as well.
+    page.runJavaScript(QLatin1String(
+                                "new QWebChannel(qt.webChannelTransport,"
+                                "  function(channel) {"
+                                "    window.object = channel.objects.object;"
+                                "    object.text = 'te\\u00dft';"
+                                "  }"
+                                ");"));
+    QSignalSpy spyTextChanged(&testObject, &TestObject::textChanged);
+    QVERIFY(spyTextChanged.wait());
+    QCOMPARE(testObject.text(), QString::fromUtf8("te\xc3\x9f" "t"));
+
+    testObject.setText(QStringLiteral("update"));
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "object.text").toString(),
+                 QStringLiteral("update"));
+}
+
+// Messages to the page arrive as objects, and objects passed to send() are
+// encoded as CBOR on the way back instead of JSON text.
+void tst_QWebEngineScript::webChannelBinaryTransportObjects()
+{
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled, true);
+    TestObject testObject;
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    page.runJavaScript(QLatin1String(
+                                "var transport = qt.webChannelTransport;"
+                                "window.receivedTypes = [];"
+                                "var wrapper = {"
+                                "  send: function(message) { transport.send(JSON.parse(message)); }"
+                                "};"
+                                "transport.onmessage = function(message) {"
+                                "  receivedTypes.push(typeof message.data);"
+                                "  wrapper.onmessage(message);"
+                                "};"
+                                "new QWebChannel(wrapper,"
+                                "  function(channel) {"
+                                "    window.object = channel.objects.object;"
+                                "    object.text = 'te\\u00dft';"
+                                "  }"
+                                ");"));
+    QSignalSpy spyTextChanged(&testObject, &TestObject::textChanged);
+    QVERIFY(spyTextChanged.wait());
+    QCOMPARE(testObject.text(), QString::fromUtf8("te\xc3\x9f" "t"));
+
+    QVERIFY(evaluateJavaScriptSync(&page, "receivedTypes.length").toInt() > 0);
+    QCOMPARE(evaluateJavaScriptSync(&page, "receivedTypes.every(t => t === 'object')"), QVariant(true));
+}
+
+void tst_QWebEngineScript::webChannelBinaryTransportJsonValues_data()
+{
+    QTest::addColumn<QString>("value");
+    QTest::addColumn<QString>("expected");
+    QTest::newRow("date") << "new Date(Date.UTC(2021, 0, 2, 3, 4, 5))" << "2021-01-02T03:04:05.000Z";
+    QTest::newRow("toJSON") << "({ toJSON: function(key) { return 'key:' + key; } })" << "key:value";
+    QTest::newRow("string object") << "new String('boxed')" << "boxed";
+    QTest::newRow("number object") << "new Number(42)" << "42";
+    QTest::newRow("boolean object") << "new Boolean(true)" << "true";
+}
+
+// Objects passed to send() are encoded the way JSON.stringify() would see
+// them, so the host gets the same values as from the text transport.
+void tst_QWebEngineScript::webChannelBinaryTransportJsonValues()
+{
+    QFETCH(QString, value);
+    QFETCH(QString, expected);
+
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled, true);
+    TestObject testObject;
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    // Setting the property sends a message of type 9, whose value is
+    // replaced by the value under test before it goes to the renderer.
+    page.runJavaScript(QLatin1String(
+                                "var transport = qt.webChannelTransport;"
+                                "var wrapper = {"
+                                "  send: function(message) {"
+                                "    var object = JSON.parse(message);"
+                                "    if (object.type === 9)"
+                                "      object.value = ") + value + QLatin1String(";"
+                                "    transport.send(object);"
+                                "  }"
+                                "};"
+                                "transport.onmessage = function(message) { wrapper.onmessage(message); };"
+                                "new QWebChannel(wrapper,"
+                                "  function(channel) {"
+                                "    channel.objects.object.text = 'placeholder';"
+                                "  }"
+                                ");"));
+    QSignalSpy spyTextChanged(&testObject, &TestObject::textChanged);
+    QVERIFY(spyTextChanged.wait());
+    QCOMPARE(testObject.text(), expected);
+}
+
+void tst_QWebEngineScript::webChannelBatching_data()
+{
+    QTest::addColumn<bool>("binary");
+    QTest::newRow("json") << false;
+    QTest::newRow("cbor") << true;
+}
+
+// A burst of signals sent within one event loop iteration reaches the page
+// as a single batch, with the messages in the order they were sent.
+void tst_QWebEngineScript::webChannelBatching()
+{
+    QFETCH(bool, binary);
+    qputenv("QTWEBENGINE_WEBCHANNEL_BATCH_INTERVAL", "0");
+    auto unsetInterval = qScopeGuard([] { qunsetenv("QTWEBENGINE_WEBCHANNEL_BATCH_INTERVAL"); });
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.webengine.webchanneltransport.batching.debug=true"));
+    auto resetRules = qScopeGuard([] { QLoggingCategory::setFilterRules(QString()); });
+
+    QWebEnginePage page;
+    page.settings()->setAttribute(QWebEngineSettings::BinaryWebChannelTransportEnabled, binary);
+    TestObject testObject;
+    QWebChannel channel;
+    channel.registerObject(QStringLiteral("object"), &testObject);
+    page.setWebChannel(&channel);
+    page.scripts().insert(webChannelScript());
+    page.setHtml(QStringLiteral("<html><body></body></html>"));
+    QSignalSpy spyFinished(&page, &QWebEnginePage::loadFinished);
+    QVERIFY(spyFinished.wait());
+
+    // Tasks delivering separate messages are told apart by a timer, which
+    // cannot fire in between messages delivered from the same task.
+    page.runJavaScript(QLatin1String(
+                                "window.received = [];"
+                                "window.deliveries = 0;"
+                                "var delivering = false;"
+                                "new QWebChannel(qt.webChannelTransport,"
+                                "  function(channel) {"
+                                "    channel.objects.object.ping.connect(function(value) {"
+                                "      received.push(value);"
+                                "      if (!delivering) {"
+                                "        delivering = true;"
+                                "        ++deliveries;"
+                                "        setTimeout(function() { delivering = false; }, 0);"
+                                "      }"
+                                "    });"
+                                "    window.connected = true;"
+                                "  }"
+                                ");"));
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "window.connected"), QVariant(true));
+
+    QTest::ignoreMessage(QtDebugMsg, QRegularExpression("sending batch of 10 webchannel messages"));
+    for (int i = 0; i < 10; ++i)
+        emit testObject.ping(i);
+    QTRY_COMPARE(evaluateJavaScriptSync(&page, "received.length").toInt(), 10);
+    QCOMPARE(evaluateJavaScriptSync(&page, "received.join(',')").toString(),
+             QStringLiteral("0,1,2,3,4,5,6,7,8,9"));
+    QCOMPARE(evaluateJavaScriptSync(&page, "deliveries").toInt(), 1);
+}
 #endif
 void tst_QWebEngineScript::noTransportWithoutWebChannel()
 {
@@ -694,6 +881,67 @@ void tst_QWebEngineScript::injectionOrder()
     QTRY_COMPARE(page.log, expected);
 }
 
+// Copies of a script keep its id, even after their source changes. Scripts
+// with the same id in the profile and in pages must not replace each other.
+void tst_QWebEngineScript::sameScriptIdInProfileAndPages()
+{
+    QWebEngineProfile profile;
+    QWebEnginePage page1(&profile);
+    QWebEnginePage page2(&profile);
+
+    QWebEngineScript profileScript;
+    profileScript.setInjectionPoint(QWebEngineScript::DocumentCreation);
+    profileScript.setWorldId(QWebEngineScript::MainWorld);
+    QWebEngineScript pageScript1 = profileScript;
+    QWebEngineScript pageScript2 = profileScript;
+    profileScript.setSourceCode(QStringLiteral(R"(
+// ==UserScript==
+// @include *title_a.html
+// ==/UserScript==
+window.ranScript = 'profile';
+    )"));
+    pageScript1.setSourceCode(QStringLiteral(R"(
+// ==UserScript==
+// @include *title_b.html
+// ==/UserScript==
+window.ranScript = 'page1';
+    )"));
+    pageScript2.setSourceCode(QStringLiteral(R"(
+// ==UserScript==
+// @include *test_iframe_inner.html
+// ==/UserScript==
+window.ranScript = 'page2';
+    )"));
+    profile.scripts()->insert(profileScript);
+    page1.scripts().insert(pageScript1);
+    page2.scripts().insert(pageScript2);
+
+    const QString ranScript = QStringLiteral("window.ranScript || 'none'");
+    loadSync(&page1, QUrl("qrc:/resources/title_a.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page1, ranScript), QVariant("profile"));
+    loadSync(&page2, QUrl("qrc:/resources/title_a.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page2, ranScript), QVariant("profile"));
+
+    loadSync(&page1, QUrl("qrc:/resources/title_b.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page1, ranScript), QVariant("page1"));
+    loadSync(&page2, QUrl("qrc:/resources/title_b.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page2, ranScript), QVariant("none"));
+
+    loadSync(&page1, QUrl("qrc:/resources/test_iframe_inner.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page1, ranScript), QVariant("none"));
+    loadSync(&page2, QUrl("qrc:/resources/test_iframe_inner.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page2, ranScript), QVariant("page2"));
+
+    // Removing the script from one page leaves the others in place.
+    page1.scripts().remove(pageScript1);
+    loadSync(&page1, QUrl("qrc:/resources/title_b.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page1, ranScript), QVariant("none"));
+    loadSync(&page1, QUrl("qrc:/resources/title_a.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page1, ranScript), QVariant("profile"));
+    loadSync(&page2, QUrl("qrc:/resources/test_iframe_inner.html"));
+    QCOMPARE(evaluateJavaScriptSync(&page2, ranScript), QVariant("page2"));
+}
+
 QTEST_MAIN(tst_QWebEngineScript)
 
 #include "tst_qwebenginescript.moc"
@@ -0,0 +1,152 @@
+/****************************************************************************
+**
+** Copyright (C) 2021 The Qt Company Ltd.
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL3$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPLv3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or later as published by the Free
+** Software Foundation and appearing in the file LICENSE.GPL included in
+** the packaging of this file. Please review the following information to
+** ensure the GNU General Public License version 2.0 requirements will be
+** met: http://www.gnu.org/licenses/gpl-2.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QPdfDocument>
+#include <QPdfWriter>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtPdf/private/qpdfrenderprocesspool_p.h>
+
+#include <memory>
+#include <vector>
+
+class tst_bench_PdfRenderProcesses : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void render_data();
+    void render();
+
+private:
+    QTemporaryDir m_dir;
+    QStringList m_fileNames;
+};
+
+static const int DocumentCount = 16;
+static const int PageCount = 6;
+static const QSize ImageSize(1240, 1754);
+
+// Writes documents with enough text and vector art per page that rendering,
+// not the process round trip, dominates.
+void tst_bench_PdfRenderProcesses::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    QRandomGenerator random(2021);
+    for (int i = 0; i < DocumentCount; ++i) {
+        const QString fileName = m_dir.filePath(QStringLiteral("document%1.pdf").arg(i));
+        QPdfWriter writer(fileName);
+        writer.setResolution(150);
+        QPainter painter(&writer);
+        for (int page = 0; page < PageCount; ++page) {
+            if (page)
+                writer.newPage();
+            const QRect area = painter.viewport();
+            for (int j = 0; j < 400; ++j) {
+                QPainterPath path;
+                path.moveTo(random.bounded(area.width()), random.bounded(area.height()));
+                for (int k = 0; k < 4; ++k)
+                    path.cubicTo(random.bounded(area.width()), random.bounded(area.height()),
+                                 random.bounded(area.width()), random.bounded(area.height()),
+                                 random.bounded(area.width()), random.bounded(area.height()));
+                painter.setPen(QPen(QColor::fromRgb(random.generate()), random.bounded(1, 6)));
+                painter.drawPath(path);
+            }
+            for (int line = 0; line < 60; ++line)
+                painter.drawText(40, 60 + line * 40, QStringLiteral("Document %1, page %2, line %3: the quick brown fox jumps over the lazy dog")
+                                                             .arg(i).arg(page).arg(line));
+        }
+        m_fileNames.append(fileName);
+    }
+}
+
+void tst_bench_PdfRenderProcesses::render_data()
+{
+    QTest::addColumn<int>("documents");
+    QTest::addColumn<int>("processes");
+
+    const int cores = QThread::idealThreadCount();
+    for (int documents : { 1, 4, DocumentCount }) {
+        QTest::addRow("%d documents, in process", documents) << documents << 0;
+        for (int processes = 1; processes < cores; processes *= 2)
+            QTest::addRow("%d documents, %d processes", documents, processes) << documents << processes;
+        QTest::addRow("%d documents, %d processes", documents, cores) << documents << cores;
+    }
+}
+
+// Renders every page of each document on a thread of its own, the way a
+// preview service with one QPdfPageRenderer per document would.
+void tst_bench_PdfRenderProcesses::render()
+{
+    QFETCH(int, documents);
+    QFETCH(int, processes);
+
+    QPdfRenderProcessPool::instance()->setProcessCount(processes);
+
+    std::vector<std::unique_ptr<QPdfDocument>> pdfs;
+    for (int i = 0; i < documents; ++i) {
+        pdfs.push_back(std::make_unique<QPdfDocument>());
+        QCOMPARE(pdfs.back()->load(m_fileNames.at(i)), QPdfDocument::NoError);
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(documents);
+    QAtomicInt failures = 0;
+    QBENCHMARK {
+        for (const auto &pdf : pdfs) {
+            threadPool.start([document = pdf.get(), &failures] {
+                for (int page = 0; page < document->pageCount(); ++page) {
+                    if (document->render(page, ImageSize).isNull())
+                        failures.ref();
+                }
+            });
+        }
+        threadPool.waitForDone();
+    }
+    QCOMPARE(failures.loadRelaxed(), 0);
+
+    pdfs.clear();
+    QPdfRenderProcessPool::instance()->setProcessCount(0);
+}
+
+QTEST_MAIN(tst_bench_PdfRenderProcesses)
+
+#include "tst_bench_pdfrenderprocesses.moc"